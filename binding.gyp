@@ -8,14 +8,20 @@
         "cpp/src/AsteroidGenerator.cpp",
         "cpp/src/Asteroid.cpp",
         "cpp/src/GameTypes.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/src/Biome.cpp",
+        "cpp/src/server/TickStats.cpp",
+        "cpp/src/server/TickTimings.cpp",
+        "cpp/src/node/NodeTypes.cpp",
+        "cpp/test/AsteroidsTest.cpp"
       ],
       "include_dirs": [
         '<!@(node -p "require(\'node-addon-api\').include")',
-        "cpp/include"
+        "cpp/include",
+        "cpp/test"
       ],
       "defines": [ 
-        'NAPI_DISABLE_CPP_EXCEPTIONS',
-        'ASTEROIDS_TEST'
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
        ]
     },
     {
@@ -26,15 +32,95 @@
         "cpp/src/AsteroidGenerator.cpp",
         "cpp/src/Asteroid.cpp",
         "cpp/src/AsteroidCollider.cpp",
-        "cpp/src/GameTypes.cpp"
+        "cpp/src/GameTypes.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/src/Biome.cpp",
+        "cpp/src/server/TickStats.cpp",
+        "cpp/src/server/TickTimings.cpp",
+        "cpp/src/node/NodeTypes.cpp",
+        "cpp/test/ColliderTest.cpp"
       ],
       "include_dirs": [
         '<!@(node -p "require(\'node-addon-api\').include")',
-        "cpp/include"
+        "cpp/include",
+        "cpp/test"
       ],
       "defines": [ 
-        'NAPI_DISABLE_CPP_EXCEPTIONS',
-        'COLLIDER_TEST'
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "collisionworldtest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/Asteroid.cpp",
+        "cpp/src/AsteroidCollider.cpp",
+        "cpp/src/GameTypes.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/src/server/CollisionWorld.cpp",
+        "cpp/test/CollisionWorldTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "sweepandprunetest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/Asteroid.cpp",
+        "cpp/src/AsteroidCollider.cpp",
+        "cpp/src/GameTypes.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/src/server/SweepAndPrune.cpp",
+        "cpp/test/SweepAndPruneTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "shipcollisiontest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/AsteroidGenerator.cpp",
+        "cpp/src/Asteroid.cpp",
+        "cpp/src/AsteroidCollider.cpp",
+        "cpp/src/GameTypes.cpp",
+        "cpp/src/server/Chunk.cpp",
+        "cpp/src/server/ServerPacket.cpp",
+        "cpp/src/server/World.cpp",
+        "cpp/src/server/WorldSnapshot.cpp",
+        "cpp/src/server/TraceRecorder.cpp",
+        "cpp/src/server/TickTimings.cpp",
+        "cpp/src/server/BiomeManager.cpp",
+        "cpp/src/server/WeightedSampler.cpp",
+        "cpp/src/Biome.cpp",
+        "cpp/src/server/CollisionWorld.cpp",
+        "cpp/src/server/SweepAndPrune.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/test/ShipCollisionTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
       ]
     },
     {
@@ -45,15 +131,18 @@
         "cpp/src/AsteroidGenerator.cpp",
         "cpp/src/Asteroid.cpp",
         "cpp/src/AsteroidCollider.cpp",
-        "cpp/src/Projectile.cpp",
         "cpp/src/GameTypes.cpp",
-        "cpp/src/client/ClientPacket.cpp",
         "cpp/src/server/Chunk.cpp",
         "cpp/src/server/ServerPacket.cpp",
-        "cpp/src/server/WorldSim.cpp",
+        "cpp/src/server/World.cpp",
+        "cpp/src/server/WorldSnapshot.cpp",
+        "cpp/src/server/TraceRecorder.cpp",
+        "cpp/src/server/TickTimings.cpp",
         "cpp/src/server/BiomeManager.cpp",
+        "cpp/src/server/WeightedSampler.cpp",
         "cpp/src/Biome.cpp",
         "cpp/src/server/CollisionWorld.cpp",
+        "cpp/src/server/SweepAndPrune.cpp",
         "cpp/src/Ship.cpp",
         "cpp/test/ChunkTest.cpp"
       ],
@@ -83,6 +172,116 @@
         'NAPI_DISABLE_CPP_EXCEPTIONS'
       ]
     },
+    {
+      "target_name": "flathashtest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/test/FlatHashMapTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "samplertest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/server/WeightedSampler.cpp",
+        "cpp/test/WeightedSamplerTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "randomtest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/GameTypes.cpp",
+        "cpp/test/RandomStreamTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "snapshottest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/AsteroidGenerator.cpp",
+        "cpp/src/Asteroid.cpp",
+        "cpp/src/AsteroidCollider.cpp",
+        "cpp/src/GameTypes.cpp",
+        "cpp/src/server/Chunk.cpp",
+        "cpp/src/server/ServerPacket.cpp",
+        "cpp/src/server/WorldSnapshot.cpp",
+        "cpp/src/server/TraceRecorder.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/test/SnapshotTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "tickstatstest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/server/TickStats.cpp",
+        "cpp/src/server/TickTimings.cpp",
+        "cpp/test/TickStatsTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
+    {
+      "target_name": "tracerecordertest",
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "sources": [
+        "cpp/src/server/TraceRecorder.cpp",
+        "cpp/test/TraceRecorderTest.cpp"
+      ],
+      "include_dirs": [
+        '<!@(node -p "require(\'node-addon-api\').include")',
+        "cpp/include",
+        "cpp/test"
+      ],
+      "defines": [ 
+        'NAPI_DISABLE_CPP_EXCEPTIONS'
+      ]
+    },
     {
       "target_name": "worldsim",
       "cflags!": [ "-fno-exceptions" ],
@@ -91,16 +290,22 @@
         "cpp/src/AsteroidGenerator.cpp",
         "cpp/src/Asteroid.cpp",
         "cpp/src/AsteroidCollider.cpp",
-        "cpp/src/Projectile.cpp",
         "cpp/src/GameTypes.cpp",
-        "cpp/src/client/ClientPacket.cpp",
         "cpp/src/server/BiomeManager.cpp",
+        "cpp/src/server/WeightedSampler.cpp",
         "cpp/src/Biome.cpp",
         "cpp/src/server/Chunk.cpp",
         "cpp/src/server/ServerPacket.cpp",
+        "cpp/src/server/World.cpp",
         "cpp/src/server/WorldSim.cpp",
+        "cpp/src/server/WorldSnapshot.cpp",
+        "cpp/src/server/TraceRecorder.cpp",
+        "cpp/src/server/TickStats.cpp",
+        "cpp/src/server/TickTimings.cpp",
         "cpp/src/server/CollisionWorld.cpp",
-        "cpp/src/Ship.cpp"
+        "cpp/src/server/SweepAndPrune.cpp",
+        "cpp/src/Ship.cpp",
+        "cpp/src/node/NodeTypes.cpp"
       ],
       "include_dirs": [
         '<!@(node -p "require(\'node-addon-api\').include")',
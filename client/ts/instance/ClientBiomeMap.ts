@@ -1,4 +1,4 @@
-import { Biome } from "../../../instances/Biome";
+import { Biome, BIOME_TILE_SIZE } from "../../../instances/Biome";
 import { Point2D } from "../../../instances/GameTypes";
 import { BiomePacketDecoder } from "../../../packet/BiomePacketDecoder";
 
@@ -14,6 +14,9 @@ export class ClientBiomeMap {
   private chunks: Array<Array<Biome>>;
   private dims: number;
   private updateLock: boolean;
+  // tiles which have been (or are being) fetched, keyed by x * tileDims + y
+  private tiles: Set<number>;
+  private tileDims: number;
 
   private lastChunk: Point2D;
 
@@ -25,6 +28,8 @@ export class ClientBiomeMap {
     this.chunks = [];
     this.updateLock = false;
     this.lastChunk = null;
+    this.tiles = new Set();
+    this.tileDims = Math.ceil(this.dims / BIOME_TILE_SIZE);
     for (let i = 0; i < this.dims; i++) {
       this.chunks[i] = [];
       for (let j = 0; j < this.dims; j++) {
@@ -159,19 +164,36 @@ export class ClientBiomeMap {
   }
 
   private updateBounds_(origin: Point2D, dims: Point2D) {
+    // fetch every tile which overlaps the requested range
+    let tileMin = {
+      x: Math.floor(origin.x / BIOME_TILE_SIZE),
+      y: Math.floor(origin.y / BIOME_TILE_SIZE)
+    };
+
+    let tileMax = {
+      x: Math.floor((origin.x + dims.x - 1) / BIOME_TILE_SIZE),
+      y: Math.floor((origin.y + dims.y - 1) / BIOME_TILE_SIZE)
+    };
+
+    for (let i = tileMin.x; i <= tileMax.x; i++) {
+      for (let j = tileMin.y; j <= tileMax.y; j++) {
+        let x = i - (Math.floor(i / this.tileDims) * this.tileDims);
+        let y = j - (Math.floor(j / this.tileDims) * this.tileDims);
+        this.fetchTile_(x, y);
+      }
+    }
+  }
+
+  private fetchTile_(x: number, y: number) {
+    let key = x * this.tileDims + y;
+    if (this.tiles.has(key)) {
+      return;
+    }
+
+    this.tiles.add(key);
+
     // will be handled once ready -- race conditions aren't a problem!
-    fetch("/biome", {
-      method: "POST",
-      mode: "cors",
-      headers: {
-        "Content-type": "application/json"
-      },
-
-      body: JSON.stringify({
-        "origin": origin,
-        "dims": dims
-      })
-    }).then((r) => {
+    fetch("/biome/" + x + "/" + y).then((r) => {
       if (r.status < 200 || r.status >= 400) {
         return Promise.reject("could not update bounds!");
       }
@@ -184,7 +206,9 @@ export class ClientBiomeMap {
         this.chunks[info.chunk.x][info.chunk.y] = info.biome;
       }
     }).catch((err) => {
+      // try again next time we need it
+      this.tiles.delete(key);
       console.error(err);
     });
   }
-}
\ No newline at end of file
+}
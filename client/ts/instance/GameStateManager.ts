@@ -9,7 +9,6 @@ import { ClientPacket } from "../../../server/ClientPacket";
 import { ConnectionPacket } from "../../../server/ConnectionPacket";
 import { ServerPacket } from "../../../server/ServerPacket";
 import { Input, InputManager, InputMethod } from "../input/InputManager";
-import { Collide, GetDistance } from "./AsteroidColliderJS";
 import { ClientBiomeMap } from "./ClientBiomeMap";
 import { ShipManager } from "./ShipManager";
 import { getOriginTime, UpdateAndInterpolate, UpdateInstance } from "./UpdateInstance";
@@ -229,6 +228,13 @@ export class GameStateManager {
     let data = event.data as Blob;
     let packet = new ServerPacketDecoder(await data.arrayBuffer()).decode() as ServerPacket;
     this.ship.ship.score = packet.score;
+    // the server decides when we've been hit.
+    // packets sent before a respawn may still report us as destroyed, so ignore those.
+    if (packet.destroyed && !this.ship.ship.destroyed && !this.invuln()) {
+      setTimeout(this.respawnShip_.bind(this), 3000);
+      this.ship.collide();
+    }
+
     // store local objects
     for (let a of packet.asteroids) {
       a.hidden = false;
@@ -444,16 +450,6 @@ export class GameStateManager {
           UpdateInstance(a, this.dims);
         }
 
-        if (GetDistance(a, this.ship.getShip().position, this.dims) < 12) {
-          if (Collide(a, this.ship.getShip().position, this.dims) && !this.invuln()) {
-            if (!this.ship.ship.destroyed) {
-              setTimeout(this.respawnShip_.bind(this), 3000);
-            }
-            
-            this.ship.collide();
-          }
-        }
-
         this.hideIfDistance(this.ship.getShip(), a);
       }
   
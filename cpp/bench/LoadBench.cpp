@@ -0,0 +1,191 @@
+// scaling test: grows a crowd of bot players in a single world, and reports tick time, fan-out and memory at each size.
+// usage: load_bench [--dims N] [--asteroids N] [--counts 1,10,100] [--warmup N] [--ticks N] [--seed N] [--csv]
+
+#include <server/LoadGenerator.hpp>
+#include <server/World.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+// matches the client's tick rate
+static const double tick_length = 1.0 / 30.0;
+
+struct BenchOptions {
+  int dims = 256;
+  int asteroids = 8192;
+  std::vector<int> counts = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000 };
+  // ticks run after each step before measuring, so newcomers have settled in
+  int warmup = 60;
+  int ticks = 300;
+  uint64_t seed = 1;
+  bool csv = false;
+};
+
+// resident memory of this process, in bytes -- 0 where we can't tell
+static size_t GetResidentBytes() {
+#ifdef __linux__
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+
+  unsigned long pages = 0;
+  unsigned long resident = 0;
+  int read = std::fscanf(statm, "%lu %lu", &pages, &resident);
+  std::fclose(statm);
+  return (read == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0);
+#else
+  return 0;
+#endif
+}
+
+static bool ParseCounts(const std::string& list, std::vector<int>& out) {
+  out.clear();
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    int count = std::atoi(item.c_str());
+    if (count <= 0) {
+      return false;
+    }
+
+    out.push_back(count);
+  }
+
+  std::sort(out.begin(), out.end());
+  return !out.empty();
+}
+
+static bool ParseArgs(int argc, char** argv, BenchOptions& out) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--csv") {
+      out.csv = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      std::cout << "missing value for " << arg << std::endl;
+      return false;
+    }
+
+    const char* val = argv[++i];
+    if (arg == "--dims") {
+      out.dims = std::atoi(val);
+    } else if (arg == "--asteroids") {
+      out.asteroids = std::atoi(val);
+    } else if (arg == "--counts") {
+      if (!ParseCounts(val, out.counts)) {
+        std::cout << "invalid bot counts " << val << std::endl;
+        return false;
+      }
+    } else if (arg == "--warmup") {
+      out.warmup = std::atoi(val);
+    } else if (arg == "--ticks") {
+      out.ticks = std::atoi(val);
+    } else if (arg == "--seed") {
+      out.seed = std::strtoull(val, nullptr, 10);
+    } else {
+      std::cout << "unknown argument " << arg << std::endl;
+      return false;
+    }
+  }
+
+  if (out.dims <= 0 || out.asteroids < 0 || out.warmup < 0 || out.ticks <= 0) {
+    std::cout << "invalid arguments" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv) {
+  BenchOptions opts;
+  if (!ParseArgs(argc, argv, opts)) {
+    return 1;
+  }
+
+  auto clock = std::make_shared<VirtualClock>();
+  WorldOptions world_options;
+  world_options.has_seed = true;
+  world_options.seed = opts.seed;
+  world_options.clock = clock;
+
+  std::string error;
+  std::unique_ptr<World> world = World::Create(opts.dims, opts.asteroids, world_options, error);
+  if (!world) {
+    std::cout << error << std::endl;
+    return 1;
+  }
+
+  LoadGenerator bots(*world, opts.seed);
+  FlatHashMap<uint64_t, ServerPacket> packets;
+  auto tick = [&]() {
+    clock->Advance(tick_length);
+    bots.SendInputs(tick_length);
+    packets.clear();
+    world->UpdateSim(&packets);
+    return bots.HandlePackets(packets);
+  };
+
+  if (opts.csv) {
+    std::cout << "bots,tick_mean_us,tick_p99_us,tick_max_us,fanout_bytes_per_tick,fanout_bytes_per_bot,rss_bytes" << std::endl;
+  } else {
+    std::cout << "dims " << opts.dims << ", asteroids " << opts.asteroids << ", seed " << opts.seed << std::endl;
+    std::cout << std::setw(8) << "bots" << std::setw(14) << "mean (us)" << std::setw(14) << "p99 (us)" << std::setw(14) << "max (us)"
+              << std::setw(16) << "bytes/tick" << std::setw(12) << "bytes/bot" << std::setw(12) << "rss (MB)" << std::endl;
+  }
+
+  std::vector<double> times;
+  for (int count : opts.counts) {
+    bots.SetBotCount(count);
+    for (int i = 0; i < opts.warmup; i++) {
+      tick();
+    }
+
+    times.clear();
+    size_t bytes = 0;
+    for (int i = 0; i < opts.ticks; i++) {
+      bytes += tick();
+      times.push_back(world->GetLastTickTimings().total);
+    }
+
+    std::sort(times.begin(), times.end());
+    double mean = 0.0;
+    for (double t : times) {
+      mean += t;
+    }
+
+    mean /= times.size();
+    double p99 = times[std::min(times.size() - 1, static_cast<size_t>(0.99 * (times.size() - 1) + 0.5))];
+    double max = times.back();
+    double bytes_per_tick = static_cast<double>(bytes) / opts.ticks;
+    size_t rss = GetResidentBytes();
+
+    if (opts.csv) {
+      std::cout << count << "," << mean * 1e6 << "," << p99 * 1e6 << "," << max * 1e6 << ","
+                << bytes_per_tick << "," << bytes_per_tick / count << "," << rss << std::endl;
+    } else {
+      std::cout << std::fixed << std::setprecision(1)
+                << std::setw(8) << count << std::setw(14) << mean * 1e6 << std::setw(14) << p99 * 1e6 << std::setw(14) << max * 1e6
+                << std::setw(16) << std::setprecision(0) << bytes_per_tick << std::setw(12) << bytes_per_tick / count
+                << std::setw(12) << std::setprecision(1) << rss / (1024.0 * 1024.0) << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,465 @@
+// microbenchmarks for the sim's hot kernels.
+// each benchmark is calibrated to a fixed sample length, then sampled repeatedly -- the median is the number to compare.
+// usage: micro_bench [--filter substring] [--samples N] [--sample-ms N] [--csv]
+
+#include <AsteroidCollider.hpp>
+#include <AsteroidGenerator.hpp>
+#include <RandomStream.hpp>
+#include <server/BiomeManager.hpp>
+#include <server/BiomeTree.hpp>
+#include <server/Chunk.hpp>
+#include <server/ServerPacket.hpp>
+#include <server/WeightedSampler.hpp>
+#include <server/WorldSnapshot.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+// every benchmark draws from streams keyed by this, so inputs are identical from run to run
+static const uint64_t bench_seed = 0x5EED;
+
+// keeps the compiler from discarding a result
+template <typename T>
+static void DoNotOptimize(const T& val) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&val) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &val;
+#endif
+}
+
+/**
+ *  A single benchmark. `setup` builds its inputs once, and returns the body to be timed.
+ *  The body runs `iterations` operations per call, and returns the number it actually ran.
+ */
+struct Benchmark {
+  std::string name;
+  std::function<std::function<uint64_t(uint64_t)>()> setup;
+};
+
+struct BenchOptions {
+  std::string filter;
+  int samples = 15;
+  double sample_ms = 20.0;
+  bool csv = false;
+};
+
+struct BenchResult {
+  double median_ns;
+  double min_ns;
+  // median absolute deviation, relative to the median
+  double spread;
+  uint64_t iterations;
+};
+
+static double Seconds(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+static BenchResult RunBenchmark(const std::function<uint64_t(uint64_t)>& body, const BenchOptions& opts) {
+  const double target = opts.sample_ms / 1000.0;
+
+  // grow the batch until it fills a sample -- this doubles as the warmup
+  uint64_t iterations = 1;
+  for (;;) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t ops = body(iterations);
+    double elapsed = Seconds(std::chrono::steady_clock::now() - start);
+    if (elapsed >= target || ops == 0) {
+      break;
+    }
+
+    double scale = (elapsed > 0.0 ? target / elapsed : 16.0);
+    iterations = static_cast<uint64_t>(std::ceil(iterations * std::min(16.0, std::max(1.5, scale))));
+  }
+
+  std::vector<double> per_op;
+  for (int i = 0; i < opts.samples; i++) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t ops = body(iterations);
+    double elapsed = Seconds(std::chrono::steady_clock::now() - start);
+    per_op.push_back(elapsed * 1e9 / std::max<uint64_t>(ops, 1));
+  }
+
+  std::sort(per_op.begin(), per_op.end());
+  BenchResult res;
+  res.median_ns = per_op[per_op.size() / 2];
+  res.min_ns = per_op.front();
+  res.iterations = iterations;
+
+  std::vector<double> deviation;
+  for (double s : per_op) {
+    deviation.push_back(std::abs(s - res.median_ns));
+  }
+
+  std::sort(deviation.begin(), deviation.end());
+  res.spread = (res.median_ns > 0.0 ? deviation[deviation.size() / 2] / res.median_ns : 0.0);
+  return res;
+}
+
+// asteroids as the world generates them, scattered about a single chunk
+static std::vector<Asteroid> MakeAsteroids(int count, uint64_t stream) {
+  RandomStream rng(bench_seed, RandomPurpose::ASTEROID, stream);
+  std::vector<Asteroid> res;
+  for (int i = 0; i < count; i++) {
+    RandomStream ast_rng = rng.Substream(i);
+    Asteroid a = GenerateAsteroid(1.5f, 12, ast_rng);
+    a.id = static_cast<uint64_t>(i + 1);
+    a.ver = 0;
+    a.position.chunk = { 0, 0 };
+    a.position.position = { rng.NextFloat(0.0f, chunk_size), rng.NextFloat(0.0f, chunk_size) };
+    a.velocity = { rng.NextFloat(-2.0f, 2.0f), rng.NextFloat(-2.0f, 2.0f) };
+    a.rotation = rng.NextFloat(0.0f, 6.28f);
+    a.rotation_velocity = rng.NextFloat(-2.0f, 2.0f);
+    a.last_update = 0.0;
+    a.origin_time = 0.0;
+    res.push_back(a);
+  }
+
+  return res;
+}
+
+// points near the asteroids -- about half of them land inside
+static std::vector<WorldPosition> MakeProbes(const std::vector<Asteroid>& asteroids, int per_asteroid) {
+  RandomStream rng(bench_seed, RandomPurpose::WORLD, 1);
+  std::vector<WorldPosition> res;
+  for (auto& a : asteroids) {
+    for (int i = 0; i < per_asteroid; i++) {
+      WorldPosition p = a.position;
+      p.position.x += rng.NextFloat(-2.0f, 2.0f);
+      p.position.y += rng.NextFloat(-2.0f, 2.0f);
+      res.push_back(p);
+    }
+  }
+
+  return res;
+}
+
+static std::vector<Benchmark> GetBenchmarks() {
+  std::vector<Benchmark> res;
+
+  res.push_back({ "collide/point", []() {
+    auto asteroids = std::make_shared<std::vector<Asteroid>>(MakeAsteroids(64, 1));
+    auto probes = std::make_shared<std::vector<WorldPosition>>(MakeProbes(*asteroids, 16));
+    return [asteroids, probes](uint64_t n) {
+      size_t count = probes->size();
+      int hits = 0;
+      for (uint64_t i = 0; i < n; i++) {
+        size_t p = i % count;
+        hits += Collide((*asteroids)[p / 16], (*probes)[p], 256);
+      }
+
+      DoNotOptimize(hits);
+      return n;
+    };
+  }});
+
+  // a projectile's path over one tick, checked in the same number of steps CollisionWorld uses
+  res.push_back({ "collide/line", []() {
+    auto asteroids = std::make_shared<std::vector<Asteroid>>(MakeAsteroids(64, 1));
+    auto probes = std::make_shared<std::vector<WorldPosition>>(MakeProbes(*asteroids, 16));
+    return [asteroids, probes](uint64_t n) {
+      size_t count = probes->size();
+      int hits = 0;
+      for (uint64_t i = 0; i < n; i++) {
+        size_t p = i % count;
+        WorldPosition end = (*probes)[p];
+        end.position.x += 1.5f;
+        end.position.y -= 0.5f;
+        hits += Collide((*asteroids)[p / 16], (*probes)[p], end, 8, 256);
+      }
+
+      DoNotOptimize(hits);
+      return n;
+    };
+  }});
+
+  res.push_back({ "collide/asteroid_pair", []() {
+    auto asteroids = std::make_shared<std::vector<Asteroid>>(MakeAsteroids(64, 1));
+    return [asteroids](uint64_t n) {
+      size_t count = asteroids->size();
+      int hits = 0;
+      for (uint64_t i = 0; i < n; i++) {
+        // neighbours in a list scattered over one chunk -- some overlap, most don't
+        hits += Collide((*asteroids)[i % count], (*asteroids)[(i + 1) % count], 256);
+      }
+
+      DoNotOptimize(hits);
+      return n;
+    };
+  }});
+
+  res.push_back({ "generate/asteroid_12", []() {
+    return [](uint64_t n) {
+      RandomStream rng(bench_seed, RandomPurpose::ASTEROID, 2);
+      for (uint64_t i = 0; i < n; i++) {
+        Asteroid a = GenerateAsteroid(1.5f, 12, rng);
+        DoNotOptimize(a);
+      }
+
+      return n;
+    };
+  }});
+
+  for (int size : { 256, 4096 }) {
+    res.push_back({ "biome_tree/insert_" + std::to_string(size), [size]() {
+      auto keys = std::make_shared<std::vector<float>>();
+      RandomStream rng(bench_seed, RandomPurpose::BIOME_WEIGHTS, 1);
+      for (int i = 0; i < size; i++) {
+        keys->push_back(rng.NextFloat(0.0f, 1000.0f));
+      }
+
+      // inserts are only paid for on the next lookup, so a batch includes one
+      return [keys](uint64_t n) {
+        uint64_t ops = 0;
+        while (ops < n) {
+          BiomeTree<float, int> tree;
+          for (size_t i = 0; i < keys->size(); i++) {
+            tree.Insert((*keys)[i], static_cast<int>(i));
+          }
+
+          int val;
+          DoNotOptimize(tree.Lookup(500.0f, &val));
+          ops += keys->size();
+        }
+
+        return ops;
+      };
+    }});
+
+    res.push_back({ "biome_tree/lookup_" + std::to_string(size), [size]() {
+      auto tree = std::make_shared<BiomeTree<float, int>>();
+      auto queries = std::make_shared<std::vector<float>>();
+      RandomStream rng(bench_seed, RandomPurpose::BIOME_WEIGHTS, 2);
+      for (int i = 0; i < size; i++) {
+        tree->Insert(rng.NextFloat(0.0f, 1000.0f), i);
+      }
+
+      for (int i = 0; i < 4096; i++) {
+        queries->push_back(rng.NextFloat(0.0f, 1000.0f));
+      }
+
+      return [tree, queries](uint64_t n) {
+        int sum = 0;
+        int val = 0;
+        for (uint64_t i = 0; i < n; i++) {
+          if (tree->Lookup((*queries)[i & 4095], &val)) {
+            sum += val;
+          }
+        }
+
+        DoNotOptimize(sum);
+        return n;
+      };
+    }});
+  }
+
+  // spawn chunks are drawn from one weight per chunk -- 64 and 256 dims
+  for (int size : { 4096, 65536 }) {
+    res.push_back({ "weighted_sampler/update_" + std::to_string(size), [size]() {
+      auto sampler = std::make_shared<WeightedSampler>(size);
+      auto weights = std::make_shared<std::vector<double>>();
+      RandomStream rng(bench_seed, RandomPurpose::BIOME_WEIGHTS, 1);
+      for (int i = 0; i < 4096; i++) {
+        weights->push_back(rng.NextDouble());
+      }
+
+      // each pass over the chunks is offset from the last, so that no write leaves a weight as it was
+      auto step = std::make_shared<uint64_t>(0);
+      return [sampler, weights, step, size](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+          uint64_t j = (*step)++;
+          double offset = ((j / size) & 1) ? 1.0 : 0.0;
+          sampler->SetWeight((j * 2654435761u) % size, (*weights)[j & 4095] + offset);
+        }
+
+        DoNotOptimize(sampler->GetTotal());
+        return n;
+      };
+    }});
+
+    res.push_back({ "weighted_sampler/sample_" + std::to_string(size), [size]() {
+      auto sampler = std::make_shared<WeightedSampler>(size);
+      auto queries = std::make_shared<std::vector<double>>();
+      RandomStream rng(bench_seed, RandomPurpose::BIOME_WEIGHTS, 2);
+      std::vector<double> weights(size);
+      for (auto& weight : weights) {
+        weight = rng.NextDouble();
+      }
+
+      sampler->Build(weights);
+      for (int i = 0; i < 4096; i++) {
+        queries->push_back(rng.NextDouble());
+      }
+
+      return [sampler, queries](uint64_t n) {
+        size_t sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+          sum += sampler->Sample((*queries)[i & 4095]);
+        }
+
+        DoNotOptimize(sum);
+        return n;
+      };
+    }});
+  }
+
+  // one biome per 36 chunks, as the world does
+  for (int dims : { 64, 256, 1024 }) {
+    res.push_back({ "biome_manager/construct_" + std::to_string(dims), [dims]() {
+      return [dims](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+          BiomeManager mgr(dims, (dims * dims) / 36, bench_seed + i);
+          DoNotOptimize(mgr);
+        }
+
+        return n;
+      };
+    }});
+  }
+
+  // per tick, at 30 ticks a second. whatever leaves the chunk is wrapped back in, so the density holds.
+  for (int density : { 8, 64, 512 }) {
+    res.push_back({ "chunk/update_" + std::to_string(density), [density]() {
+      auto chunk = std::make_shared<Chunk>(0.0);
+      auto asteroids = MakeAsteroids(density, 3);
+      chunk->InsertAsteroids(asteroids.begin(), asteroids.end());
+      auto time = std::make_shared<double>(0.0);
+      return [chunk, time](uint64_t n) {
+        ServerPacket resid;
+        for (uint64_t i = 0; i < n; i++) {
+          *time += 1.0 / 30.0;
+          resid.asteroids.clear();
+          chunk->UpdateChunk(resid, *time);
+          for (auto& a : resid.asteroids) {
+            a.position.chunk = { 0, 0 };
+            chunk->InsertAsteroid(a);
+          }
+        }
+
+        return n;
+      };
+    }});
+  }
+
+  // packets go out as JS objects, which can't be built without node -- this covers the native half,
+  // gathering a client's surroundings
+  res.push_back({ "server_packet/gather_9_chunks", []() {
+    auto chunks = std::make_shared<std::vector<Chunk>>();
+    for (int i = 0; i < 9; i++) {
+      chunks->emplace_back(0.0);
+      auto asteroids = MakeAsteroids(16, 10 + i);
+      chunks->back().InsertAsteroids(asteroids.begin(), asteroids.end());
+    }
+
+    return [chunks](uint64_t n) {
+      for (uint64_t i = 0; i < n; i++) {
+        ServerPacket res;
+        for (auto& c : *chunks) {
+          c.GetContents(res);
+        }
+
+        DoNotOptimize(res);
+      }
+
+      return n;
+    };
+  }});
+
+  // the snapshot encoding of as many asteroids as a client sees -- not the wire format, which is built in JS
+  res.push_back({ "snapshot/encode_asteroids_144", []() {
+    auto packet = std::make_shared<ServerPacket>();
+    packet->asteroids = MakeAsteroids(144, 20);
+    return [packet](uint64_t n) {
+      for (uint64_t i = 0; i < n; i++) {
+        BinaryWriter out;
+        for (auto& a : packet->asteroids) {
+          Write(out, a);
+        }
+
+        DoNotOptimize(out.Data());
+      }
+
+      return n;
+    };
+  }});
+
+  return res;
+}
+
+static bool ParseArgs(int argc, char** argv, BenchOptions& out) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--csv") {
+      out.csv = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      std::cout << "missing value for " << arg << std::endl;
+      return false;
+    }
+
+    const char* val = argv[++i];
+    if (arg == "--filter") {
+      out.filter = val;
+    } else if (arg == "--samples") {
+      out.samples = std::atoi(val);
+    } else if (arg == "--sample-ms") {
+      out.sample_ms = std::atof(val);
+    } else {
+      std::cout << "unknown argument " << arg << std::endl;
+      return false;
+    }
+  }
+
+  if (out.samples <= 0 || out.sample_ms <= 0.0) {
+    std::cout << "invalid arguments" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv) {
+  BenchOptions opts;
+  if (!ParseArgs(argc, argv, opts)) {
+    return 1;
+  }
+
+  if (opts.csv) {
+    std::cout << "name,median_ns,min_ns,spread,iterations" << std::endl;
+  } else {
+    std::cout << std::left << std::setw(36) << "benchmark" << std::right
+              << std::setw(14) << "median (ns)" << std::setw(14) << "min (ns)" << std::setw(10) << "spread" << std::endl;
+  }
+
+  for (auto& bench : GetBenchmarks()) {
+    if (!opts.filter.empty() && bench.name.find(opts.filter) == std::string::npos) {
+      continue;
+    }
+
+    BenchResult res = RunBenchmark(bench.setup(), opts);
+    if (opts.csv) {
+      std::cout << bench.name << "," << res.median_ns << "," << res.min_ns << "," << res.spread << "," << res.iterations << std::endl;
+    } else {
+      std::cout << std::left << std::setw(36) << bench.name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(14) << res.median_ns << std::setw(14) << res.min_ns
+                << std::setw(9) << (res.spread * 100.0) << "%" << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,299 @@
+// soak test: runs a churning crowd of bots for hours of virtual time, sampling memory and tick times as it goes.
+// fails if either keeps growing once the world has settled -- the shape of a leak, or of a structure nobody trims.
+// asteroids are left out of the memory check: the crowd splits them faster than it clears them for the first hour or so.
+// usage: soak_bench [--dims N] [--asteroids N] [--bots N] [--churn N] [--minutes N] [--sample-seconds N]
+//                   [--max-growth PCT] [--max-slowdown PCT] [--seed N] [--csv]
+
+#include <server/LoadGenerator.hpp>
+#include <server/World.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+// matches the client's tick rate
+static const double tick_length = 1.0 / 30.0;
+
+struct SoakOptions {
+  int dims = 64;
+  int asteroids = 2048;
+  int bots = 32;
+  // bots replaced per minute -- defaults to a quarter of the crowd
+  int churn = -1;
+  double minutes = 120.0;
+  double sample_seconds = 60.0;
+  // how far each metric may rise between the middle and last thirds of the run, in percent
+  double max_growth = 10.0;
+  double max_slowdown = 50.0;
+  uint64_t seed = 1;
+  bool csv = false;
+};
+
+// resident memory of this process, in bytes -- 0 where we can't tell
+static size_t GetResidentBytes() {
+#ifdef __linux__
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+
+  unsigned long pages = 0;
+  unsigned long resident = 0;
+  int read = std::fscanf(statm, "%lu %lu", &pages, &resident);
+  std::fclose(statm);
+  return (read == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0);
+#else
+  return 0;
+#endif
+}
+
+static bool ParseArgs(int argc, char** argv, SoakOptions& out) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--csv") {
+      out.csv = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      std::cout << "missing value for " << arg << std::endl;
+      return false;
+    }
+
+    const char* val = argv[++i];
+    if (arg == "--dims") {
+      out.dims = std::atoi(val);
+    } else if (arg == "--asteroids") {
+      out.asteroids = std::atoi(val);
+    } else if (arg == "--bots") {
+      out.bots = std::atoi(val);
+    } else if (arg == "--churn") {
+      out.churn = std::atoi(val);
+    } else if (arg == "--minutes") {
+      out.minutes = std::atof(val);
+    } else if (arg == "--sample-seconds") {
+      out.sample_seconds = std::atof(val);
+    } else if (arg == "--max-growth") {
+      out.max_growth = std::atof(val);
+    } else if (arg == "--max-slowdown") {
+      out.max_slowdown = std::atof(val);
+    } else if (arg == "--seed") {
+      out.seed = std::strtoull(val, nullptr, 10);
+    } else {
+      std::cout << "unknown argument " << arg << std::endl;
+      return false;
+    }
+  }
+
+  if (out.churn < 0) {
+    out.churn = out.bots / 4;
+  }
+
+  if (out.dims <= 0 || out.asteroids < 0 || out.bots <= 0 || out.minutes <= 0.0 || out.sample_seconds <= 0.0) {
+    std::cout << "invalid arguments" << std::endl;
+    return false;
+  }
+
+  // growth is judged on thirds of the run -- each needs a few samples
+  if (out.minutes * 60.0 < out.sample_seconds * 9.0) {
+    std::cout << "run for at least nine samples" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ *  A value sampled over the run, which should level off once the world has settled.
+ */
+struct Metric {
+  const char* name;
+  // false for values which are only reported
+  bool checked;
+  // growth allowed between thirds, as a fraction
+  double tolerance;
+  // growth always allowed, in the metric's own units -- keeps small values from tripping on noise
+  double slack;
+  std::vector<double> samples;
+
+  double GetMean(size_t begin, size_t end) const {
+    double res = 0.0;
+    for (size_t i = begin; i < end; i++) {
+      res += samples[i];
+    }
+
+    return res / (end - begin);
+  }
+};
+
+static double GetPercentile(std::vector<double>& times, double p) {
+  std::sort(times.begin(), times.end());
+  return times[std::min(times.size() - 1, static_cast<size_t>(p * (times.size() - 1) + 0.5))];
+}
+
+int main(int argc, char** argv) {
+  SoakOptions opts;
+  if (!ParseArgs(argc, argv, opts)) {
+    return 1;
+  }
+
+  // every chunk is generated up front, so that bots exploring fresh chunks isn't mistaken for growth
+  auto clock = std::make_shared<VirtualClock>();
+  WorldOptions world_options;
+  world_options.has_seed = true;
+  world_options.seed = opts.seed;
+  world_options.clock = clock;
+  world_options.eager = true;
+
+  std::string error;
+  std::unique_ptr<World> world = World::Create(opts.dims, opts.asteroids, world_options, error);
+  if (!world) {
+    std::cout << error << std::endl;
+    return 1;
+  }
+
+  LoadGenerator bots(*world, opts.seed);
+  bots.SetBotCount(opts.bots);
+
+  double growth = opts.max_growth / 100.0;
+  double slowdown = opts.max_slowdown / 100.0;
+  std::vector<Metric> metrics = {
+    { "world (KiB)", false, 0.0, 0.0, {} },
+    { "asteroids", false, 0.0, 0.0, {} },
+    { "chunks", false, 0.0, 0.0, {} },
+    // memory held on behalf of the crowd, which should track its size
+    { "crowd (KiB)", true, growth, 16.0, {} },
+    { "empty chunks", true, growth, 16.0, {} },
+    { "known_ids (KiB)", true, growth, 4.0, {} },
+    { "new_proj (KiB)", true, growth, 4.0, {} },
+    { "deleted", true, growth, 64.0, {} },
+    { "tick p50 (us)", true, slowdown, 50.0, {} },
+    { "tick p99 (us)", true, slowdown, 200.0, {} }
+  };
+
+  if (opts.csv) {
+    std::cout << "minutes";
+    for (auto& metric : metrics) {
+      std::cout << "," << metric.name;
+    }
+
+    std::cout << ",rss (MB)" << std::endl;
+  } else {
+    std::cout << "dims " << opts.dims << ", asteroids " << opts.asteroids << ", bots " << opts.bots
+              << ", churn " << opts.churn << "/min, seed " << opts.seed << std::endl;
+    std::cout << std::setw(8) << "minutes";
+    for (auto& metric : metrics) {
+      std::cout << std::setw(17) << metric.name;
+    }
+
+    std::cout << std::setw(12) << "rss (MB)" << std::endl;
+  }
+
+  const int sample_ticks = std::max(1, static_cast<int>(opts.sample_seconds / tick_length + 0.5));
+  const int samples = static_cast<int>(opts.minutes * 60.0 / opts.sample_seconds);
+  FlatHashMap<uint64_t, ServerPacket> packets;
+  std::vector<double> times;
+  double churn_owed = 0.0;
+  MemoryStats memory;
+  for (int sample = 1; sample <= samples; sample++) {
+    times.clear();
+    for (int i = 0; i < sample_ticks; i++) {
+      churn_owed += opts.churn * tick_length / 60.0;
+      if (churn_owed >= 1.0) {
+        bots.ReplaceBots(static_cast<int>(churn_owed));
+        churn_owed -= static_cast<int>(churn_owed);
+      }
+
+      clock->Advance(tick_length);
+      bots.SendInputs(tick_length);
+      packets.clear();
+      world->UpdateSim(&packets);
+      bots.HandlePackets(packets);
+      times.push_back(world->GetLastTickTimings().total);
+    }
+
+    world->GetMemoryStats(memory, 0);
+    size_t crowd = memory.ships.bytes + memory.projectiles.bytes + memory.collisions.bytes + memory.deleted.bytes
+                 + memory.known_ids.bytes + memory.new_projectiles.bytes + memory.ship_index.bytes;
+    double values[] = {
+      memory.GetTotalBytes() / 1024.0,
+      static_cast<double>(memory.asteroids.count),
+      static_cast<double>(memory.chunks.count),
+      crowd / 1024.0,
+      static_cast<double>(memory.empty_chunks),
+      memory.known_ids.bytes / 1024.0,
+      memory.new_projectiles.bytes / 1024.0,
+      static_cast<double>(memory.deleted.count),
+      GetPercentile(times, 0.5) * 1e6,
+      GetPercentile(times, 0.99) * 1e6
+    };
+
+    double minutes = sample * sample_ticks * tick_length / 60.0;
+    double rss = GetResidentBytes() / (1024.0 * 1024.0);
+    if (opts.csv) {
+      std::cout << minutes;
+    } else {
+      std::cout << std::fixed << std::setprecision(1) << std::setw(8) << minutes;
+    }
+
+    for (size_t i = 0; i < metrics.size(); i++) {
+      metrics[i].samples.push_back(values[i]);
+      if (opts.csv) {
+        std::cout << "," << values[i];
+      } else {
+        std::cout << std::setw(17) << values[i];
+      }
+    }
+
+    if (opts.csv) {
+      std::cout << "," << rss << std::endl;
+    } else {
+      std::cout << std::setw(12) << rss << std::endl;
+    }
+  }
+
+  // the first third is spent settling in -- compare the middle third to the last
+  size_t third = metrics[0].samples.size() / 3;
+  size_t end = metrics[0].samples.size();
+  bool failed = false;
+  for (auto& metric : metrics) {
+    if (!metric.checked) {
+      continue;
+    }
+
+    double middle = metric.GetMean(third, 2 * third);
+    double last = metric.GetMean(2 * third, end);
+    if (last > middle * (1.0 + metric.tolerance) + metric.slack) {
+      std::cout << metric.name << " grew from " << middle << " to " << last << std::endl;
+      failed = true;
+    }
+  }
+
+  // per-ship bookkeeping should leave with its ship -- a few stray entries are too small to show up as growth
+  size_t ships = memory.ships.count;
+  if (memory.ship_index.count != ships || memory.known_ids.count != ships || memory.new_projectiles.count != ships) {
+    std::cout << "per-ship entries outlived their ships: " << ships << " ships, " << memory.ship_index.count << " indexed, "
+              << memory.known_ids.count << " known_ids, " << memory.new_projectiles.count << " new_projectiles" << std::endl;
+    failed = true;
+  }
+
+  if (failed) {
+    std::cout << "soak failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "no growth over " << opts.minutes << " minutes" << std::endl;
+  return 0;
+}
@@ -0,0 +1,134 @@
+// re-runs a slow tick from its capture, so that it can be looked at under a profiler or a tracer.
+// the world is rebuilt before each run, and only the tick itself is timed.
+// usage: tick_replay CAPTURE [--repeat N] [--trace FILE]
+
+#include <server/TickTimings.hpp>
+#include <server/World.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+struct ReplayOptions {
+  std::string capture;
+  int repeat = 1;
+  // chrome trace-event file to write the last run to, if any
+  std::string trace;
+};
+
+static bool ParseArgs(int argc, char** argv, ReplayOptions& out) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 2, "--") != 0) {
+      out.capture = arg;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      std::cout << "missing value for " << arg << std::endl;
+      return false;
+    }
+
+    const char* val = argv[++i];
+    if (arg == "--repeat") {
+      out.repeat = std::atoi(val);
+    } else if (arg == "--trace") {
+      out.trace = val;
+    } else {
+      std::cout << "unknown argument " << arg << std::endl;
+      return false;
+    }
+  }
+
+  if (out.capture.empty() || out.repeat <= 0) {
+    std::cout << "usage: tick_replay CAPTURE [--repeat N] [--trace FILE]" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// the replayed tick should touch exactly what the captured one did
+static bool CountsMatch(const TickCounts& a, const TickCounts& b) {
+  return a.chunks == b.chunks && a.active_chunks == b.active_chunks && a.asteroids == b.asteroids
+      && a.ships == b.ships && a.projectiles == b.projectiles && a.packets == b.packets;
+}
+
+static void PrintRow(const char* name, double captured, std::vector<double>& runs) {
+  std::sort(runs.begin(), runs.end());
+  // seconds -> microseconds
+  std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(14) << captured * 1e6
+            << std::setw(14) << runs.front() * 1e6
+            << std::setw(14) << runs[runs.size() / 2] * 1e6 << std::endl;
+}
+
+int main(int argc, char** argv) {
+  ReplayOptions opts;
+  if (!ParseArgs(argc, argv, opts)) {
+    return 1;
+  }
+
+  SlowTickInfo captured;
+  std::vector<std::vector<double>> phases(tick_phase_count);
+  std::vector<double> totals;
+  bool mismatch = false;
+  for (int run = 0; run < opts.repeat; run++) {
+    WorldOptions world_options;
+    world_options.clock = std::make_shared<VirtualClock>();
+    world_options.slow_tick_replay_path = opts.capture;
+
+    std::string error;
+    std::unique_ptr<World> world = World::Create(0, 0, world_options, error);
+    if (!world) {
+      std::cout << error << std::endl;
+      return 1;
+    }
+
+    captured = world->GetReplayedSlowTick();
+    if (!opts.trace.empty() && run + 1 == opts.repeat && !world->StartTrace(opts.trace, error)) {
+      std::cout << error << std::endl;
+      return 1;
+    }
+
+    FlatHashMap<uint64_t, ServerPacket> packets;
+    world->UpdateSim(&packets);
+    world->StopTrace();
+
+    const TickTimings& timings = world->GetLastTickTimings();
+    for (int i = 0; i < tick_phase_count; i++) {
+      phases[i].push_back(timings.phases[i]);
+    }
+
+    totals.push_back(timings.total);
+    mismatch = mismatch || !CountsMatch(captured.counts, world->GetLastTickCounts());
+  }
+
+  const TickCounts& counts = captured.counts;
+  std::cout << "tick " << captured.tick << ", threshold " << captured.threshold * 1e3 << "ms, "
+            << counts.chunks << " chunks (" << counts.active_chunks << " active), " << counts.asteroids << " asteroids, "
+            << counts.ships << " ships, " << counts.projectiles << " projectiles" << std::endl;
+  std::cout << std::left << std::setw(24) << "phase (us)" << std::right
+            << std::setw(14) << "captured" << std::setw(14) << "replay min" << std::setw(14) << "replay p50" << std::endl;
+
+  // to_node is only timed by WorldSim
+  for (int i = 0; i < tick_phase_count; i++) {
+    PrintRow(TickPhaseToString(static_cast<TickPhase>(i)), captured.timings.phases[i], phases[i]);
+  }
+
+  PrintRow("total", captured.timings.total, totals);
+
+  if (mismatch) {
+    std::cout << "replayed tick does not match the capture -- it may have been written by a different build" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,227 @@
+// drives full ticks of a headless world with bot ships, and reports how long each phase of the tick took.
+// usage: world_bench [--dims N] [--asteroids N] [--ships N] [--ticks N] [--seed N] [--eager] [--trace FILE] [--slow-tick-ms MS --capture-dir DIR]
+
+#include <server/LoadGenerator.hpp>
+#include <server/TickTimings.hpp>
+#include <server/World.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+// matches the client's tick rate
+static const double tick_length = 1.0 / 30.0;
+
+struct BenchOptions {
+  int dims = 256;
+  int asteroids = 8192;
+  int ships = 64;
+  int ticks = 1800;
+  uint64_t seed = 1;
+  bool eager = false;
+  // chrome trace-event file to write, if any
+  std::string trace;
+  // ticks slower than this are captured for tick_replay -- 0 disables capture
+  double slow_tick_ms = 0.0;
+  std::string capture_dir;
+};
+
+static bool ParseArgs(int argc, char** argv, BenchOptions& out) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--eager") {
+      out.eager = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      std::cout << "missing value for " << arg << std::endl;
+      return false;
+    }
+
+    const char* val = argv[++i];
+    if (arg == "--dims") {
+      out.dims = std::atoi(val);
+    } else if (arg == "--asteroids") {
+      out.asteroids = std::atoi(val);
+    } else if (arg == "--ships") {
+      out.ships = std::atoi(val);
+    } else if (arg == "--ticks") {
+      out.ticks = std::atoi(val);
+    } else if (arg == "--seed") {
+      out.seed = std::strtoull(val, nullptr, 10);
+    } else if (arg == "--trace") {
+      out.trace = val;
+    } else if (arg == "--slow-tick-ms") {
+      out.slow_tick_ms = std::atof(val);
+    } else if (arg == "--capture-dir") {
+      out.capture_dir = val;
+    } else {
+      std::cout << "unknown argument " << arg << std::endl;
+      return false;
+    }
+  }
+
+  if (out.dims <= 0 || out.asteroids < 0 || out.ships < 0 || out.ticks <= 0) {
+    std::cout << "invalid arguments" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+static double Percentile(std::vector<double>& samples, double p) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+
+  size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * (samples.size() - 1) + 0.5));
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+static void PrintRow(const char* name, std::vector<double>& samples) {
+  double sum = 0.0;
+  for (double s : samples) {
+    sum += s;
+  }
+
+  double mean = (samples.empty() ? 0.0 : sum / samples.size());
+  double p50 = Percentile(samples, 0.5);
+  double p99 = Percentile(samples, 0.99);
+  double max = (samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end()));
+
+  // seconds -> microseconds
+  std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << mean * 1e6
+            << std::setw(12) << p50 * 1e6
+            << std::setw(12) << p99 * 1e6
+            << std::setw(12) << max * 1e6 << std::endl;
+}
+
+int main(int argc, char** argv) {
+  BenchOptions opts;
+  if (!ParseArgs(argc, argv, opts)) {
+    return 1;
+  }
+
+  auto clock = std::make_shared<VirtualClock>();
+  WorldOptions world_options;
+  world_options.has_seed = true;
+  world_options.seed = opts.seed;
+  world_options.eager = opts.eager;
+  world_options.clock = clock;
+  world_options.trace_path = opts.trace;
+  world_options.slow_tick_threshold = opts.slow_tick_ms / 1000.0;
+  world_options.slow_tick_dir = opts.capture_dir;
+
+  std::string error;
+  std::unique_ptr<World> world = World::Create(opts.dims, opts.asteroids, world_options, error);
+  if (!world) {
+    std::cout << error << std::endl;
+    return 1;
+  }
+
+  LoadGenerator bots(*world, opts.seed);
+  bots.SetBotCount(opts.ships);
+
+  std::vector<std::vector<double>> phases(tick_phase_count);
+  std::vector<double> totals;
+  for (auto& p : phases) {
+    p.reserve(opts.ticks);
+  }
+
+  totals.reserve(opts.ticks);
+
+  FlatHashMap<uint64_t, ServerPacket> packets;
+  for (int tick = 0; tick < opts.ticks; tick++) {
+    clock->Advance(tick_length);
+    bots.SendInputs(tick_length);
+
+    packets.clear();
+    world->UpdateSim(&packets);
+
+    const TickTimings& timings = world->GetLastTickTimings();
+    for (int i = 0; i < tick_phase_count; i++) {
+      phases[i].push_back(timings.phases[i]);
+    }
+
+    totals.push_back(timings.total);
+    bots.HandlePackets(packets);
+  }
+
+  std::cout << "dims " << opts.dims << ", asteroids " << opts.asteroids << ", ships " << opts.ships
+            << ", ticks " << opts.ticks << ", seed " << opts.seed << (opts.eager ? ", eager" : "")
+            << std::endl;
+  std::cout << std::left << std::setw(24) << "phase (us)" << std::right
+            << std::setw(12) << "mean" << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+  for (int i = 0; i < tick_phase_count; i++) {
+    PrintRow(TickPhaseToString(static_cast<TickPhase>(i)), phases[i]);
+  }
+
+  PrintRow("total", totals);
+
+  // where the time went, ship by ship
+  std::vector<ShipCost> costs;
+  world->GetCostliestShips(5, costs);
+  if (!costs.empty()) {
+    std::cout << std::endl << std::left << std::setw(24) << "costliest ships" << std::right
+              << std::setw(12) << "us/tick" << std::setw(12) << "scanned" << std::setw(12) << "deltas"
+              << std::setw(12) << "bytes" << std::setw(10) << "shots" << "  biome" << std::endl;
+  }
+
+  for (auto& cost : costs) {
+    double ticks = static_cast<double>(std::max<uint64_t>(cost.ticks, 1));
+    std::cout << std::left << std::setw(24) << ("ship " + std::to_string(cost.id)) << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << cost.fanout_time * 1e6 / ticks
+              << std::setw(12) << cost.scanned / ticks
+              << std::setw(12) << cost.deltas / ticks
+              << std::setw(12) << cost.bytes / ticks
+              << std::setw(10) << cost.projectiles << "  " << BiomeToString(cost.biome) << std::endl;
+  }
+
+  MemoryStats memory;
+  world->GetMemoryStats(memory, 0);
+  std::cout << std::endl << std::left << std::setw(24) << "memory" << std::right
+            << std::setw(12) << "count" << std::setw(12) << "KiB" << std::endl;
+  std::pair<const char*, const MemoryUsage&> rows[] = {
+    { "asteroids", memory.asteroids },
+    { "ships", memory.ships },
+    { "projectiles", memory.projectiles },
+    { "collisions", memory.collisions },
+    { "deleted", memory.deleted },
+    { "encoded", memory.encoded },
+    { "chunks", memory.chunks },
+    { "materialized", memory.materialized },
+    { "known_ids", memory.known_ids },
+    { "new_projectiles", memory.new_projectiles },
+    { "ship_index", memory.ship_index },
+    { "collision_world", memory.collision_world },
+    { "sweep_and_prune", memory.sweep_and_prune },
+    { "biome_manager", memory.biome_manager }
+  };
+
+  for (auto& row : rows) {
+    std::cout << std::left << std::setw(24) << row.first << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << row.second.count << std::setw(12) << row.second.bytes / 1024.0 << std::endl;
+  }
+
+  std::cout << std::left << std::setw(24) << "total" << std::right << std::setw(24) << memory.GetTotalBytes() / 1024.0 << std::endl;
+  std::cout << memory.empty_chunks << " of " << memory.chunks.count << " chunks are empty" << std::endl;
+
+  if (TraceRecorder* trace = world->GetTrace()) {
+    uint64_t dropped = trace->GetDroppedCount();
+    world->StopTrace();
+    std::cout << "trace written to " << opts.trace << " (" << dropped << " events dropped)" << std::endl;
+  }
+
+  return 0;
+}
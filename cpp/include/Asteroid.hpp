@@ -1,8 +1,6 @@
 #ifndef ASTEROID_H_
 #define ASTEROID_H_
 
-#include <napi.h>
-
 #include <GameTypes.hpp>
 
 #include <vector>
@@ -17,13 +15,6 @@ struct Asteroid : public Instance {
   std::vector<Point2D<float>> geometry;
   
   Asteroid();
-  Asteroid(Napi::Object obj);
-
-  /**
-   *  Returns this Asteroid as a node object.
-   *  @param env - the environment this node object is being constructed in.
-   */
-  Napi::Object ToNodeObject(Napi::Env env) const;
 };
 
 }
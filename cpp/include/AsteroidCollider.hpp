@@ -3,6 +3,7 @@
 
 #include <GameTypes.hpp>
 #include <Asteroid.hpp>
+#include <Ship.hpp>
 
 
 namespace vasteroids {
@@ -24,7 +25,42 @@ bool Collide(const Asteroid& asteroid, const WorldPosition& point, int chunk_dim
  */ 
 bool Collide(const Asteroid& asteroid, const WorldPosition& line_start, const WorldPosition& line_end, int steps, int chunk_dims);
 
-// for much later: write in asteroid/asteroid collisions?
+/**
+ *  Determines whether two asteroids overlap.
+ *  @param a - the first asteroid.
+ *  @param b - the second asteroid.
+ *  @param chunk_dims - the dimensions of the world, in chunks.
+ *  @returns true if the asteroids' outlines intersect, or one contains the other -- false otherwise.
+ */ 
+bool Collide(const Asteroid& a, const Asteroid& b, int chunk_dims);
+
+/**
+ *  Determines whether a ship overlaps an asteroid.
+ *  @param asteroid - the asteroid we're checking for collisions.
+ *  @param ship - the ship, whose outline is given by GetShipGeometry.
+ *  @param chunk_dims - the dimensions of the world, in chunks.
+ *  @returns true if a collision occurs -- false otherwise.
+ */ 
+bool Collide(const Asteroid& asteroid, const Ship& ship, int chunk_dims);
+
+/**
+ *  Determines whether a point particle hits a ship.
+ *  @param ship - the ship we're checking for collisions.
+ *  @param point - the point particle itself.
+ *  @param chunk_dims - the dimensions of the world, in chunks.
+ *  @returns true if a collision occurs -- false otherwise.
+ */ 
+bool Collide(const Ship& ship, const WorldPosition& point, int chunk_dims);
+
+/**
+ *  Applies an elastic collision response to two overlapping asteroids, with mass going with area.
+ *  Asteroids which are already moving apart are left alone, so that they don't stick.
+ *  @param a - the first asteroid.
+ *  @param b - the second asteroid.
+ *  @param chunk_dims - the dimensions of the world, in chunks.
+ *  @returns true if the asteroids were bounced, and their versions bumped.
+ */
+bool BounceAsteroids(Asteroid& a, Asteroid& b, int chunk_dims);
 
 }
 
@@ -1,8 +1,8 @@
 #ifndef ASTEROID_GENERATOR_H_
 #define ASTEROID_GENERATOR_H_
 
-#include <napi.h>
 #include <Asteroid.hpp>
+#include <RandomStream.hpp>
 
 namespace vasteroids {
 
@@ -10,8 +10,9 @@ namespace vasteroids {
  *  Generates a new asteroid with a provided number of points.
  *  @param radius - the maximum radius of our asteroid.
  *  @param points - the number of points used to represent our asteroid.
+ *  @param rng - the stream our asteroid's shape is drawn from.
  */
-Asteroid GenerateAsteroid(float radius, int32_t points);
+Asteroid GenerateAsteroid(float radius, int32_t points, RandomStream& rng);
 
 }
 
@@ -1,7 +1,7 @@
 #ifndef BIOME_H_
 #define BIOME_H_
 
-#include <napi.h>
+#include <string>
 
 namespace vasteroids {
 
@@ -15,7 +15,6 @@ enum class Biome {
 };
 
 const std::string& BiomeToString(const Biome& b);
-Napi::String BiomeToString(const Biome& b, const Napi::Env& env);
 
 }
 
@@ -0,0 +1,77 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <chrono>
+
+namespace vasteroids {
+
+/**
+ *  Source of server time, in seconds.
+ *  The sim reads it once per call, so everything done in a tick happens at the same instant.
+ */
+class Clock {
+ public:
+  virtual ~Clock() {}
+
+  /**
+   *  @returns the current time.
+   */
+  virtual double Now() = 0;
+
+  /**
+   *  Moves the clock to some time, from which it carries on as usual.
+   *  @param time - the new current time.
+   */
+  virtual void Reset(double time) = 0;
+};
+
+/**
+ *  Wall clock time, counted from when the clock was created.
+ */
+class SystemClock : public Clock {
+ public:
+  SystemClock() : origin_(std::chrono::steady_clock::now()) {}
+
+  double Now() override {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin_).count();
+  }
+
+  void Reset(double time) override {
+    origin_ = std::chrono::steady_clock::now()
+      - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time));
+  }
+
+ private:
+  std::chrono::time_point<std::chrono::steady_clock> origin_;
+};
+
+/**
+ *  A clock which only moves when told to -- for tests, replays and benchmarks.
+ */
+class VirtualClock : public Clock {
+ public:
+  VirtualClock() : time_(0.0) {}
+
+  double Now() override {
+    return time_;
+  }
+
+  void Reset(double time) override {
+    time_ = time;
+  }
+
+  /**
+   *  Moves the clock forward.
+   *  @param seconds - the amount of time which passes.
+   */
+  void Advance(double seconds) {
+    time_ += seconds;
+  }
+
+ private:
+  double time_;
+};
+
+}
+
+#endif
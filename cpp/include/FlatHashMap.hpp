@@ -0,0 +1,464 @@
+#ifndef FLAT_HASH_MAP_H_
+#define FLAT_HASH_MAP_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace vasteroids {
+
+/**
+ *  Scrambles the bits of a 64-bit value, so that nearby keys land far apart.
+ *  (splitmix64 finalizer)
+ */ 
+inline uint64_t MixHash(uint64_t x) {
+  x ^= (x >> 30);
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= (x >> 27);
+  x *= 0x94D049BB133111EBULL;
+  x ^= (x >> 31);
+  return x;
+}
+
+/**
+ *  Default hash for flat tables -- std::hash is the identity for integers, so mix its output.
+ */ 
+template <typename T>
+struct FlatHash {
+  std::size_t operator()(const T& key) const noexcept {
+    return static_cast<std::size_t>(MixHash(static_cast<uint64_t>(std::hash<T>()(key))));
+  }
+};
+
+/**
+ *  Open addressing hash table, storing its entries in a single flat array.
+ *  Probes linearly, with a control byte per slot holding 7 bits of the hash,
+ *  so most mismatches are rejected without touching the entries themselves.
+ *  Erased slots leave tombstones, which are cleaned up when the table is rebuilt.
+ *
+ *  Unlike the node-based std containers, inserting may move existing entries,
+ *  so pointers and iterators are invalidated by insertion (but not by erasure).
+ *
+ *  @param Value - the type stored in each slot.
+ *  @param Key - the type used for lookup.
+ *  @param KeyOf - functor returning the key of a stored value.
+ *  @param Hash - hash functor for keys.
+ */ 
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+class FlatHashTable {
+  static constexpr uint8_t kEmpty = 0x80;
+  static constexpr uint8_t kDeleted = 0xFE;
+
+ public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef std::size_t size_type;
+
+  template <typename Table, typename Ref>
+  class Iterator {
+   public:
+    Iterator() : table_(nullptr), index_(0) {}
+    Iterator(Table* table, size_t index) : table_(table), index_(index) {
+      SkipEmpty();
+    }
+
+    // allow iterator -> const_iterator
+    template <typename T, typename R>
+    Iterator(const Iterator<T, R>& other) : table_(other.table_), index_(other.index_) {}
+
+    Ref operator*() const {
+      return table_->slots_[index_];
+    }
+
+    typename std::remove_reference<Ref>::type* operator->() const {
+      return &table_->slots_[index_];
+    }
+
+    Iterator& operator++() {
+      index_++;
+      SkipEmpty();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator res = *this;
+      ++(*this);
+      return res;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    template <typename, typename, typename, typename>
+    friend class FlatHashTable;
+
+    template <typename, typename>
+    friend class Iterator;
+
+    void SkipEmpty() {
+      while (index_ < table_->capacity_ && !IsFull(table_->ctrl_[index_])) {
+        index_++;
+      }
+    }
+
+    Table* table_;
+    size_t index_;
+  };
+
+  typedef Iterator<FlatHashTable, Value&> iterator;
+  typedef Iterator<const FlatHashTable, const Value&> const_iterator;
+
+  FlatHashTable() : slots_(nullptr), capacity_(0), size_(0), tombstones_(0) {}
+
+  FlatHashTable(const FlatHashTable& other) : FlatHashTable() {
+    Rehash(other.size_);
+    for (auto& v : other) {
+      InsertUnique(v);
+    }
+  }
+
+  FlatHashTable(FlatHashTable&& other) noexcept : FlatHashTable() {
+    Swap(other);
+  }
+
+  FlatHashTable& operator=(const FlatHashTable& other) {
+    if (this != &other) {
+      FlatHashTable copy(other);
+      Swap(copy);
+    }
+
+    return *this;
+  }
+
+  FlatHashTable& operator=(FlatHashTable&& other) noexcept {
+    if (this != &other) {
+      FlatHashTable empty;
+      Swap(empty);
+      Swap(other);
+    }
+
+    return *this;
+  }
+
+  ~FlatHashTable() {
+    Destroy();
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // number of slots allocated -- zero until the first insert
+  size_t bucket_count() const { return capacity_; }
+
+  /**
+   *  Removes all entries, but keeps the allocated slots around for reuse.
+   */ 
+  void clear() {
+    for (size_t i = 0; i < capacity_; i++) {
+      if (IsFull(ctrl_[i])) {
+        slots_[i].~Value();
+      }
+
+      ctrl_[i] = kEmpty;
+    }
+
+    size_ = 0;
+    tombstones_ = 0;
+  }
+
+  /**
+   *  Ensures that `count` entries can be stored without rebuilding the table.
+   */ 
+  void reserve(size_t count) {
+    if (count > MaxLoad(capacity_)) {
+      Rehash(count);
+    }
+  }
+
+  iterator find(const Key& key) {
+    return iterator(this, FindIndex(key));
+  }
+
+  const_iterator find(const Key& key) const {
+    return const_iterator(this, FindIndex(key));
+  }
+
+  size_t count(const Key& key) const {
+    return (FindIndex(key) != capacity_ ? 1 : 0);
+  }
+
+  /**
+   *  Inserts a value, if its key is not already present.
+   *  @returns an iterator to the entry with this key, and whether the value was inserted.
+   */ 
+  std::pair<iterator, bool> insert(const Value& value) {
+    return Emplace(KeyOf()(value), value);
+  }
+
+  std::pair<iterator, bool> insert(Value&& value) {
+    const Key& key = KeyOf()(value);
+    return Emplace(key, std::move(value));
+  }
+
+  /**
+   *  Removes the entry at `itr`.
+   *  @returns an iterator to the next entry.
+   */ 
+  iterator erase(const_iterator itr) {
+    EraseIndex(itr.index_);
+    return iterator(this, itr.index_ + 1);
+  }
+
+  /**
+   *  Removes the entry associated with `key`.
+   *  @returns the number of entries removed.
+   */ 
+  size_t erase(const Key& key) {
+    size_t index = FindIndex(key);
+    if (index == capacity_) {
+      return 0;
+    }
+
+    EraseIndex(index);
+    return 1;
+  }
+
+ protected:
+  // inserts `value` under `key` unless the key exists, constructing from args.
+  template <typename... Args>
+  std::pair<iterator, bool> Emplace(const Key& key, Args&&... args) {
+    size_t hash = Hash()(key);
+    size_t index = FindIndex(key, hash);
+    if (index != capacity_) {
+      return std::make_pair(iterator(this, index), false);
+    }
+
+    if (size_ + tombstones_ + 1 > MaxLoad(capacity_)) {
+      // if the table is mostly tombstones, rebuilding at the same size is enough.
+      // otherwise, leave room to grow so that insert/erase churn doesn't rebuild every time.
+      Rehash(2 * (size_ + 1) > MaxLoad(capacity_) ? 2 * (size_ + 1) : size_ + 1);
+    }
+
+    index = FindSlot(hash);
+    if (ctrl_[index] == kDeleted) {
+      tombstones_--;
+    }
+
+    new (&slots_[index]) Value(std::forward<Args>(args)...);
+    ctrl_[index] = H2(hash);
+    size_++;
+    return std::make_pair(iterator(this, index), true);
+  }
+
+ private:
+  static bool IsFull(uint8_t ctrl) {
+    return (ctrl & 0x80) == 0;
+  }
+
+  static uint8_t H2(size_t hash) {
+    return static_cast<uint8_t>(hash & 0x7F);
+  }
+
+  // no more than 7/8 of slots may be occupied
+  static size_t MaxLoad(size_t capacity) {
+    return capacity - capacity / 8;
+  }
+
+  size_t FindIndex(const Key& key) const {
+    return FindIndex(key, Hash()(key));
+  }
+
+  // returns capacity_ if absent
+  size_t FindIndex(const Key& key, size_t hash) const {
+    if (capacity_ == 0) {
+      return 0;
+    }
+
+    const size_t mask = capacity_ - 1;
+    const uint8_t h2 = H2(hash);
+    for (size_t index = (hash >> 7) & mask; ; index = (index + 1) & mask) {
+      uint8_t ctrl = ctrl_[index];
+      if (ctrl == kEmpty) {
+        return capacity_;
+      }
+
+      if (ctrl == h2 && KeyOf()(slots_[index]) == key) {
+        return index;
+      }
+    }
+  }
+
+  // first empty or deleted slot along the probe sequence for `hash`
+  size_t FindSlot(size_t hash) const {
+    const size_t mask = capacity_ - 1;
+    size_t index = (hash >> 7) & mask;
+    while (IsFull(ctrl_[index])) {
+      index = (index + 1) & mask;
+    }
+
+    return index;
+  }
+
+  void EraseIndex(size_t index) {
+    slots_[index].~Value();
+    size_--;
+    // a probe for some other key only continues past this slot if its neighbor is in use
+    if (ctrl_[(index + 1) & (capacity_ - 1)] == kEmpty) {
+      ctrl_[index] = kEmpty;
+    } else {
+      ctrl_[index] = kDeleted;
+      tombstones_++;
+    }
+  }
+
+  // rebuilds the table with room for at least `count` entries
+  void Rehash(size_t count) {
+    size_t capacity = 8;
+    while (MaxLoad(capacity) < count) {
+      capacity *= 2;
+    }
+
+    std::unique_ptr<uint8_t[]> old_ctrl = std::move(ctrl_);
+    Value* old_slots = slots_;
+    size_t old_capacity = capacity_;
+
+    ctrl_.reset(new uint8_t[capacity]);
+    std::fill(ctrl_.get(), ctrl_.get() + capacity, kEmpty);
+    slots_ = std::allocator<Value>().allocate(capacity);
+    capacity_ = capacity;
+    tombstones_ = 0;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+      if (IsFull(old_ctrl[i])) {
+        size_t hash = Hash()(KeyOf()(old_slots[i]));
+        size_t index = FindSlot(hash);
+        new (&slots_[index]) Value(std::move(old_slots[i]));
+        ctrl_[index] = H2(hash);
+        old_slots[i].~Value();
+      }
+    }
+
+    if (old_slots != nullptr) {
+      std::allocator<Value>().deallocate(old_slots, old_capacity);
+    }
+  }
+
+  // inserts a value known to be absent
+  void InsertUnique(const Value& value) {
+    size_t hash = Hash()(KeyOf()(value));
+    size_t index = FindSlot(hash);
+    new (&slots_[index]) Value(value);
+    ctrl_[index] = H2(hash);
+    size_++;
+  }
+
+  void Destroy() {
+    if (slots_ == nullptr) {
+      return;
+    }
+
+    for (size_t i = 0; i < capacity_; i++) {
+      if (IsFull(ctrl_[i])) {
+        slots_[i].~Value();
+      }
+    }
+
+    std::allocator<Value>().deallocate(slots_, capacity_);
+    slots_ = nullptr;
+    ctrl_.reset();
+    capacity_ = 0;
+    size_ = 0;
+    tombstones_ = 0;
+  }
+
+  void Swap(FlatHashTable& other) noexcept {
+    std::swap(ctrl_, other.ctrl_);
+    std::swap(slots_, other.slots_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(size_, other.size_);
+    std::swap(tombstones_, other.tombstones_);
+  }
+
+  // one control byte per slot: kEmpty, kDeleted, or the low 7 bits of the entry's hash
+  std::unique_ptr<uint8_t[]> ctrl_;
+  Value* slots_;
+  // always zero or a power of two
+  size_t capacity_;
+  size_t size_;
+  size_t tombstones_;
+};
+
+template <typename K, typename V>
+struct FlatMapKey {
+  const K& operator()(const std::pair<K, V>& value) const {
+    return value.first;
+  }
+};
+
+template <typename K>
+struct FlatSetKey {
+  const K& operator()(const K& value) const {
+    return value;
+  }
+};
+
+/**
+ *  Flat replacement for std::unordered_map.
+ *  @param K - key type
+ *  @param V - value type
+ */ 
+template <typename K, typename V, typename Hash = FlatHash<K>>
+class FlatHashMap : public FlatHashTable<std::pair<K, V>, K, FlatMapKey<K, V>, Hash> {
+  typedef FlatHashTable<std::pair<K, V>, K, FlatMapKey<K, V>, Hash> Table;
+ public:
+  typedef V mapped_type;
+
+  V& at(const K& key) {
+    auto itr = this->find(key);
+    if (itr == this->end()) {
+      throw std::out_of_range("FlatHashMap::at");
+    }
+
+    return itr->second;
+  }
+
+  const V& at(const K& key) const {
+    auto itr = this->find(key);
+    if (itr == this->end()) {
+      throw std::out_of_range("FlatHashMap::at");
+    }
+
+    return itr->second;
+  }
+
+  V& operator[](const K& key) {
+    return this->Emplace(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first->second;
+  }
+};
+
+/**
+ *  Flat replacement for std::unordered_set.
+ *  @param K - key type
+ */ 
+template <typename K, typename Hash = FlatHash<K>>
+class FlatHashSet : public FlatHashTable<K, K, FlatSetKey<K>, Hash> {};
+
+}
+
+#endif
@@ -1,22 +1,10 @@
 #ifndef GAME_TYPES_H_
 #define GAME_TYPES_H_
 
-#include <napi.h>
 #include <chrono>
+#include <cinttypes>
 #include <iostream>
-
-// throws a new type error, and returns.
-#define TYPEERROR(env, x) {\
-  std::cout << x << std::endl;\
-  Napi::TypeError::New(env, x).ThrowAsJavaScriptException();\
-  return;\
-}
-
-#define TYPEERROR_RETURN_UNDEF(env, x) {\
-  std::cout << x << std::endl;\
-  Napi::TypeError::New(env, x).ThrowAsJavaScriptException();\
-  return env.Undefined();\
-}
+#include <string>
 
 namespace vasteroids {
 
@@ -41,28 +29,11 @@ namespace vasteroids {
 
     Point2D() {}
 
-    Point2D(Napi::Object obj) {
-      Napi::Env env = obj.Env();
-      if (!obj.Has("x") || !obj.Has("y")) {
-        TYPEERROR(env, "point does not contain correct fields");
-      }
-
-      x = static_cast<T>(obj.Get("x").As<Napi::Number>().DoubleValue());
-      y = static_cast<T>(obj.Get("y").As<Napi::Number>().DoubleValue());
-    }
-
     Point2D(T x, T y) {
       this->x = x;
       this->y = y;
     }
 
-    Napi::Object ToNodeObject(Napi::Env env) const {
-      Napi::Object obj = Napi::Object::New(env);
-      obj.Set("x", x);
-      obj.Set("y", y);
-      return obj;
-    }
-
     Point2D& operator=(const Point2D<T>& rhs) {
       this->x = rhs.x;
       this->y = rhs.y;
@@ -118,13 +89,6 @@ namespace vasteroids {
       position.x = 0.0f;
       position.y = 0.0f;
     }
-    
-    WorldPosition(Napi::Object obj);
-
-    /**
-     *  Returns this worldposition as a Node object.
-     */ 
-    Napi::Object ToNodeObject(Napi::Env env) const;
   };
 
   struct Instance {
@@ -147,9 +111,6 @@ namespace vasteroids {
 
     // def ctor, no init
     Instance() {}
-    Instance(Napi::Object obj);
-
-    virtual Napi::Object ToNodeObject(Napi::Env env) const;
   };
 
 } // namespace vasteroids
@@ -159,9 +120,11 @@ namespace std {
 template<>
 struct hash<vasteroids::Point2D<int>> {
   std::size_t operator()(vasteroids::Point2D<int> const& p) const noexcept {
-    std::size_t base = static_cast<size_t>(p.x) << 31;
-    base |= static_cast<size_t>(p.y);
-    return base;
+    // pack both coordinates without overlap -- negative values would otherwise sign-extend over x.
+    // FlatHash mixes this further.
+    uint64_t base = static_cast<uint64_t>(static_cast<uint32_t>(p.x)) << 32;
+    base |= static_cast<uint64_t>(static_cast<uint32_t>(p.y));
+    return static_cast<std::size_t>(base);
   }
 };
 
@@ -0,0 +1,157 @@
+#ifndef RANDOM_STREAM_H_
+#define RANDOM_STREAM_H_
+
+#include <FlatHashMap.hpp>
+#include <GameTypes.hpp>
+
+#include <cinttypes>
+#include <cmath>
+#include <limits>
+
+namespace vasteroids {
+
+/**
+ *  What a stream of random numbers is used for.
+ *  Each purpose draws from its own streams, so adding draws to one never shifts another.
+ */
+enum class RandomPurpose : uint32_t {
+  WORLD = 1,
+  BIOME_ORIGINS = 2,
+  BIOME_WEIGHTS = 3,
+  SPAWN_CHUNKS = 4,
+  ASTEROID = 5,
+  CHUNK_CONTENTS = 6,
+  // the load generator's bots -- kept apart so that they never draw from the sim's own streams
+  BOTS = 7
+};
+
+/**
+ *  Counter-based random number generator.
+ *  The n-th number of a stream is a hash of its key and n, so a stream is nothing but a key and a counter.
+ *  Streams are keyed by the world seed, a purpose, and optionally a chunk or an ID --
+ *  so they can be created wherever they are needed, on any thread, and always produce the same numbers.
+ *
+ *  Satisfies UniformRandomBitGenerator, so it can drive the std distributions as well.
+ */
+class RandomStream {
+ public:
+  typedef uint64_t result_type;
+
+  /**
+   *  Creates a world stream for seed 0.
+   */
+  RandomStream() : RandomStream(0, RandomPurpose::WORLD) {}
+
+  /**
+   *  Creates a stream for some purpose which is shared by the whole world.
+   *  @param seed - the world seed.
+   *  @param purpose - what this stream is used for.
+   */
+  RandomStream(uint64_t seed, RandomPurpose purpose) : RandomStream(seed, purpose, 0) {}
+
+  /**
+   *  Creates a stream for some purpose, specific to a single chunk.
+   *  @param seed - the world seed.
+   *  @param purpose - what this stream is used for.
+   *  @param chunk - the chunk this stream belongs to.
+   */
+  RandomStream(uint64_t seed, RandomPurpose purpose, Point2D<int> chunk)
+    : RandomStream(seed, purpose, (static_cast<uint64_t>(static_cast<uint32_t>(chunk.x)) << 32) | static_cast<uint32_t>(chunk.y)) {}
+
+  /**
+   *  Creates a stream for some purpose, specific to some index (an instance ID, for instance).
+   *  @param seed - the world seed.
+   *  @param purpose - what this stream is used for.
+   *  @param index - the index this stream belongs to.
+   */
+  RandomStream(uint64_t seed, RandomPurpose purpose, uint64_t index) : counter_(0) {
+    key_ = MixHash(seed + golden);
+    key_ = MixHash(key_ ^ static_cast<uint64_t>(purpose));
+    key_ = MixHash(key_ ^ index);
+  }
+
+  /**
+   *  @returns the next 64 random bits in this stream.
+   */
+  uint64_t operator()() {
+    // splitmix64, with the state computed from the counter
+    return MixHash(key_ + (++counter_) * golden);
+  }
+
+  /**
+   *  @returns a random double in [0, 1).
+   */
+  double NextDouble() {
+    return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  /**
+   *  @returns a random float in [min, max).
+   */
+  float NextFloat(float min, float max) {
+    return static_cast<float>(min + NextDouble() * (max - min));
+  }
+
+  /**
+   *  @returns a random int in [min, max].
+   */
+  int NextInt(int min, int max) {
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+    // 32 random bits scaled to our range -- bias is negligible for the ranges we use
+    return static_cast<int>(min + static_cast<int64_t>((((*this)() >> 32) * range) >> 32));
+  }
+
+  /**
+   *  @returns a normally distributed double. Takes two draws, and carries nothing over to the next call.
+   */
+  double NextGaussian(double mean, double stddev) {
+    // box-muller, discarding the second value. u is in (0, 1], so the log is finite
+    double u = 1.0 - NextDouble();
+    double v = NextDouble();
+    return mean + stddev * std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+  }
+
+  /**
+   *  Creates a new stream derived from this one, which does not overlap with it.
+   *  @param index - identifies the new stream among this stream's substreams.
+   */
+  RandomStream Substream(uint64_t index) const {
+    RandomStream res(*this);
+    res.key_ = MixHash(key_ ^ MixHash(index + golden));
+    res.counter_ = 0;
+    return res;
+  }
+
+  /**
+   *  @returns the number of values drawn from this stream so far.
+   */
+  uint64_t GetCounter() const {
+    return counter_;
+  }
+
+  /**
+   *  Jumps to some position in this stream.
+   *  @param counter - the number of values which should appear to have been drawn.
+   */
+  void Seek(uint64_t counter) {
+    counter_ = counter;
+  }
+
+  static constexpr uint64_t min() {
+    return 0;
+  }
+
+  static constexpr uint64_t max() {
+    return std::numeric_limits<uint64_t>::max();
+  }
+
+ private:
+  static constexpr uint64_t golden = 0x9E3779B97F4A7C15ULL;
+
+  uint64_t key_;
+  uint64_t counter_;
+};
+
+}
+
+#endif
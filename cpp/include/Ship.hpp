@@ -3,6 +3,8 @@
 
 #include <GameTypes.hpp>
 
+#include <vector>
+
 namespace vasteroids {
 
 struct Ship : public Instance {
@@ -11,12 +13,17 @@ struct Ship : public Instance {
   bool destroyed;
   int lives;
 
-  Ship();
-  Ship(Napi::Object obj);
+  // CPP ONLY: server time at which this ship last (re)spawned, used for invulnerability.
+  double spawn_time;
 
-  Napi::Object ToNodeObject(Napi::Env env) const override;
+  Ship();
 };
 
+/**
+ *  @returns the outline of a ship, relative to its center -- matches the shape drawn by the client.
+ */ 
+const std::vector<Point2D<float>>& GetShipGeometry();
+
 }
 
 #endif
\ No newline at end of file
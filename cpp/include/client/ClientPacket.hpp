@@ -6,6 +6,8 @@
 
 #include <Projectile.hpp>
 
+#include <vector>
+
 namespace vasteroids {
 namespace client {
 
@@ -14,7 +16,6 @@ struct ClientPacket {
   std::vector<Projectile> projectiles;
 
   ClientPacket() {}
-  ClientPacket(Napi::Object obj);
 };
 
 }
@@ -0,0 +1,114 @@
+#ifndef NODE_TYPES_H_
+#define NODE_TYPES_H_
+
+#include <Asteroid.hpp>
+#include <BiomeInfo.hpp>
+#include <Collision.hpp>
+#include <GameTypes.hpp>
+#include <Projectile.hpp>
+#include <Ship.hpp>
+#include <client/ClientPacket.hpp>
+#include <server/MemoryStats.hpp>
+#include <server/ServerPacket.hpp>
+#include <server/ShipCost.hpp>
+#include <server/TickStats.hpp>
+
+#include <napi.h>
+
+#include <iostream>
+
+// throws a new type error, and returns.
+#define TYPEERROR(env, x) {\
+  std::cout << x << std::endl;\
+  Napi::TypeError::New(env, x).ThrowAsJavaScriptException();\
+  return;\
+}
+
+#define TYPEERROR_RETURN_UNDEF(env, x) {\
+  std::cout << x << std::endl;\
+  Napi::TypeError::New(env, x).ThrowAsJavaScriptException();\
+  return env.Undefined();\
+}
+
+// throws a new type error, and returns false.
+#define TYPEERROR_RETURN_FALSE(env, x) {\
+  std::cout << x << std::endl;\
+  Napi::TypeError::New(env, x).ThrowAsJavaScriptException();\
+  return false;\
+}
+
+/**
+ *  Conversions between the sim's types and their JS counterparts.
+ *  This is the only place the game types meet N-API -- the sim itself knows nothing of Node.
+ */
+namespace vasteroids {
+namespace node {
+
+template <typename T>
+Napi::Object ToNodeObject(Napi::Env env, const Point2D<T>& point) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("x", point.x);
+  obj.Set("y", point.y);
+  return obj;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const WorldPosition& pos);
+Napi::Object ToNodeObject(Napi::Env env, const Instance& inst);
+Napi::Object ToNodeObject(Napi::Env env, const Asteroid& asteroid);
+Napi::Object ToNodeObject(Napi::Env env, const Ship& ship);
+Napi::Object ToNodeObject(Napi::Env env, const Projectile& proj);
+Napi::Object ToNodeObject(Napi::Env env, const Collision& collision);
+Napi::Object ToNodeObject(Napi::Env env, const BiomeInfo& info);
+Napi::Object ToNodeObject(Napi::Env env, const server::ServerPacket& packet);
+
+/**
+ *  Summarizes the rolling tick stats. Times are in milliseconds.
+ *  @returns { ticks, window, phases: { [phase]: { mean, p50, p99, max } }, total: { ... }, counts: { ... } }
+ */
+Napi::Object ToNodeObject(Napi::Env env, const server::TickStats& stats);
+
+/**
+ *  Converts what a ship has cost the server. Times are in milliseconds.
+ *  @returns { id, chunk, biome, ticks, fanoutMs, lastFanoutMs, inputMs, scanned, deltas, bytes, projectiles }
+ */
+Napi::Object ToNodeObject(Napi::Env env, const server::ShipCost& cost);
+
+/**
+ *  Converts a world's memory usage. Each entry is a `{ count, bytes }` pair.
+ *  @returns { totalBytes, asteroids, ships, ..., emptyChunks, largestChunks: [{ chunk, bytes, asteroids, ... }] }
+ */
+Napi::Object ToNodeObject(Napi::Env env, const server::MemoryStats& stats);
+
+Napi::String BiomeToString(const Biome& b, const Napi::Env& env);
+
+/**
+ *  Reads a point from a JS object.
+ *  @param obj - object containing `x` and `y` fields.
+ *  @param out - output param, receiving the point.
+ *  @returns false, with a TypeError pending, if `obj` is not a point.
+ */
+template <typename T>
+bool FromNodeObject(Napi::Object obj, Point2D<T>& out) {
+  Napi::Env env = obj.Env();
+  if (!obj.Has("x") || !obj.Has("y")) {
+    TYPEERROR_RETURN_FALSE(env, "point does not contain correct fields");
+  }
+
+  out.x = static_cast<T>(obj.Get("x").As<Napi::Number>().DoubleValue());
+  out.y = static_cast<T>(obj.Get("y").As<Napi::Number>().DoubleValue());
+  return true;
+}
+
+// as above: each returns false, with a TypeError pending, if a field is missing.
+bool FromNodeObject(Napi::Object obj, WorldPosition& out);
+bool FromNodeObject(Napi::Object obj, Instance& out);
+bool FromNodeObject(Napi::Object obj, Asteroid& out);
+bool FromNodeObject(Napi::Object obj, Ship& out);
+bool FromNodeObject(Napi::Object obj, Projectile& out);
+bool FromNodeObject(Napi::Object obj, Collision& out);
+bool FromNodeObject(Napi::Object obj, client::ClientPacket& out);
+
+}
+}
+
+#endif
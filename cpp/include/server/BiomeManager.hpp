@@ -1,12 +1,15 @@
 #ifndef BIOME_MANAGER_H_
 #define BIOME_MANAGER_H_
 
-#include <server/BiomeTree.hpp>
+#include <server/WeightedSampler.hpp>
 #include <Biome.hpp>
+#include <RandomStream.hpp>
 
 #include <GameTypes.hpp>
 
-#include <random>
+#include <cinttypes>
+#include <ostream>
+#include <vector>
 
 namespace vasteroids {
 namespace server {
@@ -21,8 +24,17 @@ class BiomeManager {
    *  Creates a new biome manager, which tracks the biome assigned to each chunk.
    *  @param chunk_dims - the dimensions of our world, in chunks.
    *  @param biome_count - the number of biomes to spawn.
+   *  @param seed - the world seed. The same seed always produces the same map.
    */ 
-  BiomeManager(int chunk_dims, int biome_count);
+  BiomeManager(int chunk_dims, int biome_count, uint64_t seed);
+
+  /**
+   *  Restores a biome manager from a saved biome map.
+   *  @param chunk_dims - the dimensions of our world, in chunks.
+   *  @param biome_map - chunk (x * chunk_dims + y) -> biome, as returned by GetBiomeMap.
+   *  @param seed - the world seed the map was generated from.
+   */ 
+  BiomeManager(int chunk_dims, std::vector<uint8_t> biome_map, uint64_t seed);
 
   /**
    *  @param chunk - the chunk whose biome we are fetching. Accounts for wrap.
@@ -30,33 +42,113 @@ class BiomeManager {
    */ 
   Biome GetBiome(Point2D<int> chunk);
 
+  /**
+   *  Copies the biomes of a rectangle of chunks, one byte per chunk.
+   *  @param origin - the chunk in the top-left corner. Accounts for wrap.
+   *  @param dims - the size of the rectangle, in chunks.
+   *  @param out - output param, holding at least dims.x * dims.y bytes.
+   *               out[i * dims.y + j] receives the biome of chunk (origin.x + i, origin.y + j).
+   */ 
+  void GetBiomeRegion(Point2D<int> origin, Point2D<int> dims, uint8_t* out);
+
   /**
    *  @returns a random chunk to spawn an asteroid in.
    */ 
   Point2D<int> GetRandomChunk();
 
-  ~BiomeManager();
+  /**
+   *  Sets the number of asteroids we expect the world to hold.
+   *  Each chunk's share of this, according to its biome, is the count its spawn weight is balanced against.
+   *  Until told otherwise, every chunk is assumed to hold its share.
+   *  @param count - the total number of asteroids in a full world.
+   */ 
+  void SetAsteroidTarget(int count);
+
+  /**
+   *  @param chunk - the chunk being queried. Accounts for wrap.
+   *  @returns the number of asteroids this chunk should hold on average, according to its biome.
+   */ 
+  double GetExpectedAsteroids(Point2D<int> chunk) const;
+
+  /**
+   *  Adjusts how likely asteroids are to spawn in a chunk, based on how many it already holds.
+   *  Chunks holding more than their share are picked less often, and empty ones more often.
+   *  @param chunk - the chunk being updated. Accounts for wrap.
+   *  @param asteroid_count - the number of asteroids currently in that chunk.
+   */ 
+  void UpdateChunkCrowding(Point2D<int> chunk, int asteroid_count);
+
+  /**
+   *  Reports the asteroid count of every chunk at once, rebuilding spawn weights in a single pass.
+   *  @param asteroid_counts - chunk (x * chunk_dims + y) -> number of asteroids in that chunk.
+   */ 
+  void SetAsteroidCounts(const std::vector<int>& asteroid_counts);
+
+  /**
+   *  @returns the biome of every chunk, indexed by (x * chunk_dims + y).
+   */ 
+  const std::vector<uint8_t>& GetBiomeMap() const;
+
+  /**
+   *  @returns the number of spawn chunks picked so far -- enough to resume picking them where we left off.
+   */ 
+  uint64_t GetSpawnCounter() const;
+
+  /**
+   *  Resumes picking spawn chunks from a point returned by GetSpawnCounter.
+   */ 
+  void SetSpawnCounter(uint64_t counter);
+
+  /**
+   *  Prints the biome map, one character per chunk, for debugging.
+   *  @param out - the stream we print to.
+   */ 
+  void PrintMap(std::ostream& out);
+
+  /**
+   *  @returns the heap memory held by this biome manager, in bytes.
+   */ 
+  size_t GetAllocatedBytes() const;
 
   BiomeManager(const BiomeManager& other) = delete;
   BiomeManager(BiomeManager&& other) = delete;
   BiomeManager& operator=(const BiomeManager& other) = delete;
   BiomeManager& operator=(BiomeManager&& other) = delete;
  private:
+  // assigns each chunk the biome of its nearest origin, wrapping around the world edges
+  void BuildBiomeMap(const std::vector<Point2D<int>>& origins, const std::vector<Biome>& biomes);
+
+  // weighs each chunk by its biome, and builds the spawn sampler from those weights
+  void BuildWeights();
+
   float GetDistanceSquared(const Point2D<int>& a, const Point2D<int>& b);
+
+  // wraps a single chunk coordinate into [0, chunk_dims)
+  int WrapCoord(int coord) const;
+  // spawn weight of a biome, before each chunk's fudge factor
   double GetBiomeWeight(const Biome& b);
+
+  // spawn weight for a chunk with some base weight and asteroid count
+  double GetCrowdedWeight(double base, int asteroid_count);
   const int chunk_dims_;
-  Biome** biome_map_;
+  // chunk (x * chunk_dims + y) -> biome, stored as a byte
+  std::vector<uint8_t> biome_map_;
 
   double prob_sum_;
 
-  std::mt19937 generator_;
-  std::uniform_int_distribution<int> chunks_;
-  std::uniform_int_distribution<int> biomes_;
-  std::uniform_real_distribution<double> biome_fudge_;
+  // expected asteroids per unit of base weight
+  double asteroid_density_;
+
+  const uint64_t seed_;
 
-  std::uniform_real_distribution<double> biome_picker_;
+  // picks spawn chunks -- the only stream drawn from after construction
+  RandomStream spawn_rng_;
 
-  BiomeTree<double, Point2D<int>> biome_prob_tree_;
+  // chunk (x * chunk_dims + y) -> weight from its biome alone
+  std::vector<double> base_weights_;
+  // chunk (x * chunk_dims + y) -> last reported asteroid count
+  std::vector<int> asteroid_counts_;
+  WeightedSampler sampler_;
 
 };
 
@@ -1,26 +1,23 @@
 #ifndef BIOME_TREE_H_
 #define BIOME_TREE_H_
 
+#include <algorithm>
 #include <cinttypes>
-#include <memory>
+#include <utility>
+#include <vector>
 
 namespace vasteroids {
 namespace server {
 
-template <typename Key, typename Val>
-struct Node {
-  std::shared_ptr<Node<Key, Val>> left;
-  std::shared_ptr<Node<Key, Val>> right;
-
-  Key key;
-  Val val;
-
-  int32_t height;
-};
-
 /**
- *  AVL tree which returns the largest stored element which is less than the requested value.
+ *  Search tree which returns the largest stored element which is less than the requested value.
  *  Used to randomly assign asteroids to biomes.
+ *
+ *  Entries are laid out in a single array in Eytzinger (breadth-first) order, so a lookup
+ *  walks down one contiguous array with a single comparison per level and no pointer chasing.
+ *  The layout is rebuilt lazily on the first lookup after an insert, so bulk loading is O(n log n) --
+ *  or O(n) if the keys are already sorted.
+ *
  *  @param U - key type
  *  @param V - value type
  */ 
@@ -30,16 +27,30 @@ class BiomeTree {
   /**
    *  Constructs a new BiomeTree.
    */ 
-  BiomeTree() {
-    root_ = nullptr;
-  }
+  BiomeTree() : keys_(1), vals_(1), sorted_(true), dirty_(false) {}
 
   /**
    *  Insert a new value into this BiomeTree.
    *  @param val - the new value being inserted.
    */ 
   void Insert(U key, V val) {
-    root_ = InsertRecursive(root_, key, val);
+    // appending in order keeps the pending entries sorted, so the rebuild can skip its sort
+    if (!entries_.empty() && key < entries_.back().first) {
+      sorted_ = false;
+    }
+
+    entries_.emplace_back(key, val);
+    dirty_ = true;
+  }
+
+  /**
+   *  Replaces the contents of this tree, and lays it out immediately.
+   *  @param entries - key/value pairs. Ideally sorted by key already.
+   */ 
+  void Build(std::vector<std::pair<U, V>> entries) {
+    entries_ = std::move(entries);
+    sorted_ = std::is_sorted(entries_.begin(), entries_.end(), ByKey);
+    Layout();
   }
 
   /**
@@ -49,140 +60,80 @@ class BiomeTree {
    *  @returns true if a valid entry could be found, false otherwise.
    */ 
   bool Lookup(U key, V* value) {
-    std::shared_ptr<Node<U, V>> active_node = root_;
-
-    if (active_node == nullptr) {
-      return false;
+    if (dirty_) {
+      Layout();
     }
 
-    bool valid = false;
-
-    while (active_node != nullptr) {
-      if (key < active_node->key) {
-        active_node = active_node->left;
-      } else {
-        valid = true;
-        *value = active_node->val;
-        active_node = active_node->right;
-      }
+    // descend, remembering the last node which was <= key.
+    // that is the last time we stepped right, which makes it the predecessor.
+    const size_t n = keys_.size() - 1;
+    size_t best = 0;
+    size_t k = 1;
+    while (k <= n) {
+      bool right = !(key < keys_[k]);
+      best = (right ? k : best);
+      k = 2 * k + right;
     }
 
-    return valid;
-  }
-  
- private:
-
-  // recursive insert method.
-  // returns new root.
-  std::shared_ptr<Node<U, V>> InsertRecursive(std::shared_ptr<Node<U, V>> root, U key, V val) {
-    if (root == nullptr) {
-      std::shared_ptr<Node<U, V>> res = std::make_shared<Node<U, V>>();
-      res->key = key;
-      res->val = val;
-      res->left = res->right = nullptr;
-      res->height = 0;
-      return res;
-    }
-
-    // check left/right
-    if (key < root->key) {
-      root->left = InsertRecursive(root->left, key, val);
-    } else {
-      root->right = InsertRecursive(root->right, key, val);
+    if (best == 0) {
+      return false;
     }
 
-    root->height = std::max(GetHeight(root->left), GetHeight(root->right)) + 1;
-
-
-    // then rotate if necessary.
-    return TryRotate(root);
+    *value = vals_[best];
+    return true;
   }
 
-  // properly rotates the tree about `root`.
-  // @param root - the root we wish to rotate.
-  // @returns the new root of the passed subtree.
-  std::shared_ptr<Node<U, V>> TryRotate(std::shared_ptr<Node<U, V>> root) {
-    if (root == nullptr) {
-      return nullptr;
-    }
-
-    int32_t height_l, height_r;
-    height_l = GetHeight(root->left);
-    height_r = GetHeight(root->right);
-
-    if (std::abs(height_l - height_r) > 1) {
-      if (height_l > height_r) {
-        if (root->left->right == nullptr) {
-          // single right rotation wrt root
-          return RotateRight(root);
-        } else {
-          // left must be null
-          root->left = RotateLeft(root->left);
-          // simple right
-          return RotateRight(root);
-        }
-      } else {
-        if (root->right->left == nullptr) {
-          return RotateLeft(root);
-        } else {
-          root->right = RotateRight(root->right);
-          return RotateLeft(root);
-        }
-      }
-    }
-
-    return root;
+  /**
+   *  @returns the number of entries stored in this tree.
+   */ 
+  size_t size() const {
+    return entries_.size();
   }
 
-  // long/short
-  // if long is left/left or right/right: we rotate in the opp direction about the root
-  // if long is left/right or right/left: we rotate the direct long child first, and then rotate the root (opp direction for each)
-
-  // handles left/right single rotations.
-  std::shared_ptr<Node<U, V>> RotateRight(std::shared_ptr<Node<U, V>> root) {
-    std::shared_ptr<Node<U, V>> left, right;
-    left = root->left;
-    root->left = left->right;
-    left->right = root;
-
-    root->height = GetHeight(root->right) + 1;
-    left->height = std::max(GetHeight(root), GetHeight(left->left)) + 1;
-
-    left->right = TryRotate(left->right);
-    left = TryRotate(left);
-
-    // fix height
-    return left;
+ private:
+  static bool ByKey(const std::pair<U, V>& a, const std::pair<U, V>& b) {
+    return a.first < b.first;
   }
 
-  std::shared_ptr<Node<U, V>> RotateLeft(std::shared_ptr<Node<U, V>> root) {
-    std::shared_ptr<Node<U, V>> left, right;
-    right = root->right;
-    root->right = right->left;
-    right->left = root;
-
-    root->height = GetHeight(root->left) + 1;
-    right->height = std::max(GetHeight(root), GetHeight(right->right)) + 1;
-    
-    right->left = TryRotate(right->left);
-    right = TryRotate(right);
+  // sorts pending entries and writes them out in eytzinger order.
+  void Layout() {
+    if (!sorted_) {
+      // stable, so that the latest of several equal keys wins -- as it always has
+      std::stable_sort(entries_.begin(), entries_.end(), ByKey);
+      sorted_ = true;
+    }
 
-    // fix height
-    return right;
+    // slot 0 is unused, so that children of k are 2k and 2k + 1
+    keys_.resize(entries_.size() + 1);
+    vals_.resize(entries_.size() + 1);
+    size_t next = 0;
+    Fill(1, next);
+    dirty_ = false;
   }
 
-  int32_t GetHeight(std::shared_ptr<Node<U, V>> root) {
-    if (root == nullptr) {
-      return -1;
+  // in-order walk of the implicit tree rooted at k, handing out sorted entries as we go
+  void Fill(size_t k, size_t& next) {
+    if (k > entries_.size()) {
+      return;
     }
 
-    return root->height;
+    Fill(2 * k, next);
+    keys_[k] = entries_[next].first;
+    vals_[k] = entries_[next].second;
+    next++;
+    Fill(2 * k + 1, next);
   }
 
-  std::shared_ptr<Node<U, V>> root_;
+  // entries in insertion (or sorted) order
+  std::vector<std::pair<U, V>> entries_;
+  // 1-indexed eytzinger layout of entries_
+  std::vector<U> keys_;
+  std::vector<V> vals_;
+  bool sorted_;
+  bool dirty_;
 };
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
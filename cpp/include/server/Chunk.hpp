@@ -2,14 +2,19 @@
 #define CHUNK_H_
 
 #include <chrono>
-#include <unordered_map>
-#include <unordered_set>
+#include <memory>
+#include <vector>
 
+#include <server/MemoryStats.hpp>
 #include <server/ServerPacket.hpp>
+#include <FlatHashMap.hpp>
 
 namespace vasteroids {
 namespace server {
 
+class BinaryWriter;
+class BinaryReader;
+
 /**
  *  A chunk represents a "block" of space which contains several instances.
  */ 
@@ -35,8 +40,50 @@ class Chunk {
    */ 
   void GetContents(ServerPacket& resid);
 
+  /**
+   *  Appends copies of this chunk's asteroids to `resid`.
+   */ 
+  void GetAsteroids(std::vector<Asteroid>& resid);
+
+  /**
+   *  Appends pointers to this chunk's asteroids to `resid`. Valid until the chunk is next modified.
+   */ 
+  void GetAsteroids(std::vector<Asteroid*>& resid);
+
+  /**
+   *  Appends copies of this chunk's projectiles to `resid`.
+   */ 
+  void GetProjectiles(std::vector<Projectile>& resid);
+
   Projectile* GetProjectile(uint64_t);
 
+  /**
+   *  @returns the number of asteroids in this chunk.
+   */ 
+  size_t GetAsteroidCount() const;
+
+  /**
+   *  @returns true if this chunk holds no instances -- it may still have deletions left to report.
+   */ 
+  bool IsEmpty() const;
+
+  /**
+   *  Adds up the instances held by this chunk, and the memory they take up.
+   *  @param out - output param. Every field but `chunk` is overwritten.
+   */ 
+  void GetMemoryUsage(ChunkMemory& out) const;
+
+  /**
+   *  Drops this chunk's projectiles, collisions and pending deletions, and gives back the storage of every table left empty.
+   *  Meant for chunks no ship can see -- nothing would move or expire these until a ship returns.
+   */ 
+  void ReleaseTransients();
+
+  /**
+   *  @returns a pointer to a locally stored asteroid, if one exists.
+   */ 
+  Asteroid* GetAsteroid(uint64_t id);
+
   /**
    *  @returns a copy of a locally stored ship, if one exists.
    */ 
@@ -52,6 +99,13 @@ class Chunk {
    */ 
   void InsertAsteroid(Asteroid& a);
 
+  /**
+   *  Moves a batch of asteroids into this chunk, reserving space for them up front.
+   *  @param begin - the first asteroid being inserted.
+   *  @param end - one past the last asteroid being inserted.
+   */ 
+  void InsertAsteroids(std::vector<Asteroid>::iterator begin, std::vector<Asteroid>::iterator end);
+
   /**
    *  Inserts or updates a projectile in this chunk.
    */ 
@@ -81,25 +135,50 @@ class Chunk {
    */ 
   float GetActivity();
 
+  /**
+   *  Appends the contents of this chunk to a snapshot.
+   *  @param out - the snapshot being written.
+   */ 
+  void Serialize(BinaryWriter& out) const;
+
+  /**
+   *  Replaces the contents of this chunk with those written by Serialize.
+   *  @param in - the snapshot being read.
+   *  @returns false if the snapshot was cut short or corrupt.
+   */ 
+  bool Deserialize(BinaryReader& in);
+
+  /**
+   *  @returns the contents of this chunk as written by Serialize.
+   *  Encoded once and kept until the chunk next changes -- the bytes themselves never change, so they can be shared.
+   */ 
+  std::shared_ptr<const std::vector<uint8_t>> Encode() const;
+
  private:
   // updates the position of an instance, handling wrap around
   bool UpdateInstance(Instance* inst, double cur);
 
-  std::unordered_map<uint64_t, Ship> ships_;
-  std::unordered_map<uint64_t, Asteroid> asteroids_;
-  std::unordered_map<uint64_t, Projectile> projectiles_;
-  std::unordered_map<uint64_t, Collision> collisions_;
+  // drops the kept encoding -- called by anything which can change the chunk, including handing out pointers into it
+  void ForgetEncoding();
+
+  FlatHashMap<uint64_t, Ship> ships_;
+  FlatHashMap<uint64_t, Asteroid> asteroids_;
+  FlatHashMap<uint64_t, Projectile> projectiles_;
+  FlatHashMap<uint64_t, Collision> collisions_;
 
   // list of all items deleted since last update
-  std::unordered_set<uint64_t> deleted_cur_;
+  FlatHashSet<uint64_t> deleted_cur_;
 
   // list of all items deleted in the last update
-  std::unordered_set<uint64_t> deleted_last_;
+  FlatHashSet<uint64_t> deleted_last_;
 
   double last_server_time_;
   // set to true when we want to update
   bool hard_update_;
 
+  // what Encode last returned -- null once the chunk has changed
+  mutable std::shared_ptr<const std::vector<uint8_t>> encoded_;
+
   // when getting contents: chunks will append the set of all IDs deleted in the last update
   
 
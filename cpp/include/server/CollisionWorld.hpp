@@ -3,9 +3,10 @@
 
 #include <Asteroid.hpp>
 #include <Projectile.hpp>
+#include <Ship.hpp>
+#include <FlatHashMap.hpp>
 
-#include <unordered_map>
-#include <unordered_set>
+#include <cinttypes>
 #include <vector>
 
 namespace vasteroids {
@@ -13,52 +14,136 @@ namespace server {
 
 /**
  *  The CollisionWorld ingests simulated components and computes collisions.
+ *
+ *  Asteroids and ships are stored in a loose grid: each one lives in the single cell containing its center,
+ *  and lookups widen their search by the largest radius seen.
+ *  Cells are stored in two levels -- a flat table over all chunks pointing into flat blocks of cells,
+ *  allocated only for chunks which projectiles or ships pass through.
  */ 
 class CollisionWorld {
  public:
   /**
    *  @param chunk_dims - number of chunks per dimension in game world
+   *  @param cell_size - approximate width of a grid cell, in world units. Rounded so that cells tile a chunk.
+   *                     Keep this at least twice the largest asteroid radius, so lookups touch at most 2x2 cells.
    */ 
-  CollisionWorld(int chunk_dims);
+  CollisionWorld(int chunk_dims, float cell_size = 4.0f);
 
   /**
    *  Adds an asteroid to this collisionworld.
+   *  Asteroids are only indexed in cells which some projectile or ship passes through,
+   *  so those should be added first.
    *  @param a - a pointer to an asteroid.
    */ 
   void AddAsteroid(const Asteroid& a);
 
   /**
-   *  Adds a projectile to this collisionworld.
+   *  Adds a projectile to this collisionworld, marking the cells its path covers this tick.
    *  @param p - a pointer to a projectile.
    */ 
   void AddProjectile(const Projectile& p);
 
+  /**
+   *  Adds a ship to this collisionworld, marking the cells it covers.
+   *  Ships are tested against asteroids, and against projectiles fired by other ships.
+   *  @param s - the ship being added.
+   */ 
+  void AddShip(const Ship& s);
+
+  /**
+   *  @param chunk - the chunk being tested.
+   *  @returns true if asteroids in this chunk could be hit by a projectile or ship this tick.
+   */ 
+  bool IsChunkRelevant(Point2D<int> chunk) const;
+
   /**
    *  Handles collisions in game, destroying asteroids which are hit.
    *  @param deleted_insts - an output parameter for the IDs which are deleted -- id -> chunk
    *  @param new_asteroids - if a destroyed asteroid can spawn two more, this maps from its position to its radius.
+   *  @param destroyed_ships - an output parameter for the IDs of ships which were hit.
    *  @returns mapping from ships to their locally destroyed projectiles.
    */ 
-  std::unordered_map<uint64_t, std::unordered_set<uint32_t>> ComputeCollisions(std::unordered_map<uint64_t, Point2D<int>>& deleted_insts, std::vector<std::pair<WorldPosition, float>>& deleted_asteroids);
+  FlatHashMap<uint64_t, FlatHashSet<uint32_t>> ComputeCollisions(FlatHashMap<uint64_t, Point2D<int>>& deleted_insts, std::vector<std::pair<WorldPosition, float>>& deleted_asteroids, std::vector<uint64_t>& destroyed_ships);
  
   /**
    *  Resets the contents of this collisionworld :sade:
    */ 
   void clear();
+
+  /**
+   *  @returns the width of a single grid cell, in world units.
+   */ 
+  float GetCellSize() const;
+
+  /**
+   *  @returns the heap memory held by this collisionworld, in bytes -- including what it keeps between ticks.
+   */ 
+  size_t GetAllocatedBytes() const;
  private:
-  void GetAsteroidBoundingBox(const Asteroid& a, Point2D<int>* min, Point2D<int>* max);
-  float GetAsteroidRadius(const Asteroid& a);
-  void AddToCollisionChunk(const Asteroid& a, Point2D<int> chunk);
+  // a single asteroid or ship stored in a cell -- cells form singly linked lists through `entries_`.
+  struct CellEntry {
+    uint32_t index;
+    int32_t next;
+  };
+
+  float GetRadius(const std::vector<Point2D<float>>& geometry);
   Point2D<float> GetDistance(const WorldPosition& a, const WorldPosition& b);
 
-  // places asteroids into chunks
-  std::unordered_map<Point2D<int>, std::unordered_set<uint64_t>> asteroid_chunks_;
-  // id -> asteroid
-  std::unordered_map<uint64_t, Asteroid> asteroids_;
+  // returns the (wrapped) grid cell containing a world coordinate
+  Point2D<int> GetCellCoord(double x, double y) const;
+
+  // returns the index of a cell in the per-cell arrays, or -1 if its chunk has no block.
+  // if `create` is set, a block is allocated for the cell's chunk instead.
+  int32_t GetCellIndex(Point2D<int> cell, bool create);
+
+  // marks a cell as something asteroids could collide with in this tick.
+  void MarkCell(Point2D<int> cell);
+
+  // adds a new entry to the front of a cell's list
+  void PushEntry(std::vector<int32_t>& heads, int32_t cell, uint32_t index);
+
+  // calls `fn` with the index of every allocated cell overlapping a circle.
+  // stops early once `fn` returns true.
+  template <typename F>
+  bool ForEachCell(const WorldPosition& center, float radius, F fn);
+
+  // steps a projectile along its path since its last collision test, calling `step` with each position it passes through.
+  // stops early once `step` returns true.
+  template <typename F>
+  void TraceProjectile(Projectile& proj, F step);
+
+  // chunk (x * chunk_count + y) -> index of its block of cells, or -1 if unallocated
+  std::vector<int32_t> chunk_blocks_;
+  // chunks which have a block allocated, so that clear only touches those
+  std::vector<int32_t> used_chunks_;
+  // per cell: first asteroid entry in the cell's list, or -1
+  std::vector<int32_t> cell_heads_;
+  // per cell: first ship entry in the cell's list, or -1
+  std::vector<int32_t> ship_heads_;
+  // per cell: nonzero if a projectile or ship passes through
+  std::vector<uint8_t> cell_marks_;
+  int32_t block_count_;
+
+  std::vector<CellEntry> entries_;
+
+  // chunk (x * chunk_count + y) -> nonzero if an asteroid inside could overlap a marked cell
+  std::vector<uint8_t> chunk_relevant_;
+  std::vector<int32_t> relevant_chunks_;
+
+  std::vector<Asteroid> asteroids_;
+  // largest radius of any stored asteroid, used to widen lookups
+  float max_radius_;
+
+  std::vector<Ship> ships_;
+  float ship_radius_;
+
   // id -> projectile
-  std::unordered_map<uint64_t, Projectile> projectiles_;
+  FlatHashMap<uint64_t, Projectile> projectiles_;
 
   const int chunk_count_;
+  // cells along a single chunk edge
+  const int cells_per_chunk_;
+  const float cell_size_;
 };
 
 }
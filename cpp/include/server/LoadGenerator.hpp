@@ -0,0 +1,81 @@
+#ifndef LOAD_GENERATOR_H_
+#define LOAD_GENERATOR_H_
+
+#include <RandomStream.hpp>
+#include <Ship.hpp>
+#include <client/ClientPacket.hpp>
+#include <server/ServerPacket.hpp>
+#include <server/World.hpp>
+
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  Plays a number of bot clients against a world, in-process.
+ *  Bots join through AddShip, and send a ClientPacket every tick -- steering about, and firing now and then --
+ *  so the world does the same work it would for as many real players.
+ */
+class LoadGenerator {
+ public:
+  /**
+   *  @param world - the world our bots play in. Must outlive the generator.
+   *  @param seed - seeds the bots' steering. The same seed steers them the same way.
+   */
+  LoadGenerator(World& world, uint64_t seed);
+
+  /**
+   *  Adds or removes bots until there are `count` of them. The newest bots leave first.
+   */
+  void SetBotCount(int count);
+
+  /**
+   *  Removes the `count` longest-serving bots, and adds as many new ones -- churns the crowd without changing its size.
+   */
+  void ReplaceBots(int count);
+
+  int GetBotCount() const;
+
+  /**
+   *  Moves every bot along, and sends its update to the world. Call once per tick, before UpdateSim.
+   *  @param tick_length - time since the last tick, in seconds.
+   */
+  void SendInputs(double tick_length);
+
+  /**
+   *  Reads the world's replies to our bots, respawning those which were destroyed.
+   *  Bots out of lives rejoin as a new ship.
+   *  @param packets - the packets built by the last UpdateSim.
+   *  @returns the number of bytes those packets come to on the wire.
+   */
+  size_t HandlePackets(const FlatHashMap<uint64_t, ServerPacket>& packets);
+
+ private:
+  struct Bot {
+    // the bot's own view of its ship
+    Ship ship;
+    RandomStream rng;
+    // shots left in the current burst
+    int burst;
+    uint32_t next_projectile;
+  };
+
+  // adds a bot to the world
+  void AddBot();
+
+  // steers a bot, and fills in its update
+  void StepBot(Bot& bot, double tick_length, client::ClientPacket& packet);
+
+  World& world_;
+  uint64_t seed_;
+  std::vector<Bot> bots_;
+
+  // bots ever added -- names and streams are handed out in order
+  uint64_t bots_added_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef MEMORY_STATS_H_
+#define MEMORY_STATS_H_
+
+#include <FlatHashMap.hpp>
+#include <GameTypes.hpp>
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  The number of entities in some structure, and the heap memory it holds.
+ *  Bytes are estimated from capacities -- allocator overhead isn't counted, so they track growth rather than RSS.
+ */
+struct MemoryUsage {
+  size_t count = 0;
+  size_t bytes = 0;
+
+  MemoryUsage& operator+=(const MemoryUsage& other) {
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+  }
+};
+
+/**
+ *  Memory held by a single chunk.
+ */
+struct ChunkMemory {
+  Point2D<int> chunk = Point2D<int>(0, 0);
+  MemoryUsage asteroids;
+  MemoryUsage ships;
+  MemoryUsage projectiles;
+  MemoryUsage collisions;
+  // IDs deleted in the last two updates, kept until clients have heard about them
+  MemoryUsage deleted;
+  // the chunk's contents as last encoded for a snapshot, kept until it changes
+  MemoryUsage encoded;
+
+  size_t GetTotalBytes() const {
+    return asteroids.bytes + ships.bytes + projectiles.bytes + collisions.bytes + deleted.bytes + encoded.bytes;
+  }
+};
+
+/**
+ *  Memory held by a world, by entity type and by subsystem.
+ */
+struct MemoryStats {
+  // summed over every chunk
+  MemoryUsage asteroids;
+  MemoryUsage ships;
+  MemoryUsage projectiles;
+  MemoryUsage collisions;
+  MemoryUsage deleted;
+  // `count` is the number of chunks holding an encoding
+  MemoryUsage encoded;
+
+  // the chunk map itself -- `count` is the number of chunks
+  MemoryUsage chunks;
+  // chunks holding nothing, kept while a ship is close enough to see them
+  size_t empty_chunks = 0;
+
+  // chunks whose contents have been generated -- kept for as long as the world lives
+  MemoryUsage materialized;
+
+  // what each client has been sent, and its projectiles awaiting confirmation -- `count` is the number of ships with an entry
+  MemoryUsage known_ids;
+  MemoryUsage new_projectiles;
+
+  // per-ship bookkeeping: where each ship is, and what it has cost
+  MemoryUsage ship_index;
+
+  // scratch space reused from tick to tick -- nothing is counted
+  MemoryUsage collision_world;
+  // `count` is the number of asteroids tracked
+  MemoryUsage sweep_and_prune;
+  // `count` is the number of chunks mapped
+  MemoryUsage biome_manager;
+
+  // the chunks holding the most memory, largest first
+  std::vector<ChunkMemory> largest_chunks;
+
+  size_t GetTotalBytes() const {
+    return asteroids.bytes + ships.bytes + projectiles.bytes + collisions.bytes + deleted.bytes + encoded.bytes + chunks.bytes
+         + materialized.bytes + known_ids.bytes + new_projectiles.bytes + ship_index.bytes
+         + collision_world.bytes + sweep_and_prune.bytes + biome_manager.bytes;
+  }
+};
+
+template <typename T>
+size_t GetHeapBytes(const std::vector<T>& vec) {
+  return vec.capacity() * sizeof(T);
+}
+
+// slots and control bytes -- not what the entries point to
+template <typename Value, typename Key, typename KeyOf, typename Hash>
+size_t GetHeapBytes(const FlatHashTable<Value, Key, KeyOf, Hash>& table) {
+  return table.bucket_count() * (sizeof(Value) + 1);
+}
+
+// short strings live inside the string itself
+inline size_t GetHeapBytes(const std::string& str) {
+  const char* self = reinterpret_cast<const char*>(&str);
+  bool inline_storage = (str.data() >= self && str.data() < self + sizeof(std::string));
+  return (inline_storage ? 0 : str.capacity() + 1);
+}
+
+}
+}
+
+#endif
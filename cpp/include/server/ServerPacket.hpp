@@ -6,8 +6,8 @@
 #include <Projectile.hpp>
 #include <Collision.hpp>
 #include <GameTypes.hpp>
+#include <FlatHashMap.hpp>
 
-#include <unordered_set>
 #include <vector>
 
 namespace vasteroids {
@@ -31,10 +31,10 @@ struct ServerPacket {
   // deltas which do not require complete information
   std::vector<Instance> deltas;
 
-  std::unordered_set<uint64_t> deleted;
+  FlatHashSet<uint64_t> deleted;
 
   // entities local to the client which were deleted
-  std::unordered_set<uint64_t> deleted_local;
+  FlatHashSet<uint64_t> deleted_local;
 
   // time since server creation
   double server_time;
@@ -42,15 +42,18 @@ struct ServerPacket {
   // score
   int64_t score;
 
+  // whether the client's ship has been destroyed by the server
+  bool destroyed;
+
   /**
    *  Concatenates another server packet onto this one.
    */ 
   void ConcatPacket(const ServerPacket& packet);
 
   /**
-   *  Converts a ServerPacket to a Node object.
+   *  @returns the size of this packet once encoded for the wire -- matches ServerPacketDecoder.
    */ 
-  Napi::Object ToNodeObject(Napi::Env env);
+  size_t GetEncodedSize() const;
 };
 }
 }
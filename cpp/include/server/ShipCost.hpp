@@ -0,0 +1,47 @@
+#ifndef SHIP_COST_H_
+#define SHIP_COST_H_
+
+#include <Biome.hpp>
+#include <GameTypes.hpp>
+
+#include <cinttypes>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  What a single ship has cost the server, accumulated since it joined.
+ */
+struct ShipCost {
+  uint64_t id = 0;
+
+  // where the ship was as of the last tick
+  Point2D<int> chunk = Point2D<int>(0, 0);
+  Biome biome = Biome::INVALID;
+
+  // ticks the ship has been updated in
+  uint64_t ticks = 0;
+
+  // seconds spent building the ship's updates -- in total, and during the last tick
+  double fanout_time = 0.0;
+  double last_fanout_time = 0.0;
+
+  // seconds spent applying the ship's own packets
+  double input_time = 0.0;
+
+  // instances read from the chunks around the ship, before trimming down to what it needs
+  uint64_t scanned = 0;
+
+  // updates sent for instances the ship already knew of
+  uint64_t deltas = 0;
+
+  // encoded size of the ship's updates
+  uint64_t bytes = 0;
+
+  uint64_t projectiles = 0;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SWEEP_AND_PRUNE_H_
+#define SWEEP_AND_PRUNE_H_
+
+#include <Asteroid.hpp>
+#include <FlatHashMap.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  A pair of asteroids whose bounds overlap.
+ */ 
+struct AsteroidPair {
+  uint64_t id_a;
+  Point2D<int> chunk_a;
+  uint64_t id_b;
+  Point2D<int> chunk_b;
+};
+
+/**
+ *  Incremental sweep-and-prune broadphase for asteroid/asteroid collisions.
+ *  Bounds are kept sorted along x between ticks -- since asteroids move little per tick,
+ *  re-sorting is close to linear.
+ */ 
+class SweepAndPrune {
+ public:
+  /**
+   *  @param chunk_dims - number of chunks per dimension in game world
+   */ 
+  SweepAndPrune(int chunk_dims);
+
+  /**
+   *  Starts a new tick. Asteroids which are not updated before the next call to FindPairs are dropped.
+   */ 
+  void BeginTick();
+
+  /**
+   *  Inserts an asteroid, or updates its bounds if it is already tracked.
+   *  @param a - the asteroid being tracked.
+   */ 
+  void Update(const Asteroid& a);
+
+  /**
+   *  Finds all pairs of tracked asteroids whose bounds overlap.
+   *  @param pairs - output param for overlapping pairs.
+   */ 
+  void FindPairs(std::vector<AsteroidPair>& pairs);
+
+  /**
+   *  @returns the number of asteroids currently tracked.
+   */ 
+  size_t size() const;
+
+  /**
+   *  @returns the heap memory held by this broadphase, in bytes.
+   */ 
+  size_t GetAllocatedBytes() const;
+
+ private:
+  struct Record {
+    uint64_t id;
+    Point2D<int> chunk;
+    // bounds along x -- min_x lies within [0, world size), max_x may lie past the world's edge.
+    double min_x;
+    double max_x;
+    double y;
+    float radius;
+    uint32_t stamp;
+  };
+
+  // removes records which were not updated this tick, and restores sorted order.
+  void Prune();
+
+  // returns true if the y bounds of two records overlap.
+  bool OverlapY(const Record& a, const Record& b) const;
+
+  // stable storage for records -- freed slots are reused.
+  std::vector<Record> records_;
+  std::vector<uint32_t> free_;
+
+  // id -> index in records_
+  FlatHashMap<uint64_t, uint32_t> slots_;
+
+  // record indices, sorted by min_x
+  std::vector<uint32_t> order_;
+
+  // records added this tick, merged into order_ on the next FindPairs
+  std::vector<uint32_t> added_;
+
+  uint32_t stamp_;
+  const int chunk_count_;
+};
+
+}
+}
+
+#endif
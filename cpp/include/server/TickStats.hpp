@@ -0,0 +1,91 @@
+#ifndef TICK_STATS_H_
+#define TICK_STATS_H_
+
+#include <server/TickTimings.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  Histogram over the last `window` samples of some duration.
+ *  Samples fall into log-spaced buckets -- eight per power of two, so percentiles are good to within ~9%.
+ *  Recording is constant time and allocates nothing, so it can stay on in production.
+ */
+class RollingHistogram {
+ public:
+  /**
+   *  @param window - the number of samples the histogram covers.
+   */
+  RollingHistogram(size_t window);
+
+  /**
+   *  Adds a sample, evicting the oldest if the window is full.
+   *  @param seconds - the sample, in seconds.
+   */
+  void Record(double seconds);
+
+  // number of samples in the window
+  size_t GetCount() const;
+
+  double GetMean() const;
+
+  /**
+   *  @param p - the percentile, in [0, 1].
+   *  @returns the upper bound of the bucket holding that percentile, or 0 if there are no samples.
+   */
+  double GetPercentile(double p) const;
+
+  // exact, unlike the percentiles
+  double GetMax() const;
+
+ private:
+  static int GetBucket(double seconds);
+  static double GetBucketBound(int bucket);
+
+  // the window itself -- needed to evict samples, and for the max
+  std::vector<double> samples_;
+  size_t next_;
+  size_t count_;
+
+  std::vector<uint32_t> buckets_;
+  double sum_;
+};
+
+/**
+ *  Rolling statistics for each phase of the tick, and for the tick as a whole.
+ */
+class TickStats {
+ public:
+  /**
+   *  @param window - the number of ticks covered. 1024 is about half a minute at 30 ticks per second.
+   */
+  TickStats(size_t window = 1024);
+
+  /**
+   *  Records a finished tick.
+   */
+  void Record(const TickTimings& timings, const TickCounts& counts);
+
+  const RollingHistogram& GetPhase(TickPhase phase) const;
+  const RollingHistogram& GetTotal() const;
+
+  // counts from the last tick recorded
+  const TickCounts& GetLastCounts() const;
+
+  // ticks recorded since creation
+  uint64_t GetTickCount() const;
+
+ private:
+  std::vector<RollingHistogram> phases_;
+  RollingHistogram total_;
+  TickCounts last_counts_;
+  uint64_t ticks_;
+};
+
+}
+}
+
+#endif
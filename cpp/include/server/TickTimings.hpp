@@ -0,0 +1,104 @@
+#ifndef TICK_TIMINGS_H_
+#define TICK_TIMINGS_H_
+
+#include <server/TraceRecorder.hpp>
+
+#include <chrono>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  The phases of a tick, in the order they run.
+ */
+enum class TickPhase : int {
+  // copying the world's state, for slow tick capture -- only on the first tick of each window
+  CAPTURE = 0,
+  // generating chunks which ships have wandered into
+  MATERIALIZE,
+  // moving everything along
+  UPDATE_CHUNKS,
+  // moving instances which left their chunk
+  REINSERT,
+  // bouncing asteroids off each other
+  ASTEROID_COLLISIONS,
+  // feeding projectiles, ships and nearby asteroids to the collision world
+  COLLISION_BUILD,
+  // projectiles and ships against asteroids, and cleaning up after the hits
+  COMPUTE_COLLISIONS,
+  // topping the world back up with asteroids
+  RESPAWN,
+  // letting go of what chunks no ship can see are holding
+  RELEASE_CHUNKS,
+  // building each client's update
+  PACKETS,
+  // converting the updates to JS objects -- only timed by WorldSim
+  TO_NODE,
+  COUNT
+};
+
+constexpr int tick_phase_count = static_cast<int>(TickPhase::COUNT);
+
+/**
+ *  @returns a short name for a tick phase.
+ */
+const char* TickPhaseToString(TickPhase phase);
+
+/**
+ *  Wall time spent on each phase of a single tick, in seconds.
+ */
+struct TickTimings {
+  double phases[tick_phase_count] = {};
+  double total = 0.0;
+};
+
+/**
+ *  The size of the world during a single tick.
+ */
+struct TickCounts {
+  // chunks holding anything
+  int chunks = 0;
+  // chunks near a ship, which were simulated
+  int active_chunks = 0;
+  int asteroids = 0;
+  int ships = 0;
+  // projectiles in the active chunks
+  int projectiles = 0;
+  // updates built for clients
+  int packets = 0;
+};
+
+/**
+ *  Times consecutive phases of a tick -- each call to `Next` closes the phase before it.
+ *  Each phase is also recorded as a span, if a trace is running.
+ */
+class TickTimer {
+ public:
+  TickTimer(TickTimings& out, TraceRecorder* trace = nullptr)
+    : out_(out), trace_(trace), start_(std::chrono::steady_clock::now()), last_(start_) {
+    out_ = TickTimings();
+  }
+
+  // records the time since the last phase ended against `phase`
+  void Next(TickPhase phase) {
+    auto now = std::chrono::steady_clock::now();
+    out_.phases[static_cast<int>(phase)] += std::chrono::duration<double>(now - last_).count();
+    out_.total = std::chrono::duration<double>(now - start_).count();
+    if (trace_ != nullptr) {
+      trace_->Record(TickPhaseToString(phase), last_, now);
+    }
+
+    last_ = now;
+  }
+
+ private:
+  TickTimings& out_;
+  TraceRecorder* trace_;
+  std::chrono::time_point<std::chrono::steady_clock> start_;
+  std::chrono::time_point<std::chrono::steady_clock> last_;
+};
+
+}
+}
+
+#endif
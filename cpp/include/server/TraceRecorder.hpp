@@ -0,0 +1,150 @@
+#ifndef TRACE_RECORDER_H_
+#define TRACE_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+using TraceClock = std::chrono::steady_clock;
+
+/**
+ *  A single finished span. Names must be string literals -- they're stored as pointers, and written out unescaped.
+ */
+struct TraceEvent {
+  const char* name;
+  TraceClock::time_point start;
+  TraceClock::time_point end;
+  // up to two integer args -- unused ones are null
+  const char* arg_names[2];
+  int64_t args[2];
+};
+
+/**
+ *  Writes spans as Chrome trace-event JSON, for chrome://tracing or ui.perfetto.dev.
+ *  Each thread records into a ring of its own, which a background thread drains to disk --
+ *  recording takes no locks and never touches the file system. If a ring fills up faster than it is drained,
+ *  new events are dropped rather than waited on.
+ */
+class TraceRecorder {
+ public:
+  /**
+   *  Starts a new trace.
+   *  @param path - the file to write. Replaced if it exists.
+   *  @param error - output param, receiving a description of what went wrong.
+   *  @param buffer_events - the number of events each thread can hold before they are written out. Rounded up to a power of two.
+   *  @returns the new recorder, or null if the file could not be opened.
+   */
+  static std::shared_ptr<TraceRecorder> Open(const std::string& path, std::string& error, size_t buffer_events = 16384);
+
+  // writes out everything still buffered, and closes the file.
+  ~TraceRecorder();
+
+  /**
+   *  Records a finished span on the calling thread.
+   *  @param name - the name of the span.
+   *  @param start - when the span started.
+   *  @param end - when it ended.
+   *  @param arg0, arg1 - names of optional integer args. Null if unused.
+   *  @param val0, val1 - their values.
+   */
+  void Record(const char* name, TraceClock::time_point start, TraceClock::time_point end,
+              const char* arg0 = nullptr, int64_t val0 = 0, const char* arg1 = nullptr, int64_t val1 = 0);
+
+  // labels the calling thread in the trace. the name is copied.
+  void NameThread(const std::string& name);
+
+  // events lost to full buffers
+  uint64_t GetDroppedCount() const;
+
+  TraceRecorder(const TraceRecorder& other) = delete;
+  TraceRecorder& operator=(const TraceRecorder& other) = delete;
+ private:
+  // one per recording thread. only that thread writes events, and only the flusher reads them.
+  struct ThreadBuffer {
+    std::thread::id owner;
+    uint32_t tid;
+    std::string name;
+    std::vector<TraceEvent> events;
+    // total events written / read -- index into `events` modulo its size
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+  };
+
+  TraceRecorder(FILE* file, size_t buffer_events);
+
+  // finds or creates the calling thread's buffer. only locks the first time a thread records.
+  ThreadBuffer* GetThreadBuffer();
+
+  // writes every buffered event to disk. only called from the flusher, or once it has stopped.
+  void Drain();
+
+  void WriteEvent(uint32_t tid, const TraceEvent& event);
+
+  // the flusher's loop
+  void FlushLoop();
+
+  FILE* file_;
+  size_t buffer_mask_;
+  TraceClock::time_point epoch_;
+
+  // distinguishes recorders in each thread's cached buffer lookup, even if one is allocated where another was
+  uint64_t id_;
+
+  std::mutex buffers_lock_;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+
+  std::atomic<uint64_t> dropped_;
+
+  // true once an event has been written -- everything after it needs a comma
+  bool wrote_event_;
+
+  std::mutex flush_lock_;
+  std::condition_variable flush_cv_;
+  bool stopping_;
+  std::thread flusher_;
+};
+
+/**
+ *  Records a span covering its own lifetime. Does nothing if the recorder is null, so it can stay in hot code.
+ */
+class TraceSpan {
+ public:
+  TraceSpan(TraceRecorder* trace, const char* name, const char* arg0 = nullptr, int64_t val0 = 0, const char* arg1 = nullptr, int64_t val1 = 0)
+    : trace_(trace), name_(name), arg0_(arg0), val0_(val0), arg1_(arg1), val1_(val1) {
+    if (trace_ != nullptr) {
+      start_ = TraceClock::now();
+    }
+  }
+
+  ~TraceSpan() {
+    if (trace_ != nullptr) {
+      trace_->Record(name_, start_, TraceClock::now(), arg0_, val0_, arg1_, val1_);
+    }
+  }
+
+  TraceSpan(const TraceSpan& other) = delete;
+  TraceSpan& operator=(const TraceSpan& other) = delete;
+ private:
+  TraceRecorder* trace_;
+  const char* name_;
+  const char* arg0_;
+  int64_t val0_;
+  const char* arg1_;
+  int64_t val1_;
+  TraceClock::time_point start_;
+};
+
+}
+}
+
+#endif
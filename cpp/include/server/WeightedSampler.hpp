@@ -0,0 +1,74 @@
+#ifndef WEIGHTED_SAMPLER_H_
+#define WEIGHTED_SAMPLER_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  Picks indices at random, in proportion to a weight stored for each.
+ *  Weights live in a Fenwick tree, so both updating a weight and drawing a sample are O(log n),
+ *  and neither allocates.
+ */ 
+class WeightedSampler {
+ public:
+  /**
+   *  Creates a new sampler, with every weight set to zero.
+   *  @param count - the number of indices we can sample from.
+   */ 
+  WeightedSampler(size_t count);
+
+  /**
+   *  Replaces every weight at once, in O(n).
+   *  @param weights - the new weights. Must contain `size()` entries.
+   */ 
+  void Build(const std::vector<double>& weights);
+
+  /**
+   *  @param index - the index being updated.
+   *  @param weight - its new weight. Must be non-negative.
+   */ 
+  void SetWeight(size_t index, double weight);
+
+  /**
+   *  @returns the weight currently stored for `index`.
+   */ 
+  double GetWeight(size_t index) const;
+
+  /**
+   *  @returns the sum of all weights.
+   */ 
+  double GetTotal() const;
+
+  /**
+   *  Maps a uniform random number onto an index.
+   *  @param u - a number in [0, 1).
+   *  @returns the index whose slice of the cumulative weights contains `u * GetTotal()`.
+   */ 
+  size_t Sample(double u) const;
+
+  size_t size() const;
+
+  /**
+   *  @returns the heap memory held by this sampler, in bytes.
+   */ 
+  size_t GetAllocatedBytes() const;
+
+ private:
+  // recomputes the tree from `weights_`, discarding rounding error from many small updates
+  void Rebuild();
+
+  std::vector<double> weights_;
+  // 1-indexed: tree_[i] holds the sum of weights in (i - (i & -i), i]
+  std::vector<double> tree_;
+  // largest power of two <= size, where the descent in Sample starts
+  size_t top_bit_;
+  size_t updates_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,533 @@
+#ifndef WORLD_H_
+#define WORLD_H_
+
+#include <Clock.hpp>
+#include <GameTypes.hpp>
+#include <Projectile.hpp>
+#include <RandomStream.hpp>
+#include <client/ClientPacket.hpp>
+#include <server/BiomeManager.hpp>
+#include <server/Chunk.hpp>
+#include <server/CollisionWorld.hpp>
+#include <server/MemoryStats.hpp>
+#include <server/ServerPacket.hpp>
+#include <server/ShipCost.hpp>
+#include <server/SweepAndPrune.hpp>
+#include <server/TickTimings.hpp>
+#include <server/TraceRecorder.hpp>
+#include <server/WorldSnapshot.hpp>
+
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  Optional settings for a new World.
+ */
+struct WorldOptions {
+  // if false, the seed is picked at random
+  bool has_seed = false;
+  uint64_t seed = 0;
+
+  // if true, every chunk is generated up front rather than when it is first visited
+  bool eager = false;
+
+  // directory holding our snapshot and tick logs. if it holds a snapshot, the world is restored from it.
+  std::string persist_path;
+
+  // file to record every input to, from creation on
+  std::string record_path;
+
+  // recording to rebuild the world from -- overrides the world's size and settings
+  std::string replay_path;
+
+  // source of server time. the system clock if null.
+  std::shared_ptr<Clock> clock;
+
+  // file to write a trace of the world's internals to, from creation on -- see StartTrace
+  std::string trace_path;
+
+  // ticks taking longer than this, in seconds, are captured to `slow_tick_dir`. 0 disables capture.
+  double slow_tick_threshold = 0.0;
+  std::string slow_tick_dir;
+
+  // ticks between copies of the world's state. a capture holds the last copy and every input since.
+  int slow_tick_window = 300;
+
+  // capture to rebuild the world from -- the world is left just before the slow tick, with the clock set to it
+  std::string slow_tick_replay_path;
+};
+
+/**
+ *  A tick which was captured for running over the slow tick threshold.
+ */
+struct SlowTickInfo {
+  // ticks the world had run before this one
+  uint64_t tick = 0;
+  // the threshold it went over, in seconds
+  double threshold = 0.0;
+  TickTimings timings;
+  TickCounts counts;
+};
+
+/**
+ *  The simulation itself: every chunk, ship and asteroid in the world, and the rules which move them along.
+ *  Knows nothing of Node -- WorldSim exposes it to JS.
+ */
+class World {
+ public:
+  /**
+   *  Creates a new world -- generated, restored from a snapshot, or rebuilt from a recording, depending on `options`.
+   *  @param chunk_dims - the x/y size of the world, in # of chunks.
+   *  @param asteroids - the number of asteroids the world should hold.
+   *  @param options - optional settings.
+   *  @param error - output param, receiving a description of what went wrong if the world could not be created.
+   *  @returns the new world, or null on failure.
+   */
+  static std::unique_ptr<World> Create(int chunk_dims, int asteroids, const WorldOptions& options, std::string& error);
+
+  /**
+   *  Adds a new ship to the world.
+   *  @param name - the name associated with the new ship.
+   *  @returns the new ship. Valid until the world next changes.
+   */
+  Ship* AddShip(const std::string& name);
+
+  /**
+   *  Applies an update from a client.
+   *  @param packet - the client's update. Modified in place.
+   *  @returns false if the client's ship doesn't exist.
+   */
+  bool HandleClientPacket(client::ClientPacket& packet);
+
+  /**
+   *  Removes a ship from the world.
+   *  @returns false if the ship doesn't exist.
+   */
+  bool DeleteShip(uint64_t id);
+
+  /**
+   *  Respawns a destroyed ship. Ships which haven't been destroyed are left alone.
+   *  @returns the ship, or nullptr if the ship doesn't exist or is out of lives.
+   */
+  Ship* RespawnShip(uint64_t id);
+
+  /**
+   *  Steps the world forward to the current server time. Should be done once per server tick.
+   *  @param packets - output param, receiving an update for each ship. If null, no updates are built.
+   */
+  void UpdateSim(FlatHashMap<uint64_t, ServerPacket>* packets);
+
+  /**
+   *  Starts writing a snapshot of the world, if it is being persisted.
+   *  Chunks are encoded when they change, and shared as they are until then -- the snapshot is joined up and written to
+   *  disk on a background thread.
+   *  @param error - output param, receiving a description of what went wrong if the snapshot failed.
+   *  @returns true if a snapshot was started. false if the world isn't persisted, or the last snapshot is still being
+   *           written -- or, with `error` set, if there was nowhere to log the inputs which follow it.
+   */
+  bool SaveSnapshot(std::string& error);
+
+  // true if a ship with this ID exists
+  bool HasShip(uint64_t id) const;
+
+  int GetChunkDims() const;
+
+  // the seed this world was generated from
+  uint64_t GetSeed() const;
+
+  // reads the clock -- not necessarily the time of the last call
+  double GetServerTime();
+
+  /**
+   *  Fetches the biomes of a region of the world.
+   *  @param origin - top left chunk of the region. Accounts for wrap.
+   *  @param dims - size of the region, in chunks.
+   *  @param out - output param, receiving (dims.x * dims.y) biomes, indexed (x * dims.y + y).
+   */
+  void GetBiomeRegion(Point2D<int> origin, Point2D<int> dims, uint8_t* out) const;
+
+  // number of biome tiles along x/y
+  int GetBiomeTileDims() const;
+
+  /**
+   *  Encodes a fixed-size tile of the biome map, in the same layout as BiomePacketDecoder.
+   *  @param tile - x and y index of the tile, in tiles.
+   *  @param out - output param, receiving the encoded tile.
+   */
+  void EncodeBiomeTile(Point2D<int> tile, std::vector<uint8_t>& out) const;
+
+  void PrintBiomeMap(std::ostream& out) const;
+
+  /**
+   *  Starts tracing the world's internals -- each tick and its phases, chunk updates, packets and background work --
+   *  as Chrome trace-event JSON. Replaces any trace already running.
+   *  @param path - the file to write the trace to. Replaced if it exists.
+   *  @param error - output param, receiving a description of what went wrong.
+   *  @returns false if the trace file could not be opened.
+   */
+  bool StartTrace(const std::string& path, std::string& error);
+
+  /**
+   *  Stops tracing, and finishes writing the trace file. Background work still in flight may finish it later.
+   *  @returns false if no trace was running.
+   */
+  bool StopTrace();
+
+  // the running trace, or null -- for recording work done on the world's behalf
+  TraceRecorder* GetTrace() const;
+
+  /**
+   *  @returns the time spent on each phase of the last tick.
+   */
+  const TickTimings& GetLastTickTimings() const;
+
+  /**
+   *  @returns the number of chunks, instances and packets in the last tick.
+   */
+  const TickCounts& GetLastTickCounts() const;
+
+  /**
+   *  Finds the ships which have cost the most to serve, by the time spent building their updates.
+   *  @param count - the most ships to return.
+   *  @param out - output param, receiving the costliest ships, costliest first.
+   */
+  void GetCostliestShips(size_t count, std::vector<ShipCost>& out) const;
+
+  /**
+   *  Adds up what the world is holding in memory, by entity type and by subsystem.
+   *  @param out - output param, overwritten with this world's memory usage.
+   *  @param top_chunks - the number of chunks to list in `out.largest_chunks`.
+   */
+  void GetMemoryStats(MemoryStats& out, size_t top_chunks) const;
+
+  /**
+   *  @returns the tick a world rebuilt from a slow tick capture is waiting to run, as it was timed when captured.
+   */
+  const SlowTickInfo& GetReplayedSlowTick() const;
+
+  World(const World& other) = delete;
+  World& operator=(const World& other) = delete;
+ private:
+  World(int chunk_dims, std::shared_ptr<Clock> clock);
+
+  // types of entries in the tick log
+  enum class LogEntryType : uint8_t {
+    ADD_SHIP = 1,
+    CLIENT_PACKET = 2,
+    DELETE_SHIP = 3,
+    RESPAWN_SHIP = 4,
+    UPDATE_SIM = 5
+  };
+
+  // the entry points above sample the clock and log their input, then pass it along to these.
+  // replay calls them directly.
+
+  Ship* AddShip_(const std::string& name);
+  bool HandleClientPacket_(client::ClientPacket& packet);
+  bool DeleteShip_(uint64_t id);
+  Ship* RespawnShip_(uint64_t id);
+  void UpdateSim_(FlatHashMap<uint64_t, ServerPacket>* packets);
+
+  /**
+   *  Starts a new entry in the tick log, stamped with the current server time.
+   *  @param type - the type of entry.
+   *  @returns a writer holding the entry's header. Append the payload, then pass it to LogInput.
+   */
+  BinaryWriter StartLogEntry(LogEntryType type);
+
+  // re-applies a single entry from the tick log, or from a recording.
+  void ApplyLogEntry(const uint8_t* data, size_t len);
+
+  // true if inputs are being written anywhere
+  bool IsLogging() const;
+
+  // writes an input to the tick log and the recording, whichever are open.
+  void LogInput(BinaryWriter& entry);
+
+  /**
+   *  Starts recording every input to this world, from its creation on.
+   *  @param path - the file to record to. Replaced if it exists.
+   *  @param asteroids - the asteroid count this world was created with.
+   *  @param eager - whether this world was bootstrapped eagerly.
+   */
+  void StartRecording(const std::string& path, int asteroids, bool eager);
+
+  // true if slow ticks are being captured
+  bool IsCapturing() const;
+
+  // copies the state each capture in the coming window starts from -- called as the window's first tick starts
+  void StartCaptureWindow();
+
+  // writes the current window, and the last tick's timings, to the capture directory in the background
+  void CaptureSlowTick();
+
+  /**
+   *  Rebuilds the world from a slow tick capture, and feeds it every captured input up to the slow tick.
+   *  @param path - the capture to replay.
+   *  @param error - output param, receiving a description of what went wrong.
+   *  @returns false if the capture could not be read.
+   */
+  bool ReplaySlowTick(const std::string& path, std::string& error);
+
+  // encodes what each client has been sent -- left out of snapshots, as restored worlds start without clients
+  void EncodeClientState(BinaryWriter& out);
+  bool RestoreClientState(BinaryReader& in);
+
+  /**
+   *  Rebuilds the world a recording started from, and feeds it every recorded input as fast as it can.
+   *  Time is taken from the recording rather than the clock.
+   *  @param path - the recording to replay.
+   *  @param error - output param, receiving a description of what went wrong.
+   *  @returns false if the recording could not be read.
+   */
+  bool ReplayRecording(const std::string& path, std::string& error);
+
+  // sets our dims, and everything sized by them
+  void SetUpWorld(int chunk_dims);
+
+  /**
+   *  Generates a new world from `seed_`.
+   *  @param asteroids - the number of asteroids the world should hold.
+   *  @param eager - if true, every chunk is generated immediately.
+   */
+  void GenerateWorld(int asteroids, bool eager);
+
+  // encodes the entire world -- chunks are shared, rather than copied
+  void EncodeSnapshot(SegmentedWriter& out);
+
+  /**
+   *  Replaces the world with the contents of a snapshot.
+   *  @param in - the snapshot being read.
+   *  @returns false if the snapshot is corrupt, or doesn't match this world.
+   */
+  bool RestoreSnapshot(BinaryReader& in);
+
+  /**
+   *  Restores the world from our snapshot and tick logs, if there are any.
+   *  @param error - output param, receiving a description of what went wrong.
+   *  @returns true if there was a world to restore. Check `error` if not.
+   */
+  bool RestoreWorld(std::string& error);
+
+  // writes a fresh snapshot synchronously, and starts logging the generation after it.
+  void StartPersistence();
+
+  std::string GetSnapshotPath() const;
+  std::string GetLogPath(uint64_t generation) const;
+
+  /**
+   *  @returns a set of all chunks which need to be updated.
+   */
+  FlatHashSet<Point2D<int>> GetActiveChunks();
+
+  /**
+   *  Reinserts elements which fell outside of their respective chunk.
+   *  @param collate - serverpacket containing all instances which need to be moved.
+   *  @param update_chunks - the chunks being simulated. Projectiles leaving them are dropped, rather than left frozen.
+   */
+  void ReinsertInstances(ServerPacket& collate, const FlatHashSet<Point2D<int>>& update_chunks);
+
+  // picks the chunk a ship (re)spawns in -- near the middle of the world
+  Point2D<int> GetSpawnChunk();
+
+  /**
+   *  Sets the spawn coordinates for a new ship.
+   *  @param s - reference to our new ship.
+   */
+  void SpawnShip(Ship& s);
+
+  /**
+   *  Corrects the position of a particular instance if its position/chunk are inconsistent with dims.
+   *  @param inst - the inst being corrected.
+   */
+  void CorrectChunk(Instance& inst);
+
+  /**
+   *  Bounces apart asteroids which overlap in the given chunks.
+   *  @param update_chunks - the chunks being simulated this tick.
+   */
+  void CollideAsteroids(const FlatHashSet<Point2D<int>>& update_chunks);
+
+  /**
+   *  Marks a ship as destroyed, and leaves an explosion where it was.
+   *  @param ship - the ship being destroyed.
+   *  @param chunk - the chunk which contains this ship.
+   */
+  void DestroyShip(Ship& ship, Point2D<int> chunk);
+
+  // handles a single projectile (from a clientPacket)
+  void HandleNewProjectile(uint64_t ship_id, Projectile& proj);
+
+  // creates and populates a chunk.
+  void CreateChunk(Point2D<int> chunk_coord);
+
+  /**
+   *  Lets go of what chunks no ship is near enough to see are holding.
+   *  Their projectiles, collisions and pending deletions are dropped -- nothing would expire them, and no one is around to see them.
+   *  Chunks left empty are freed, and recreated as soon as something enters them.
+   *  @param candidates - the chunks being checked.
+   */
+  void ReleaseUnwatchedChunks(const FlatHashSet<Point2D<int>>& candidates);
+
+  // releases unwatched chunks around a ship which has just left, or moved elsewhere
+  void ReleaseChunksAround(Point2D<int> center);
+
+  // returns true if some ship is within a chunk of `chunk`, and reads its contents
+  bool IsChunkWatched(Point2D<int> chunk) const;
+
+  /**
+   *  Fills a chunk with its initial asteroids, the first time it is touched.
+   *  Contents are drawn from the chunk's own stream, so they don't depend on when or in what order chunks are visited.
+   *  @param chunk_coord - the chunk being materialized.
+   */
+  void MaterializeChunk(Point2D<int> chunk_coord);
+
+  /**
+   *  Materializes every chunk in the world at once. Produces the same world as materializing them one by one.
+   *  Asteroids are counted and generated in parallel, then inserted in bulk.
+   */
+  void BootstrapWorld();
+
+  // the number of asteroids a chunk starts with
+  int GetInitialAsteroidCount(Point2D<int> chunk_coord) const;
+
+  /**
+   *  Generates a chunk's initial asteroids. Touches no shared state, so it is safe to call from any thread.
+   *  @param chunk_coord - the chunk being generated.
+   *  @param first_id - ID of the first asteroid. The rest follow consecutively.
+   *  @param time - server time at which the asteroids are created.
+   *  @param out - output param, holding space for `count` asteroids.
+   *  @param count - the number of asteroids to generate -- from GetInitialAsteroidCount.
+   */
+  void GenerateChunkContents(Point2D<int> chunk_coord, uint64_t first_id, double time, Asteroid* out, int count) const;
+
+  // generates a new asteroid at some worldposition and adds it to the world.
+  void SpawnNewAsteroid(WorldPosition coord);
+
+  // generates a new asteroid with a prespecified number of points and radius and adds it to the world.
+  void SpawnNewAsteroid(WorldPosition coord, float radius, int points);
+
+  // builds an asteroid, drawing its shape and motion from rng. does not add it to the world.
+  Asteroid MakeAsteroid(WorldPosition coord, float radius, int points, uint64_t id, double time, RandomStream& rng) const;
+
+  // gets dist between two points
+  Point2D<float> GetDistance(WorldPosition a, WorldPosition b);
+
+  // corrects for chunk overflow
+  void FixChunkBoundaries(Point2D<int>& chunk);
+
+  // server time for the current call
+  double GetServerTime_();
+
+  // x/y dims of our world
+  int chunk_dims_;
+
+  // number of asteroids in the world
+  int asteroid_count_;
+  int asteroid_min_;
+
+  // asteroids expected in chunks which have yet to be materialized
+  double unmaterialized_share_;
+
+  // chunks whose initial contents have been generated
+  FlatHashSet<Point2D<int>> materialized_;
+
+  // true once the world has been bootstrapped -- every chunk counts as materialized
+  bool all_materialized_;
+
+  std::shared_ptr<CollisionWorld> cw_;
+
+  // asteroid/asteroid broadphase -- persists between ticks
+  std::shared_ptr<SweepAndPrune> sweep_;
+
+  // key: chunk coordinate -> chunk and all elements inside it
+  FlatHashMap<Point2D<int>, Chunk> chunks_;
+
+  // key: ship ID -> last known coordinates of that ship
+  FlatHashMap<uint64_t, Point2D<int>> ships_;
+
+  // key: ship ID -> last known ver for each instance
+  FlatHashMap<uint64_t, FlatHashMap<uint64_t, uint32_t>> known_ids_;
+
+  // key: ship ID -> newly generated projectiles which we need to report on
+  FlatHashMap<uint64_t, FlatHashSet<uint64_t>> new_projectiles_;
+
+  // key: ship ID -> what that ship has cost us so far
+  FlatHashMap<uint64_t, ShipCost> ship_costs_;
+
+  // the world seed -- every random number in the sim derives from it
+  uint64_t seed_;
+
+  // stream for world events: ship spawns and the like
+  RandomStream rng_;
+
+  std::shared_ptr<BiomeManager> mgr;
+
+  // number of biome tiles along x/y
+  int biome_tile_dims_;
+
+  std::uniform_real_distribution<float> coord_gen;
+  std::uniform_real_distribution<float> velo_gen;
+
+  // source of server time
+  std::shared_ptr<Clock> clock_;
+
+  // server time for the call being handled -- sampled once, so that the call sees a single instant
+  double now_;
+
+  // receives spans from the tick and the threads it spawns, while a trace is running
+  std::shared_ptr<TraceRecorder> trace_;
+
+  // how long each phase of the last tick took
+  TickTimings last_tick_;
+  TickCounts last_counts_;
+
+  // directory holding our snapshot and tick logs -- empty if the world isn't persisted
+  std::string persist_path_;
+
+  // generation of the latest snapshot. the log for this generation holds every input since.
+  uint64_t generation_;
+
+  TickLog log_;
+  SnapshotWriter snapshot_writer_;
+
+  // every input since the world was created, if it is being recorded
+  TickLog recording_;
+
+  // slow tick capture -- see WorldOptions
+  double slow_tick_threshold_;
+  std::string slow_tick_dir_;
+  int slow_tick_window_;
+
+  // ticks run since the world was created
+  uint64_t tick_count_;
+
+  // the world as of the start of the capture window, and every input since, framed as in a tick log
+  SegmentedWriter window_state_;
+  std::vector<uint8_t> window_inputs_;
+
+  // true if the next tick starts a capture window, and should copy the world's state first
+  bool window_pending_;
+
+  // true once a tick in this window has been captured -- the one capture covers the rest
+  bool window_captured_;
+  SnapshotWriter capture_writer_;
+
+  // set while replaying a capture: ticks build (and drop) their packets, so that what each client knows stays true
+  bool replay_packets_;
+  SlowTickInfo replayed_slow_tick_;
+
+  // keep it dumb :)
+  uint64_t id_max_;
+};
+
+}
+}
+
+#endif
@@ -1,25 +1,23 @@
 #ifndef WORLD_SIM_H_
 #define WORLD_SIM_H_
 
-#include <GameTypes.hpp>
-#include <server/Chunk.hpp>
-#include <server/CollisionWorld.hpp>
-#include <Projectile.hpp>
-
-#include <server/BiomeManager.hpp>
+#include <Clock.hpp>
+#include <server/TickStats.hpp>
+#include <server/World.hpp>
 
 #include <napi.h>
 
 #include <memory>
-#include <random>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace vasteroids {
 namespace server {
 
 // todo: handling out of bounds case?
 
+/**
+ *  Exposes a World to JS. Converts arguments and results, and leaves the simulating to the world.
+ */
 class WorldSim : public Napi::ObjectWrap<WorldSim> {
 
  public:
@@ -37,92 +35,82 @@ class WorldSim : public Napi::ObjectWrap<WorldSim> {
   Napi::Value AddShip(const Napi::CallbackInfo& info);
   Napi::Value DeleteShip(const Napi::CallbackInfo& info);
   Napi::Value GetServerTime(const Napi::CallbackInfo& info);
-  Napi::Value GetLocalBiomeInfo(const Napi::CallbackInfo& info);
-  // Napi::Value GetLocalChunkActivity(const Napi::CallbackInfo& info);
- private:
 
   /**
-   *  @returns a set of all chunks which need to be updated.
+   *  Moves a virtual clock forward. Only available to worlds created with `virtualClock`.
+   *  @param info - the number of seconds to advance by.
+   *  @returns the new server time.
    */ 
-  std::unordered_set<Point2D<int>> GetActiveChunks();
+  Napi::Value AdvanceClock(const Napi::CallbackInfo& info);
 
   /**
-   *  Reinserts elements which fell outside of their respective chunk.
-   *  @param collate - serverpacket containing all instances which need to be moved.
+   *  @returns the seed this world was generated from.
    */ 
-  void ReinsertInstances(ServerPacket& collate);
+  Napi::Value GetSeed(const Napi::CallbackInfo& info);
+  Napi::Value GetLocalBiomeInfo(const Napi::CallbackInfo& info);
 
   /**
-   *  Sets the spawn coordinates for a new ship.
-   *  @param s - reference to our new ship.
+   *  Fetches a fixed-size tile of the biome map, pre-encoded as a biome packet.
+   *  The biome map never changes, so each tile is encoded once and the same ArrayBuffer is handed out thereafter.
+   *  @param info - x and y index of the tile, in tiles. Accounts for wrap.
+   *  @returns an ArrayBuffer containing the encoded tile.
    */ 
-  void SpawnShip(Ship& s);
+  Napi::Value GetBiomeTile(const Napi::CallbackInfo& info);
 
   /**
-   *  Corrects the position of a particular instance if its position/chunk are inconsistent with dims.
-   *  @param inst - the inst being corrected.
+   *  Starts writing a snapshot of the world, if it is being persisted.
+   *  The world is encoded immediately, and written to disk on a background thread.
+   *  @returns true if a snapshot was started -- false if the world isn't persisted, or the last snapshot is still being written.
    */ 
-  void CorrectChunk(Instance& inst);
-
-  // handles a single projectile (from a clientPacket)
-  void HandleNewProjectile(uint64_t ship_id, Projectile& proj);
-
-  // creates and populates a chunk.
-  void CreateChunk(Point2D<int> chunk_coord);
-
-  // generates a new asteroid at some worldposition and adds it to the world.
-  void SpawnNewAsteroid(WorldPosition coord);
-
-  // generates a new asteroid with a prespecified number of points and radius and adds it to the world.
-  void SpawnNewAsteroid(WorldPosition coord, float radius, int points);
-
-  // gets dist between two points
-  Point2D<float> GetDistance(WorldPosition a, WorldPosition b);
-
-  // corrects for chunk overflow
-  void FixChunkBoundaries(Point2D<int>& chunk);
-
-  double GetServerTime_();
-
-  // x/y dims of our world
-  int chunk_dims_;
-
-  // number of asteroids in the world
-  int asteroid_count_;
-  int asteroid_min_;
-
-  std::shared_ptr<CollisionWorld> cw_;
+  Napi::Value SaveSnapshot(const Napi::CallbackInfo& info);
 
-  // key: chunk coordinate -> chunk and all elements inside it
-  std::unordered_map<Point2D<int>, Chunk> chunks_;
-
-  // key: ship ID -> last known coordinates of that ship
-  std::unordered_map<uint64_t, Point2D<int>> ships_;
-
-  // key: ship ID -> last known ver for each instance
-  std::unordered_map<uint64_t, std::unordered_map<uint64_t, uint32_t>> known_ids_;
-
-  // key: ship ID -> newly generated projectiles which we need to report on
-  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> new_projectiles_;
+  /**
+   *  Summarizes how long recent ticks took, phase by phase, and how big the world was during the last.
+   *  Covers the last 1024 calls to UpdateSim, including the time spent converting its result to JS.
+   *  @returns an object holding the mean, p50, p99 and max of each phase, in milliseconds.
+   */ 
+  Napi::Value GetTickStats(const Napi::CallbackInfo& info);
 
-  std::mt19937 gen;
+  /**
+   *  Finds the ships which have cost the most to serve since they joined, by the time spent building their updates.
+   *  @param info - the most ships to return. Defaults to 10.
+   *  @returns an array of per-ship costs, costliest first.
+   */ 
+  Napi::Value GetCostliestShips(const Napi::CallbackInfo& info);
 
-  std::shared_ptr<BiomeManager> mgr;
+  /**
+   *  Reports what the world is holding in memory, by entity type and by subsystem.
+   *  @param info - the number of largest chunks to list. Defaults to 10.
+   *  @returns the world's memory usage, as counts and estimated bytes.
+   */ 
+  Napi::Value GetMemoryStats(const Napi::CallbackInfo& info);
 
-  std::normal_distribution<> chunk_gen;
-  std::uniform_real_distribution<float> coord_gen;
-  std::uniform_real_distribution<float> velo_gen;
+  /**
+   *  Starts tracing ticks as Chrome trace-event JSON, replacing any trace already running. Throws if the file can't be opened.
+   *  @param info - the file to write the trace to.
+   */ 
+  Napi::Value StartTrace(const Napi::CallbackInfo& info);
 
-  // the time point at which the server was created
-  std::chrono::time_point<std::chrono::high_resolution_clock> origin_time_;
+  /**
+   *  Stops tracing, and finishes writing the trace file.
+   *  @returns false if no trace was running.
+   */ 
+  Napi::Value StopTrace(const Napi::CallbackInfo& info);
+  // Napi::Value GetLocalChunkActivity(const Napi::CallbackInfo& info);
+ private:
+  std::unique_ptr<World> world_;
 
-  // keep it dumb :)
-  uint64_t id_max_;
+  // same as the world's clock, if it is virtual
+  std::shared_ptr<VirtualClock> virtual_clock_;
 
+  // rolling timings for each tick
+  TickStats stats_;
 
+  // tile (x * biome_tile_dims + y) -> encoded tile, empty until first requested
+  std::vector<Napi::Reference<Napi::ArrayBuffer>> biome_tiles_;
 };
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
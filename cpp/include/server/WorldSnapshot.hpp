@@ -0,0 +1,337 @@
+#ifndef WORLD_SNAPSHOT_H_
+#define WORLD_SNAPSHOT_H_
+
+#include <Asteroid.hpp>
+#include <Collision.hpp>
+#include <Projectile.hpp>
+#include <Ship.hpp>
+#include <server/TraceRecorder.hpp>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vasteroids {
+namespace server {
+
+/**
+ *  Appends plain values to a growing byte buffer.
+ *  Values are written in native byte order -- snapshots are meant to be restored on the machine which wrote them.
+ */
+class BinaryWriter {
+ public:
+  template <typename T>
+  void Put(const T& val) {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written directly");
+    size_t offset = data_.size();
+    data_.resize(offset + sizeof(T));
+    std::memcpy(&data_[offset], &val, sizeof(T));
+  }
+
+  void PutBytes(const void* data, size_t len);
+  void PutString(const std::string& str);
+
+  std::vector<uint8_t>& Data() {
+    return data_;
+  }
+
+  const std::vector<uint8_t>& Data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return data_.size();
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+// bytes which no one may change, so that any thread can read them
+typedef std::shared_ptr<const std::vector<uint8_t>> SharedBytes;
+
+/**
+ *  Like BinaryWriter, but can splice in shared, already-encoded pieces rather than copying them.
+ *  Lets an encoding reuse whatever hasn't changed since the last one, and defer joining it all up to another thread.
+ */
+class SegmentedWriter {
+ public:
+  SegmentedWriter() : size_(0) {}
+
+  template <typename T>
+  void Put(const T& val) {
+    own_.Put(val);
+    size_ += sizeof(T);
+  }
+
+  void PutBytes(const void* data, size_t len);
+
+  // splices in a shared piece -- held onto, not copied
+  void PutShared(SharedBytes piece);
+
+  // appends everything written to `other`, sharing its pieces
+  void Append(const SegmentedWriter& other);
+
+  /**
+   *  Visits the encoding in order, as a series of byte ranges.
+   *  @param fn - called with (const uint8_t* data, size_t len) for each range.
+   */
+  template <typename F>
+  void ForEachRange(F fn) const {
+    const uint8_t* own = own_.Data().data();
+    size_t offset = 0;
+    for (auto& piece : pieces_) {
+      if (piece.own_end > offset) {
+        fn(own + offset, piece.own_end - offset);
+      }
+
+      if (!piece.bytes->empty()) {
+        fn(piece.bytes->data(), piece.bytes->size());
+      }
+
+      offset = piece.own_end;
+    }
+
+    if (own_.size() > offset) {
+      fn(own + offset, own_.size() - offset);
+    }
+  }
+
+  // the encoding in one buffer
+  std::vector<uint8_t> Join() const;
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  // each piece follows our own bytes up to `own_end`
+  struct Piece {
+    size_t own_end;
+    SharedBytes bytes;
+  };
+
+  // bytes written directly
+  BinaryWriter own_;
+  std::vector<Piece> pieces_;
+  size_t size_;
+};
+
+/**
+ *  Reads plain values back out of a byte range.
+ *  Reading past the end fails softly: the reader is marked as failed, and returns zeroes from then on.
+ */
+class BinaryReader {
+ public:
+  BinaryReader(const uint8_t* data, size_t len) : data_(data), len_(len), offset_(0), failed_(false) {}
+
+  template <typename T>
+  T Get() {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read directly");
+    T res{};
+    GetBytes(&res, sizeof(T));
+    return res;
+  }
+
+  bool GetBytes(void* out, size_t len);
+  std::string GetString();
+
+  // skips `len` bytes, returning a pointer to them -- or nullptr if there are not enough left
+  const uint8_t* Skip(size_t len);
+
+  size_t Remaining() const {
+    return (failed_ ? 0 : len_ - offset_);
+  }
+
+  bool ok() const {
+    return !failed_;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t len_;
+  size_t offset_;
+  bool failed_;
+};
+
+void Write(BinaryWriter& out, const WorldPosition& pos);
+void Write(BinaryWriter& out, const Instance& inst);
+void Write(BinaryWriter& out, const Asteroid& asteroid);
+void Write(BinaryWriter& out, const Ship& ship);
+void Write(BinaryWriter& out, const Projectile& proj);
+void Write(BinaryWriter& out, const Collision& collision);
+
+bool Read(BinaryReader& in, WorldPosition& pos);
+bool Read(BinaryReader& in, Instance& inst);
+bool Read(BinaryReader& in, Asteroid& asteroid);
+bool Read(BinaryReader& in, Ship& ship);
+bool Read(BinaryReader& in, Projectile& proj);
+bool Read(BinaryReader& in, Collision& collision);
+
+/**
+ *  A file mapped read-only into memory, for as long as this object lives.
+ */
+class MappedFile {
+ public:
+  /**
+   *  Maps the file at `path`. Check `ok()` before reading.
+   */
+  MappedFile(const std::string& path);
+  ~MappedFile();
+
+  const uint8_t* Data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // false if the file could not be opened
+  bool ok() const {
+    return ok_;
+  }
+
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  bool ok_;
+  bool mapped_;
+  // fallback storage, where mmap is not available
+  std::vector<uint8_t> buffer_;
+};
+
+/**
+ *  Append-only log of the inputs applied to a WorldSim since its last snapshot.
+ *  Each entry is framed with its length and a checksum, so a torn write at the end of the log is simply dropped on replay.
+ */
+class TickLog {
+ public:
+  TickLog();
+  ~TickLog();
+
+  // takes over `other`'s file, closing our own
+  TickLog(TickLog&& other);
+  TickLog& operator=(TickLog&& other);
+
+  /**
+   *  Starts appending to the log at `path`, creating it if necessary.
+   *  @returns true if the log could be opened.
+   */
+  bool Open(const std::string& path);
+
+  /**
+   *  Starts a new log at `path`, replacing any file already there.
+   *  @returns true if the log could be created.
+   */
+  bool Create(const std::string& path);
+
+  void Close();
+
+  bool IsOpen() const {
+    return file_ != nullptr;
+  }
+
+  /**
+   *  Buffers one entry. Entries reach the OS once Flush is called.
+   *  @param entry - the contents of the entry.
+   */
+  void Append(const std::vector<uint8_t>& entry);
+
+  // hands buffered entries to the OS. does not wait for the disk.
+  void Flush();
+
+  /**
+   *  Frames one entry onto the end of an in-memory log, laid out just as in a file.
+   *  @param out - the log being appended to.
+   *  @param entry - the contents of the entry.
+   */
+  static void AppendTo(std::vector<uint8_t>& out, const std::vector<uint8_t>& entry);
+
+  /**
+   *  Reads back every intact entry in a log.
+   *  @param data - the log's contents.
+   *  @param len - the length of the log, in bytes.
+   *  @param fn - called with each entry, in order.
+   *  @returns the number of entries read.
+   */
+  template <typename F>
+  static size_t ForEachEntry(const uint8_t* data, size_t len, F fn) {
+    BinaryReader in(data, len);
+    size_t count = 0;
+    while (in.Remaining() >= 8) {
+      uint32_t size = in.Get<uint32_t>();
+      uint32_t checksum = in.Get<uint32_t>();
+      const uint8_t* entry = in.Skip(size);
+      if (entry == nullptr || Checksum(entry, size) != checksum) {
+        // the tail of the log was never fully written
+        break;
+      }
+
+      fn(entry, size);
+      count++;
+    }
+
+    return count;
+  }
+
+  static uint32_t Checksum(const uint8_t* data, size_t len);
+
+  TickLog(const TickLog& other) = delete;
+  TickLog& operator=(const TickLog& other) = delete;
+ private:
+  FILE* file_;
+};
+
+/**
+ *  Writes snapshots to disk on a background thread, so that the tick never waits on the file system.
+ */
+class SnapshotWriter {
+ public:
+  SnapshotWriter();
+  ~SnapshotWriter();
+
+  /**
+   *  Starts writing a snapshot, replacing the file at `path` once it is safely on disk.
+   *  @param path - the snapshot file.
+   *  @param data - the encoded snapshot. Its shared pieces are read on the writer's thread.
+   *  @param obsolete - files to remove once the snapshot is in place.
+   *  @param trace - if not null, the write is recorded to this trace.
+   *  @returns false if the previous snapshot is still being written -- in which case nothing happens.
+   */
+  bool Write(const std::string& path, SegmentedWriter data, std::vector<std::string> obsolete,
+             std::shared_ptr<TraceRecorder> trace = nullptr);
+
+  /**
+   *  @returns true while a snapshot is being written.
+   */
+  bool IsBusy() const;
+
+  // blocks until the current write (if any) is done.
+  void Wait();
+
+  /**
+   *  Writes a file and swaps it into place, on the calling thread.
+   *  @returns true if the file was written successfully.
+   */
+  static bool WriteFile(const std::string& path, const SegmentedWriter& data);
+
+  SnapshotWriter(const SnapshotWriter& other) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter& other) = delete;
+ private:
+  std::thread worker_;
+  std::atomic<bool> busy_;
+};
+
+}
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include <AsteroidCollider.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -7,7 +8,7 @@
 
 namespace vasteroids {
 
-static bool Collide(const Asteroid& asteroid, const Point2D<float>& point, int chunk_dims);
+static bool Collide(const std::vector<Point2D<float>>& geometry, const Point2D<float>& point);
 
 bool Collide(const Asteroid& asteroid, const WorldPosition& point, int chunk_dims) {
   // perform a test to see if the point and the asteroid are in neighboring chunks
@@ -41,16 +42,16 @@ bool Collide(const Asteroid& asteroid, const WorldPosition& point, int chunk_dim
   float rot_sin = sin(-asteroid.rotation);
   point_rel = { (point_rel.x * rot_cos) + (point_rel.y * rot_sin),
                 (point_rel.x * -rot_sin) + (point_rel.y * rot_cos) };
-  return Collide(asteroid, point_rel, chunk_dims);
+  return Collide(asteroid.geometry, point_rel);
 }
 
-static bool Collide(const Asteroid& asteroid, const Point2D<float>& pt, int chunk_dims) {
+static bool Collide(const std::vector<Point2D<float>>& geometry, const Point2D<float>& pt) {
   float wind_distance = 0.0f;
   float theta_last, delta_theta;
-  Point2D<float> delta = asteroid.geometry[asteroid.geometry.size() - 1] - pt;
+  Point2D<float> delta = geometry[geometry.size() - 1] - pt;
   theta_last = atan2(delta.y, delta.x);
-  for (size_t i = 0; i < asteroid.geometry.size(); i++) {
-    delta = asteroid.geometry[i] - pt;
+  for (size_t i = 0; i < geometry.size(); i++) {
+    delta = geometry[i] - pt;
     delta_theta = atan2(delta.y, delta.x) - theta_last;
     if (delta_theta > PI) {
       delta_theta = delta_theta - (2 * PI);
@@ -99,7 +100,7 @@ bool Collide(const Asteroid& asteroid, const WorldPosition& line_start, const Wo
 
   Point2D<float> lineDelta = (lineEndPos - lineStartPos) * (1.0f / steps);
   for (int i = 0; i <= steps; i++) {
-    if (Collide(asteroid, lineStartPos, chunk_dims)) {
+    if (Collide(asteroid.geometry, lineStartPos)) {
       return true;
     }
 
@@ -109,35 +110,153 @@ bool Collide(const Asteroid& asteroid, const WorldPosition& line_start, const Wo
   return false;
 }
 
-#ifdef COLLIDER_TEST
+// returns the displacement from `a` to `b`, taking the shortest path around the world.
+static Point2D<float> GetWrappedOffset(const WorldPosition& a, const WorldPosition& b, int chunk_dims) {
+  Point2D<float> res = b.position - a.position;
+  res.x += (b.chunk.x - a.chunk.x) * chunk_size;
+  res.y += (b.chunk.y - a.chunk.y) * chunk_size;
+
+  const float world_size = chunk_size * chunk_dims;
+  if (res.x > world_size / 2) {
+    res.x -= world_size;
+  } else if (res.x < -world_size / 2) {
+    res.x += world_size;
+  }
+
+  if (res.y > world_size / 2) {
+    res.y -= world_size;
+  } else if (res.y < -world_size / 2) {
+    res.y += world_size;
+  }
+
+  return res;
+}
+
+// returns true if segments (p0, p1) and (q0, q1) cross.
+static bool SegmentsIntersect(const Point2D<float>& p0, const Point2D<float>& p1, const Point2D<float>& q0, const Point2D<float>& q1) {
+  Point2D<float> r = p1 - p0;
+  Point2D<float> s = q1 - q0;
+  float denom = r.x * s.y - r.y * s.x;
+  if (denom == 0.0f) {
+    // parallel -- any overlap here will be caught by the containment tests
+    return false;
+  }
+
+  Point2D<float> d = q0 - p0;
+  float t = (d.x * s.y - d.y * s.x) / denom;
+  float u = (d.x * r.y - d.y * r.x) / denom;
+  return (t >= 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f);
+}
+
+// tests two outlines, each placed at some position and rotation, for overlap.
+static bool CollidePolygons(const std::vector<Point2D<float>>& geom_a, const WorldPosition& pos_a, float rot_a,
+                            const std::vector<Point2D<float>>& geom_b, const WorldPosition& pos_b, float rot_b, int chunk_dims) {
+  if (geom_a.empty() || geom_b.empty()) {
+    return false;
+  }
+
+  // position of b's center in a's (unrotated) frame
+  Point2D<float> offset = GetWrappedOffset(pos_a, pos_b, chunk_dims);
+
+  float radius_a = 0.0f, radius_b = 0.0f;
+  for (auto& p : geom_a) {
+    radius_a = std::max(radius_a, p.x * p.x + p.y * p.y);
+  }
+
+  for (auto& p : geom_b) {
+    radius_b = std::max(radius_b, p.x * p.x + p.y * p.y);
+  }
+
+  radius_a = std::sqrt(radius_a);
+  radius_b = std::sqrt(radius_b);
+  if ((offset.x * offset.x + offset.y * offset.y) > (radius_a + radius_b) * (radius_a + radius_b)) {
+    return false;
+  }
 
-static Napi::Value CollideNode(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+  // geometry is stored unrotated -- world = R(-rotation) * local, local = R(rotation) * world.
+  // move b's outline into a's local frame.
+  float b_sin = sin(rot_b), b_cos = cos(rot_b);
+  float a_sin = sin(rot_a), a_cos = cos(rot_a);
+  std::vector<Point2D<float>> b_local;
+  b_local.reserve(geom_b.size());
+  for (auto& p : geom_b) {
+    Point2D<float> world = { p.x * b_cos + p.y * b_sin + offset.x, p.x * -b_sin + p.y * b_cos + offset.y };
+    b_local.push_back({ world.x * a_cos - world.y * a_sin, world.x * a_sin + world.y * a_cos });
+  }
 
-  if (info.Length() < 3) {
-    Napi::TypeError::New(env, "Bad args").ThrowAsJavaScriptException();
-    return env.Null();
+  // edges crossing
+  for (size_t i = 0; i < geom_a.size(); i++) {
+    const Point2D<float>& a0 = geom_a[i];
+    const Point2D<float>& a1 = geom_a[(i + 1) % geom_a.size()];
+    for (size_t j = 0; j < b_local.size(); j++) {
+      if (SegmentsIntersect(a0, a1, b_local[j], b_local[(j + 1) % b_local.size()])) {
+        return true;
+      }
+    }
   }
 
-  Napi::Object asteroid = info[0].As<Napi::Object>();
-  Napi::Object point = info[1].As<Napi::Object>();
-  Napi::Number dims = info[2].As<Napi::Number>();
+  // no edges cross, so either one contains the other or they are apart.
+  // a single vertex from each settles it.
+  if (Collide(geom_a, b_local[0])) {
+    return true;
+  }
 
-  Asteroid a = Asteroid(asteroid);
-  WorldPosition c = WorldPosition(point);
-  int d = dims.Int32Value();
-  Napi::Boolean ret = Napi::Boolean::New(env, Collide(a, c, d));
+  // a's first vertex, in b's local frame
+  const Point2D<float>& v = geom_a[0];
+  Point2D<float> world = { v.x * a_cos + v.y * a_sin - offset.x, v.x * -a_sin + v.y * a_cos - offset.y };
+  return Collide(geom_b, Point2D<float>{ world.x * b_cos - world.y * b_sin, world.x * b_sin + world.y * b_cos });
+}
+
+bool Collide(const Asteroid& a, const Asteroid& b, int chunk_dims) {
+  return CollidePolygons(a.geometry, a.position, a.rotation, b.geometry, b.position, b.rotation, chunk_dims);
+}
 
-  return ret;
+bool Collide(const Asteroid& asteroid, const Ship& ship, int chunk_dims) {
+  return CollidePolygons(asteroid.geometry, asteroid.position, asteroid.rotation, GetShipGeometry(), ship.position, ship.rotation, chunk_dims);
 }
 
-static Napi::Object Init(Napi::Env env, Napi::Object exports) {
-  exports.Set("collide", Napi::Function::New(env, CollideNode));
-  return exports;
+bool Collide(const Ship& ship, const WorldPosition& point, int chunk_dims) {
+  Point2D<float> point_rel = GetWrappedOffset(ship.position, point, chunk_dims);
+  float rot_sin = sin(ship.rotation);
+  float rot_cos = cos(ship.rotation);
+  point_rel = { point_rel.x * rot_cos - point_rel.y * rot_sin,
+                point_rel.x * rot_sin + point_rel.y * rot_cos };
+  return Collide(GetShipGeometry(), point_rel);
 }
 
-NODE_API_MODULE(collidertest, Init);
+bool BounceAsteroids(Asteroid& a, Asteroid& b, int chunk_dims) {
+  Point2D<float> normal = GetWrappedOffset(a.position, b.position, chunk_dims);
+  float len = std::sqrt(normal.x * normal.x + normal.y * normal.y);
+  if (len <= 0.0f) {
+    return false;
+  }
 
-#endif
+  normal *= (1.0f / len);
+  Point2D<float> rel = b.velocity - a.velocity;
+  float approach = rel.x * normal.x + rel.y * normal.y;
+  if (approach >= 0.0f) {
+    // already separating -- leave them be so they don't stick
+    return false;
+  }
+
+  // mass goes with area
+  float mass_a = 0.0f, mass_b = 0.0f;
+  for (auto& p : a.geometry) {
+    mass_a = std::max(mass_a, p.x * p.x + p.y * p.y);
+  }
+
+  for (auto& p : b.geometry) {
+    mass_b = std::max(mass_b, p.x * p.x + p.y * p.y);
+  }
+
+  float impulse = (-2.0f * approach) / ((1.0f / mass_a) + (1.0f / mass_b));
+  a.velocity += normal * (-impulse / mass_a);
+  b.velocity += normal * (impulse / mass_b);
+
+  // new trajectories -- make sure clients receive a delta
+  a.ver++;
+  b.ver++;
+  return true;
+}
 
 }
\ No newline at end of file
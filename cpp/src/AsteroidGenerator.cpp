@@ -1,13 +1,12 @@
 #include <AsteroidGenerator.hpp>
 #include <cinttypes>
-#include <cstdlib>
 #include <cmath>
 
 #define PI 3.1415926535897932384626
 
 namespace vasteroids {
 
-Asteroid GenerateAsteroid(float radius, int32_t points) {
+Asteroid GenerateAsteroid(float radius, int32_t points, RandomStream& rng) {
   Asteroid res;
   Point2D<float> temp;
 
@@ -15,7 +14,7 @@ Asteroid GenerateAsteroid(float radius, int32_t points) {
   for (int32_t i = 0; i < points; i++) {
     theta = i * PI * (2.0 / points);
     // 0.33 - 1.0
-    r = (((rand() % 256) + 128) / 384.0) * radius;
+    r = ((rng.NextInt(0, 255) + 128) / 384.0) * radius;
     temp.x = static_cast<float>(cos(theta) * r);
     temp.y = static_cast<float>(sin(theta) * r);
     res.geometry.push_back(temp);
@@ -29,28 +28,4 @@ Asteroid GenerateAsteroid(float radius, int32_t points) {
   return res;
 }
 
-#ifdef ASTEROIDS_TEST
-static Napi::Value GenerateAsteroidNode(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  if (info.Length() < 2) {
-    Napi::TypeError::New(env, "Wrong arguments").ThrowAsJavaScriptException();
-    return env.Null();
-  }
-
-  float radius = info[0].As<Napi::Number>().FloatValue();
-  int32_t points = info[1].As<Napi::Number>().Int32Value();
-  Asteroid a = GenerateAsteroid(radius, points);
-
-  return a.ToNodeObject(env);
-}
-
-static Napi::Object Init(Napi::Env env, Napi::Object exports) {
-  exports.Set("generateAsteroid", Napi::Function::New(env, GenerateAsteroidNode));
-  return exports;
-}
-
-NODE_API_MODULE(asteroidstest, Init);
-#endif
-
 }
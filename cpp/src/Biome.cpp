@@ -15,8 +15,5 @@ static std::string strings[6] = {
 const std::string& BiomeToString(const Biome& b) {
   return strings[static_cast<int>(b) - 1];
 }
-Napi::String BiomeToString(const Biome& b, const Napi::Env& env) {
-  return Napi::String::New(env, BiomeToString(b));
-}
 
 }
\ No newline at end of file
@@ -2,46 +2,17 @@
 
 namespace vasteroids {
 
-Ship::Ship() : Instance() {}
-
-Ship::Ship(Napi::Object obj) : Instance(obj) {
-  Napi::Env env = obj.Env();
-  Napi::Value nameObj = obj.Get("name");
-  if (!nameObj.IsString()) {
-    TYPEERROR(env, "string field not present on ship");
-  }
-
-  name = nameObj.As<Napi::String>().Utf8Value(); 
-
-  Napi::Value scoreObj = obj.Get("score");
-  if (!scoreObj.IsNumber()) {
-    TYPEERROR(env, "score field not present :(");
-  }
-
-  score = scoreObj.As<Napi::Number>().Int64Value();
-
-  Napi::Value destroyedObj = obj.Get("destroyed");
-  if (!destroyedObj.IsBoolean()) {
-    TYPEERROR(env, "destroyed field not present :(");
-  }
-
-  destroyed = destroyedObj.As<Napi::Boolean>().Value();
-
-  Napi::Value livesObj = obj.Get("lives");
-  if (!livesObj.IsNumber()) {
-    TYPEERROR(env, "lives field not present");
-  }
-
-  lives = livesObj.As<Napi::Number>().Int32Value();
+static const std::vector<Point2D<float>> ship_geometry = {
+  {  0.125f,  0.0f   },
+  { -0.05f,  -0.075f },
+  { -0.04f,   0.0f   },
+  { -0.05f,   0.075f }
+};
+
+const std::vector<Point2D<float>>& GetShipGeometry() {
+  return ship_geometry;
 }
 
-Napi::Object Ship::ToNodeObject(Napi::Env env) const {
-  Napi::Object res = Instance::ToNodeObject(env);
-  res.Set("name", name);
-  res.Set("score", score);
-  res.Set("destroyed", destroyed);
-  res.Set("lives", lives);
-  return res;
-}
+Ship::Ship() : Instance(), spawn_time(0.0) {}
 
 }
\ No newline at end of file
@@ -0,0 +1,418 @@
+#include <node/NodeTypes.hpp>
+
+namespace vasteroids {
+namespace node {
+
+Napi::Object ToNodeObject(Napi::Env env, const WorldPosition& pos) {
+  Napi::Object res = Napi::Object::New(env);
+  res.Set("chunk", ToNodeObject(env, pos.chunk));
+  res.Set("position", ToNodeObject(env, pos.position));
+  return res;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const Instance& inst) {
+  Napi::Object res = Napi::Object::New(env);
+  res.Set("id", Napi::Number::New(env, inst.id));
+  res.Set("position", ToNodeObject(env, inst.position));
+  res.Set("velocity", ToNodeObject(env, inst.velocity));
+  res.Set("rotation", Napi::Number::New(env, inst.rotation));
+  res.Set("rotation_velocity", Napi::Number::New(env, inst.rotation_velocity));
+  res.Set("last_delta", Napi::Number::New(env, inst.last_update));
+  return res;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const Asteroid& asteroid) {
+  Napi::Object res = ToNodeObject(env, static_cast<const Instance&>(asteroid));
+  Napi::Array arr = Napi::Array::New(env, asteroid.geometry.size());
+  
+  uint32_t i = 0;
+  for (const auto& point : asteroid.geometry) {
+    arr[i++] = ToNodeObject(env, point);
+  }
+
+  res.Set("geometry", arr);
+
+  return res;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const Ship& ship) {
+  Napi::Object res = ToNodeObject(env, static_cast<const Instance&>(ship));
+  res.Set("name", ship.name);
+  res.Set("score", ship.score);
+  res.Set("destroyed", ship.destroyed);
+  res.Set("lives", ship.lives);
+  return res;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const Projectile& proj) {
+  Napi::Object res = ToNodeObject(env, static_cast<const Instance&>(proj));
+  res.Set("clientID", Napi::Number::New(env, proj.client_ID));
+  res.Set("creationTime", Napi::Number::New(env, proj.creation_time));
+  res.Set("origin", ToNodeObject(env, proj.origin));
+  return res;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const Collision& collision) {
+  Napi::Object res = ToNodeObject(env, static_cast<const Instance&>(collision));
+  res.Set("creationTime", collision.creation_time);
+  return res;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const BiomeInfo& info) {
+  Napi::Object res = Napi::Object::New(env);
+  res.Set("chunk", ToNodeObject(env, info.chunk));
+  res.Set("biome", Napi::Number::New(env, static_cast<int>(info.biome)));
+  return res;
+}
+
+// converts a list of instances to an array
+template <typename T>
+static Napi::Array ToNodeArray(Napi::Env env, const std::vector<T>& instances) {
+  Napi::Array instance_arr = Napi::Array::New(env);
+  uint32_t i = 0;
+  for (const auto& inst : instances) {
+    instance_arr[i++] = ToNodeObject(env, inst);
+  }
+
+  return instance_arr;
+}
+
+static Napi::Array ToNodeArray(Napi::Env env, const FlatHashSet<uint64_t>& ids) {
+  Napi::Array deleted_nums = Napi::Array::New(env);
+  uint32_t i = 0;
+  for (const auto& id : ids) {
+    deleted_nums[i++] = Napi::Number::New(env, id);
+  }
+
+  return deleted_nums;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const server::ServerPacket& packet) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("asteroids", ToNodeArray(env, packet.asteroids));
+  obj.Set("ships", ToNodeArray(env, packet.ships));
+  obj.Set("collisions", ToNodeArray(env, packet.collisions));
+  obj.Set("projectiles", ToNodeArray(env, packet.projectiles));
+  obj.Set("projectilesLocal", ToNodeArray(env, packet.projectiles_local));
+  obj.Set("deltas", ToNodeArray(env, packet.deltas));
+  obj.Set("deleted", ToNodeArray(env, packet.deleted));
+  obj.Set("deletedLocal", ToNodeArray(env, packet.deleted_local));
+  obj.Set("serverTime", Napi::Number::New(env, packet.server_time));
+  obj.Set("score", Napi::Number::New(env, packet.score));
+  obj.Set("destroyed", Napi::Boolean::New(env, packet.destroyed));
+  return obj;
+}
+
+static Napi::Object ToNodeObject(Napi::Env env, const server::RollingHistogram& hist) {
+  // seconds -> milliseconds
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("mean", Napi::Number::New(env, hist.GetMean() * 1000.0));
+  obj.Set("p50", Napi::Number::New(env, hist.GetPercentile(0.5) * 1000.0));
+  obj.Set("p99", Napi::Number::New(env, hist.GetPercentile(0.99) * 1000.0));
+  obj.Set("max", Napi::Number::New(env, hist.GetMax() * 1000.0));
+  return obj;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const server::TickStats& stats) {
+  Napi::Object phases = Napi::Object::New(env);
+  for (int i = 0; i < server::tick_phase_count; i++) {
+    server::TickPhase phase = static_cast<server::TickPhase>(i);
+    phases.Set(server::TickPhaseToString(phase), ToNodeObject(env, stats.GetPhase(phase)));
+  }
+
+  const server::TickCounts& counts = stats.GetLastCounts();
+  Napi::Object count_obj = Napi::Object::New(env);
+  count_obj.Set("chunks", Napi::Number::New(env, counts.chunks));
+  count_obj.Set("activeChunks", Napi::Number::New(env, counts.active_chunks));
+  count_obj.Set("asteroids", Napi::Number::New(env, counts.asteroids));
+  count_obj.Set("ships", Napi::Number::New(env, counts.ships));
+  count_obj.Set("projectiles", Napi::Number::New(env, counts.projectiles));
+  count_obj.Set("packets", Napi::Number::New(env, counts.packets));
+
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("ticks", Napi::Number::New(env, static_cast<double>(stats.GetTickCount())));
+  obj.Set("window", Napi::Number::New(env, static_cast<double>(stats.GetTotal().GetCount())));
+  obj.Set("phases", phases);
+  obj.Set("total", ToNodeObject(env, stats.GetTotal()));
+  obj.Set("counts", count_obj);
+  return obj;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const server::ShipCost& cost) {
+  // seconds -> milliseconds
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("id", Napi::Number::New(env, static_cast<double>(cost.id)));
+  obj.Set("chunk", ToNodeObject(env, cost.chunk));
+  obj.Set("biome", Napi::Number::New(env, static_cast<int>(cost.biome)));
+  obj.Set("ticks", Napi::Number::New(env, static_cast<double>(cost.ticks)));
+  obj.Set("fanoutMs", Napi::Number::New(env, cost.fanout_time * 1000.0));
+  obj.Set("lastFanoutMs", Napi::Number::New(env, cost.last_fanout_time * 1000.0));
+  obj.Set("inputMs", Napi::Number::New(env, cost.input_time * 1000.0));
+  obj.Set("scanned", Napi::Number::New(env, static_cast<double>(cost.scanned)));
+  obj.Set("deltas", Napi::Number::New(env, static_cast<double>(cost.deltas)));
+  obj.Set("bytes", Napi::Number::New(env, static_cast<double>(cost.bytes)));
+  obj.Set("projectiles", Napi::Number::New(env, static_cast<double>(cost.projectiles)));
+  return obj;
+}
+
+static Napi::Object ToNodeObject(Napi::Env env, const server::MemoryUsage& usage) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("count", Napi::Number::New(env, static_cast<double>(usage.count)));
+  obj.Set("bytes", Napi::Number::New(env, static_cast<double>(usage.bytes)));
+  return obj;
+}
+
+Napi::Object ToNodeObject(Napi::Env env, const server::MemoryStats& stats) {
+  Napi::Array chunks = Napi::Array::New(env, stats.largest_chunks.size());
+  for (size_t i = 0; i < stats.largest_chunks.size(); i++) {
+    const server::ChunkMemory& mem = stats.largest_chunks[i];
+    Napi::Object chunk = Napi::Object::New(env);
+    chunk.Set("chunk", ToNodeObject(env, mem.chunk));
+    chunk.Set("bytes", Napi::Number::New(env, static_cast<double>(mem.GetTotalBytes())));
+    chunk.Set("asteroids", ToNodeObject(env, mem.asteroids));
+    chunk.Set("ships", ToNodeObject(env, mem.ships));
+    chunk.Set("projectiles", ToNodeObject(env, mem.projectiles));
+    chunk.Set("collisions", ToNodeObject(env, mem.collisions));
+    chunk.Set("deleted", ToNodeObject(env, mem.deleted));
+    chunk.Set("encoded", ToNodeObject(env, mem.encoded));
+    chunks[i] = chunk;
+  }
+
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("totalBytes", Napi::Number::New(env, static_cast<double>(stats.GetTotalBytes())));
+  obj.Set("asteroids", ToNodeObject(env, stats.asteroids));
+  obj.Set("ships", ToNodeObject(env, stats.ships));
+  obj.Set("projectiles", ToNodeObject(env, stats.projectiles));
+  obj.Set("collisions", ToNodeObject(env, stats.collisions));
+  obj.Set("deleted", ToNodeObject(env, stats.deleted));
+  obj.Set("encoded", ToNodeObject(env, stats.encoded));
+  obj.Set("chunks", ToNodeObject(env, stats.chunks));
+  obj.Set("emptyChunks", Napi::Number::New(env, static_cast<double>(stats.empty_chunks)));
+  obj.Set("materialized", ToNodeObject(env, stats.materialized));
+  obj.Set("knownIds", ToNodeObject(env, stats.known_ids));
+  obj.Set("newProjectiles", ToNodeObject(env, stats.new_projectiles));
+  obj.Set("shipIndex", ToNodeObject(env, stats.ship_index));
+  obj.Set("collisionWorld", ToNodeObject(env, stats.collision_world));
+  obj.Set("sweepAndPrune", ToNodeObject(env, stats.sweep_and_prune));
+  obj.Set("biomeManager", ToNodeObject(env, stats.biome_manager));
+  obj.Set("largestChunks", chunks);
+  return obj;
+}
+
+Napi::String BiomeToString(const Biome& b, const Napi::Env& env) {
+  return Napi::String::New(env, vasteroids::BiomeToString(b));
+}
+
+bool FromNodeObject(Napi::Object obj, WorldPosition& out) {
+  Napi::Env env = obj.Env();
+  Napi::Value chunkObj = obj.Get("chunk");
+  if (!chunkObj.IsObject()) {
+    TYPEERROR_RETURN_FALSE(env, "no point2d 'chunk' field on provided object");
+  }
+
+  if (!FromNodeObject(chunkObj.As<Napi::Object>(), out.chunk)) {
+    return false;
+  }
+
+  Napi::Value posObj = obj.Get("position");
+  if (!posObj.IsObject()) {
+    TYPEERROR_RETURN_FALSE(env, "no point2d 'position' field on provided object");
+  }
+
+  return FromNodeObject(posObj.As<Napi::Object>(), out.position);
+}
+
+bool FromNodeObject(Napi::Object obj, Instance& out) {
+  Napi::Env env = obj.Env();
+  Napi::Value posObj = obj.Get("position");
+  if (!posObj.IsObject()) {
+    TYPEERROR_RETURN_FALSE(env, "no worldposition 'position' on provided object");
+  }
+
+  if (!FromNodeObject(posObj.As<Napi::Object>(), out.position)) {
+    return false;
+  }
+  
+  Napi::Value velObj = obj.Get("velocity");
+  if (!velObj.IsObject()) {
+    TYPEERROR_RETURN_FALSE(env, "no point2d 'velocity' on provided object");
+  }
+
+  if (!FromNodeObject(velObj.As<Napi::Object>(), out.velocity)) {
+    return false;
+  }
+
+  Napi::Value rotObj = obj.Get("rotation");
+  if (!rotObj.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(env, "rotation field is missing");
+  }
+
+  out.rotation = rotObj.As<Napi::Number>().FloatValue();
+
+  Napi::Value rot_velo = obj.Get("rotation_velocity");
+  if (!rot_velo.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(env, "rotation_velocity field is missing");
+  }
+
+  out.rotation_velocity = rot_velo.As<Napi::Number>().FloatValue();
+
+  Napi::Value origin_time = obj.Get("last_delta");
+  if (!origin_time.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(env, "delta field is missing");
+  }
+
+  out.last_update = origin_time.As<Napi::Number>().DoubleValue();
+
+  Napi::Value id_info = obj.Get("id");
+  if (!id_info.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(env, "id field is missing");
+  }
+
+  out.id = static_cast<uint64_t>(id_info.As<Napi::Number>().Int64Value());
+  return true;
+}
+
+bool FromNodeObject(Napi::Object obj, Asteroid& out) {
+  if (!FromNodeObject(obj, static_cast<Instance&>(out))) {
+    return false;
+  }
+
+  Napi::Env env = obj.Env();
+  Napi::Value geom = obj.Get("geometry");
+  if (geom.IsUndefined() || !geom.IsArray()) {
+    // something is wrong
+    TYPEERROR_RETURN_FALSE(env, "'geometry' field of asteroid not present");
+  }
+
+  Napi::Array arr = geom.As<Napi::Array>();
+  Point2D<float> point;
+  for (uint32_t i = 0; i < arr.Length(); i++) {
+    Napi::Value val = arr[i];
+    if (!val.IsObject()) {
+      TYPEERROR_RETURN_FALSE(env, "indices of 'geometry' field are not object");
+    }
+
+    if (!FromNodeObject(val.As<Napi::Object>(), point)) {
+      return false;
+    }
+
+    out.geometry.push_back(point);
+  }
+
+  return true;
+}
+
+bool FromNodeObject(Napi::Object obj, Ship& out) {
+  if (!FromNodeObject(obj, static_cast<Instance&>(out))) {
+    return false;
+  }
+
+  Napi::Env env = obj.Env();
+  Napi::Value nameObj = obj.Get("name");
+  if (!nameObj.IsString()) {
+    TYPEERROR_RETURN_FALSE(env, "string field not present on ship");
+  }
+
+  out.name = nameObj.As<Napi::String>().Utf8Value(); 
+
+  Napi::Value scoreObj = obj.Get("score");
+  if (!scoreObj.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(env, "score field not present :(");
+  }
+
+  out.score = scoreObj.As<Napi::Number>().Int64Value();
+
+  Napi::Value destroyedObj = obj.Get("destroyed");
+  if (!destroyedObj.IsBoolean()) {
+    TYPEERROR_RETURN_FALSE(env, "destroyed field not present :(");
+  }
+
+  out.destroyed = destroyedObj.As<Napi::Boolean>().Value();
+
+  Napi::Value livesObj = obj.Get("lives");
+  if (!livesObj.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(env, "lives field not present");
+  }
+
+  out.lives = livesObj.As<Napi::Number>().Int32Value();
+  return true;
+}
+
+bool FromNodeObject(Napi::Object obj, Projectile& out) {
+  if (!FromNodeObject(obj, static_cast<Instance&>(out))) {
+    return false;
+  }
+
+  Napi::Value id = obj.Get("clientID");
+  if (!id.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(obj.Env(), "'id' field not present!");
+  }
+
+  out.client_ID = id.As<Napi::Number>().Uint32Value();
+
+  Napi::Value creation = obj.Get("creationTime");
+  if (!creation.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(obj.Env(), "'creationTime' field not present!");
+  }
+
+  out.creation_time = creation.As<Napi::Number>().Uint32Value();
+
+  Napi::Value org = obj.Get("origin");
+  if (!org.IsObject()) {
+    TYPEERROR_RETURN_FALSE(obj.Env(), "'origin' field not correct");
+  }
+
+  return FromNodeObject(org.As<Napi::Object>(), out.origin);
+}
+
+bool FromNodeObject(Napi::Object obj, Collision& out) {
+  if (!FromNodeObject(obj, static_cast<Instance&>(out))) {
+    return false;
+  }
+
+  Napi::Value time = obj.Get("creationTime");
+  if (!time.IsNumber()) {
+    TYPEERROR_RETURN_FALSE(obj.Env(), "time field missing!");
+  }
+
+  out.creation_time = time.As<Napi::Number>().DoubleValue();
+  return true;
+}
+
+bool FromNodeObject(Napi::Object obj, client::ClientPacket& out) {
+  Napi::Env env = obj.Env();
+  Napi::Value shipObj = obj.Get("ship");
+
+  if (!shipObj.IsObject()) {
+    TYPEERROR_RETURN_FALSE(env, "Property 'ship' not found on object");
+  }
+
+  if (!FromNodeObject(shipObj.As<Napi::Object>(), out.client_ship)) {
+    return false;
+  }
+
+  Napi::Value proj = obj.Get("projectiles");
+  if (!proj.IsArray()) {
+    TYPEERROR_RETURN_FALSE(env, "Property 'projectiles' not found on object");
+  }
+
+  Napi::Array proj_array = proj.As<Napi::Array>();
+  for (uint32_t i = 0; i < proj_array.Length(); i++) {
+    Napi::Value proj = proj_array[i];
+    if (!proj.IsObject()) {
+      TYPEERROR_RETURN_FALSE(env, "Contents of projectile array are not projectiles!");
+    }
+
+    Projectile res;
+    if (!FromNodeObject(proj.As<Napi::Object>(), res)) {
+      return false;
+    }
+
+    out.projectiles.push_back(res);
+  }
+
+  return true;
+}
+
+}
+}
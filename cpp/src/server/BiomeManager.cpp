@@ -1,113 +1,272 @@
 #include <server/BiomeManager.hpp>
+#include <server/MemoryStats.hpp>
 
-#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
 
 namespace vasteroids {
 namespace server {
 
-BiomeManager::BiomeManager(int chunk_dims, int biome_count) : chunk_dims_(chunk_dims), generator_(std::rand()) {
-  chunks_ = std::uniform_int_distribution<int>(0, chunk_dims_ - 1);
-  biomes_ = std::uniform_int_distribution<int>(1, static_cast<int>(Biome::BLACKHOLE));
-  biome_fudge_ = std::uniform_real_distribution<double>(0.8, 1.2);
+BiomeManager::BiomeManager(int chunk_dims, int biome_count, uint64_t seed)
+  : chunk_dims_(chunk_dims),
+    biome_map_(chunk_dims * chunk_dims, static_cast<uint8_t>(Biome::NORMAL)),
+    asteroid_density_(0.0),
+    seed_(seed),
+    spawn_rng_(seed, RandomPurpose::SPAWN_CHUNKS),
+    base_weights_(chunk_dims * chunk_dims, 0.0),
+    asteroid_counts_(chunk_dims * chunk_dims, 0),
+    sampler_(chunk_dims * chunk_dims) {
   // scatter some number of "biome points" on our grid
-  // use a simple algo to find closest one
-  // assign biome based on it
-  // add to a counter, and add the respective float value to our biome tree alongside the chunk
-  biome_map_ = new Biome*[chunk_dims_];
+  // find the closest one to each chunk, and assign biome based on it
+  // then weight each chunk by its biome, so that we can sample spawn locations from it
+  std::vector<Point2D<int>> biome_origins(std::max(biome_count, 0));
+  std::vector<Biome> biomes(biome_origins.size());
+  RandomStream origin_rng(seed_, RandomPurpose::BIOME_ORIGINS);
+  for (size_t i = 0; i < biome_origins.size(); i++) {
+    biome_origins[i].x = origin_rng.NextInt(0, chunk_dims_ - 1);
+    biome_origins[i].y = origin_rng.NextInt(0, chunk_dims_ - 1);
+    biomes[i] = static_cast<Biome>(origin_rng.NextInt(1, static_cast<int>(Biome::BLACKHOLE)));
+  }
+
+  BuildBiomeMap(biome_origins, biomes);
+  BuildWeights();
+}
+
+BiomeManager::BiomeManager(int chunk_dims, std::vector<uint8_t> biome_map, uint64_t seed)
+  : chunk_dims_(chunk_dims),
+    biome_map_(std::move(biome_map)),
+    asteroid_density_(0.0),
+    seed_(seed),
+    spawn_rng_(seed, RandomPurpose::SPAWN_CHUNKS),
+    base_weights_(chunk_dims * chunk_dims, 0.0),
+    asteroid_counts_(chunk_dims * chunk_dims, 0),
+    sampler_(chunk_dims * chunk_dims) {
+  biome_map_.resize(chunk_dims * chunk_dims, static_cast<uint8_t>(Biome::NORMAL));
+  BuildWeights();
+}
+
+void BiomeManager::BuildWeights() {
+  // each chunk's weight is fudged a little, from a stream of its own
+  prob_sum_ = 0.0;
   for (int i = 0; i < chunk_dims_; i++) {
-    biome_map_[i] = new Biome[chunk_dims_];
+    for (int j = 0; j < chunk_dims_; j++) {
+      RandomStream fudge_rng(seed_, RandomPurpose::BIOME_WEIGHTS, Point2D<int>(i, j));
+      double weight = GetBiomeWeight(static_cast<Biome>(biome_map_[i * chunk_dims_ + j]));
+      base_weights_[i * chunk_dims_ + j] = weight * (0.8 + 0.4 * fudge_rng.NextDouble());
+      prob_sum_ += base_weights_[i * chunk_dims_ + j];
+    }
   }
-  
-  Point2D<int>* biome_origins = new Point2D<int>[biome_count];
-  Biome* biomes = new Biome[biome_count];
-  Point2D<int> temp;
-  for (int i = 0; i < biome_count; i++) {
-    temp.x = chunks_(generator_);
-    temp.y = chunks_(generator_);
-    biome_origins[i] = temp;
-    biomes[i] = static_cast<Biome>(biomes_(generator_));
+
+  sampler_.Build(base_weights_);
+}
+
+void BiomeManager::BuildBiomeMap(const std::vector<Point2D<int>>& origins, const std::vector<Biome>& biomes) {
+  // bucket our origins on a coarse grid, so that each chunk only has to check origins nearby.
+  // origins are spaced about 6 chunks apart, so 8 chunk buckets hold one or two each.
+  const int bucket_count = std::max(1, chunk_dims_ / 8);
+  const int bucket_width = chunk_dims_ / bucket_count;
+  std::vector<int> bucket_start(bucket_count * bucket_count + 1, 0);
+  std::vector<int> bucket_origins(origins.size());
+  auto get_bucket = [&](const Point2D<int>& p) {
+    return (p.x * bucket_count / chunk_dims_) * bucket_count + (p.y * bucket_count / chunk_dims_);
+  };
+
+  // counting sort -- origins within a bucket stay in index order
+  for (auto& origin : origins) {
+    bucket_start[get_bucket(origin) + 1]++;
   }
 
-  prob_sum_ = 0.0;
+  for (size_t i = 1; i < bucket_start.size(); i++) {
+    bucket_start[i] += bucket_start[i - 1];
+  }
 
-  Biome biome = Biome::NORMAL;
-  float dist;
-  float d_cur;
-  for (int i = 0; i < chunk_dims_; i++) {
+  {
+    std::vector<int> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t k = 0; k < origins.size(); k++) {
+      bucket_origins[fill[get_bucket(origins[k])]++] = static_cast<int>(k);
+    }
+  }
+
+  auto build_row = [&](int i) {
     for (int j = 0; j < chunk_dims_; j++) {
-      dist = chunk_dims_ * chunk_dims_ * 4;
-
-      for (int k = 0; k < biome_count; k++) {
-        temp = biome_origins[k];
-        d_cur = GetDistanceSquared(temp, {i, j});
-        if (d_cur < dist) {
-          dist = d_cur;
-          biome = biomes[k];
+      Point2D<int> chunk(i, j);
+      int bx = i * bucket_count / chunk_dims_;
+      int by = j * bucket_count / chunk_dims_;
+      float dist = std::numeric_limits<float>::max();
+      int nearest = -1;
+
+      // search rings of buckets outwards, until no unsearched bucket could hold anything closer
+      for (int r = 0; ; r++) {
+        for (int dx = -r; dx <= r; dx++) {
+          for (int dy = -r; dy <= r; dy++) {
+            if (std::max(std::abs(dx), std::abs(dy)) != r) {
+              continue;
+            }
+
+            int bucket = ((bx + dx + bucket_count * (r + 1)) % bucket_count) * bucket_count
+                       + ((by + dy + bucket_count * (r + 1)) % bucket_count);
+            for (int b = bucket_start[bucket]; b < bucket_start[bucket + 1]; b++) {
+              int k = bucket_origins[b];
+              float d_cur = GetDistanceSquared(origins[k], chunk);
+              // ties go to the lowest index, matching a brute force scan
+              if (d_cur < dist || (d_cur == dist && k < nearest)) {
+                dist = d_cur;
+                nearest = k;
+              }
+            }
+          }
+        }
+
+        // anything outside ring r is at least r bucket widths away
+        float reach = static_cast<float>(r * bucket_width);
+        if (2 * r + 1 >= bucket_count || dist < reach * reach) {
+          break;
         }
       }
 
-      // biome_map[x][y] stores the type of chunk (x, y)
-      biome_map_[i][j] = biome;
-      biome_prob_tree_.Insert(prob_sum_, {i, j});
-      prob_sum_ += GetBiomeWeight(biome);
+      biome_map_[i * chunk_dims_ + j] = static_cast<uint8_t>(nearest >= 0 ? biomes[nearest] : Biome::NORMAL);
     }
+  };
+
+  // rows are independent -- split them across threads
+  int thread_count = static_cast<int>(std::thread::hardware_concurrency());
+  thread_count = std::max(1, std::min(thread_count, chunk_dims_ / 64));
+  std::vector<std::thread> threads;
+  for (int t = 1; t < thread_count; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < chunk_dims_; i += thread_count) {
+        build_row(i);
+      }
+    });
+  }
+
+  for (int i = 0; i < chunk_dims_; i += thread_count) {
+    build_row(i);
   }
 
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+const std::vector<uint8_t>& BiomeManager::GetBiomeMap() const {
+  return biome_map_;
+}
+
+uint64_t BiomeManager::GetSpawnCounter() const {
+  return spawn_rng_.GetCounter();
+}
+
+void BiomeManager::SetSpawnCounter(uint64_t counter) {
+  spawn_rng_.Seek(counter);
+}
+
+void BiomeManager::PrintMap(std::ostream& out) {
   for (int i = 0; i < chunk_dims_; i++) {
     for (int j = 0; j < chunk_dims_; j++) {
-      switch (biome_map_[i][j]) {
+      switch (static_cast<Biome>(biome_map_[i * chunk_dims_ + j])) {
         case Biome::NORMAL:
-          std::cout << "N";
+          out << "N";
           break;
         case Biome::BARREN:
-          std::cout << "B";
+          out << "B";
           break;
         case Biome::BLACKHOLE:
-          std::cout << "H";
+          out << "H";
           break;
         case Biome::NEBULA:
-          std::cout << "E";
+          out << "E";
           break;
         case Biome::ASTEROIDFIELD:
-          std::cout << "A";
+          out << "A";
           break;
         case Biome::INVALID:
-          std::cout << "?";
+          out << "?";
           break;
       }
     }
-    std::cout << std::endl;
+    out << std::endl;
   }
+}
 
-  biome_picker_ = std::uniform_real_distribution<double>(0.0, prob_sum_);
-
-  delete[] biome_origins;
-  delete[] biomes;
+size_t BiomeManager::GetAllocatedBytes() const {
+  return GetHeapBytes(biome_map_) + GetHeapBytes(base_weights_) + GetHeapBytes(asteroid_counts_) + sampler_.GetAllocatedBytes();
 }
 
 Biome BiomeManager::GetBiome(Point2D<int> chunk) {
-  // wrap handling
-  if (chunk.x < 0 || chunk.x >= chunk_dims_ || chunk.y < 0 || chunk.y >= chunk_dims_) {
-    chunk.x -= (std::floor(static_cast<float>(chunk.x) / chunk_dims_)) * chunk_dims_;
-    chunk.y -= (std::floor(static_cast<float>(chunk.y) / chunk_dims_)) * chunk_dims_;
+  return static_cast<Biome>(biome_map_[WrapCoord(chunk.x) * chunk_dims_ + WrapCoord(chunk.y)]);
+}
+
+void BiomeManager::GetBiomeRegion(Point2D<int> origin, Point2D<int> dims, uint8_t* out) {
+  if (dims.x <= 0 || dims.y <= 0) {
+    return;
+  }
+
+  int y = WrapCoord(origin.y);
+  // each row of the region is at most two runs of the map -- before and after the wrap
+  int first_run = std::min(dims.y, chunk_dims_ - y);
+  for (int i = 0; i < dims.x; i++) {
+    const uint8_t* row = &biome_map_[WrapCoord(origin.x + i) * chunk_dims_];
+    uint8_t* dst = out + static_cast<size_t>(i) * dims.y;
+    std::memcpy(dst, row + y, first_run);
+    // regions wider than the world repeat it
+    for (int j = first_run; j < dims.y; j += chunk_dims_) {
+      std::memcpy(dst + j, row, std::min(chunk_dims_, dims.y - j));
+    }
   }
+}
 
-  return biome_map_[chunk.x][chunk.y];
+int BiomeManager::WrapCoord(int coord) const {
+  coord %= chunk_dims_;
+  return (coord < 0 ? coord + chunk_dims_ : coord);
 }
 
 Point2D<int> BiomeManager::GetRandomChunk() {
-  double seed = biome_picker_(generator_);
-  Point2D<int> res;
-  biome_prob_tree_.Lookup(seed, &res);
-  return res;
+  size_t index = sampler_.Sample(spawn_rng_.NextDouble());
+  return Point2D<int>(static_cast<int>(index / chunk_dims_), static_cast<int>(index % chunk_dims_));
 }
 
-BiomeManager::~BiomeManager() {
-  for (int i = 0; i < chunk_dims_; i++) {
-    delete[] biome_map_[i];
+void BiomeManager::SetAsteroidTarget(int count) {
+  asteroid_density_ = (prob_sum_ > 0.0 ? count / prob_sum_ : 0.0);
+  for (size_t i = 0; i < base_weights_.size(); i++) {
+    asteroid_counts_[i] = static_cast<int>(std::lround(base_weights_[i] * asteroid_density_));
   }
 
-  delete[] biome_map_;
+  std::vector<double> weights(base_weights_.size());
+  for (size_t i = 0; i < base_weights_.size(); i++) {
+    weights[i] = GetCrowdedWeight(base_weights_[i], asteroid_counts_[i]);
+  }
+
+  sampler_.Build(weights);
+}
+
+double BiomeManager::GetExpectedAsteroids(Point2D<int> chunk) const {
+  return base_weights_[WrapCoord(chunk.x) * chunk_dims_ + WrapCoord(chunk.y)] * asteroid_density_;
+}
+
+void BiomeManager::UpdateChunkCrowding(Point2D<int> chunk, int asteroid_count) {
+  chunk.x -= static_cast<int>(std::floor(static_cast<double>(chunk.x) / chunk_dims_)) * chunk_dims_;
+  chunk.y -= static_cast<int>(std::floor(static_cast<double>(chunk.y) / chunk_dims_)) * chunk_dims_;
+  int index = chunk.x * chunk_dims_ + chunk.y;
+  if (asteroid_counts_[index] == asteroid_count) {
+    return;
+  }
+
+  asteroid_counts_[index] = asteroid_count;
+  sampler_.SetWeight(index, GetCrowdedWeight(base_weights_[index], asteroid_count));
+}
+
+void BiomeManager::SetAsteroidCounts(const std::vector<int>& asteroid_counts) {
+  asteroid_counts_ = asteroid_counts;
+  std::vector<double> weights(base_weights_.size());
+  for (size_t i = 0; i < base_weights_.size(); i++) {
+    weights[i] = GetCrowdedWeight(base_weights_[i], asteroid_counts_[i]);
+  }
+
+  sampler_.Build(weights);
 }
 
 float BiomeManager::GetDistanceSquared(const Point2D<int>& a, const Point2D<int>& b) {
@@ -127,6 +286,16 @@ float BiomeManager::GetDistanceSquared(const Point2D<int>& a, const Point2D<int>
   return static_cast<float>(res.x * res.x + res.y * res.y);
 }
 
+double BiomeManager::GetCrowdedWeight(double base, int asteroid_count) {
+  double expected = base * asteroid_density_;
+  if (expected <= 0.0) {
+    return base;
+  }
+
+  // twice the base weight when empty, the base weight at its share, and falling off past that
+  return base * (2.0 * expected) / (expected + asteroid_count);
+}
+
 double BiomeManager::GetBiomeWeight(const Biome& b) {
   double weight;
   switch(b) {
@@ -148,7 +317,6 @@ double BiomeManager::GetBiomeWeight(const Biome& b) {
       break;
   }
 
-  weight *= biome_fudge_(generator_);
   return weight;
 }
 
@@ -1,6 +1,8 @@
 #include <server/Chunk.hpp>
+#include <server/WorldSnapshot.hpp>
 #include <GameTypes.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 #define PROJECTILE_LIFESPAN 5.0
@@ -14,6 +16,7 @@ Chunk::Chunk(double creation_time) {
 };
 
 void Chunk::InsertElements(const ServerPacket& insts) {
+  ForgetEncoding();
   for (auto& ship : insts.ships) {
     ships_.insert(std::make_pair(ship.id, ship));
   }
@@ -53,6 +56,7 @@ bool Chunk::UpdateInstance(Instance* inst, double cur) {
 }
 
 void Chunk::UpdateChunk(ServerPacket& resid, double server_time) {
+  ForgetEncoding();
   // TODO: we want to keep components up to date
   //       ever second or so, increase the ver number so that we send a delta to the client
 
@@ -118,11 +122,13 @@ void Chunk::UpdateChunk(ServerPacket& resid, double server_time) {
     }
   }
 
-  deleted_last_ = std::move(deleted_cur_);
-  deleted_cur_ = std::unordered_set<uint64_t>();
+  // swap rather than move, so both sets keep their storage
+  std::swap(deleted_last_, deleted_cur_);
+  deleted_cur_.clear();
 }
 
 Ship* Chunk::GetShip(uint64_t id) {
+  ForgetEncoding();
   auto itr = ships_.find(id);
   if (itr == ships_.end()) {
     return nullptr;
@@ -132,6 +138,7 @@ Ship* Chunk::GetShip(uint64_t id) {
 }
 
 Projectile* Chunk::GetProjectile(uint64_t id) {
+  ForgetEncoding();
   auto itr = projectiles_.find(id);
   if (itr == projectiles_.end()) {
     return nullptr;
@@ -140,7 +147,64 @@ Projectile* Chunk::GetProjectile(uint64_t id) {
   return &(itr->second);
 }
 
+size_t Chunk::GetAsteroidCount() const {
+  return asteroids_.size();
+}
+
+bool Chunk::IsEmpty() const {
+  return ships_.empty() && asteroids_.empty() && projectiles_.empty() && collisions_.empty();
+}
+
+// assigns rather than clears, so that the table's slots are freed too
+template <typename Table>
+static void Release(Table& table) {
+  if (table.bucket_count() > 0) {
+    table = Table();
+  }
+}
+
+void Chunk::ReleaseTransients() {
+  ForgetEncoding();
+  Release(projectiles_);
+  Release(collisions_);
+  Release(deleted_cur_);
+  Release(deleted_last_);
+
+  // ships come and go -- their slots would otherwise linger in every chunk they passed through
+  if (ships_.empty()) {
+    Release(ships_);
+  }
+}
+
+void Chunk::GetMemoryUsage(ChunkMemory& out) const {
+  out.asteroids = { asteroids_.size(), GetHeapBytes(asteroids_) };
+  for (auto& a : asteroids_) {
+    out.asteroids.bytes += GetHeapBytes(a.second.geometry);
+  }
+
+  out.ships = { ships_.size(), GetHeapBytes(ships_) };
+  for (auto& s : ships_) {
+    out.ships.bytes += GetHeapBytes(s.second.name);
+  }
+
+  out.projectiles = { projectiles_.size(), GetHeapBytes(projectiles_) };
+  out.collisions = { collisions_.size(), GetHeapBytes(collisions_) };
+  out.deleted = { deleted_cur_.size() + deleted_last_.size(), GetHeapBytes(deleted_cur_) + GetHeapBytes(deleted_last_) };
+  out.encoded = { (encoded_ ? 1u : 0u), (encoded_ ? GetHeapBytes(*encoded_) : 0) };
+}
+
+Asteroid* Chunk::GetAsteroid(uint64_t id) {
+  ForgetEncoding();
+  auto itr = asteroids_.find(id);
+  if (itr == asteroids_.end()) {
+    return nullptr;
+  }
+
+  return &(itr->second);
+}
+
 void Chunk::InsertShip(Ship& s) {
+  ForgetEncoding();
   // if we're inserting into a chunk, then the object has just been updated.
   if (ships_.count(s.id)) {
     ships_.erase(s.id);
@@ -149,18 +213,31 @@ void Chunk::InsertShip(Ship& s) {
 }
 
 void Chunk::InsertAsteroid(Asteroid& a) {
+  ForgetEncoding();
   asteroids_.insert(std::make_pair(a.id, a));
 }
 
+void Chunk::InsertAsteroids(std::vector<Asteroid>::iterator begin, std::vector<Asteroid>::iterator end) {
+  ForgetEncoding();
+  asteroids_.reserve(asteroids_.size() + (end - begin));
+  for (auto itr = begin; itr != end; itr++) {
+    uint64_t id = itr->id;
+    asteroids_.insert(std::make_pair(id, std::move(*itr)));
+  }
+}
+
 void Chunk::InsertProjectile(Projectile& p) {
+  ForgetEncoding();
   projectiles_.insert(std::make_pair(p.id, p));
 }
 
 void Chunk::InsertCollision(Collision& c) {
+  ForgetEncoding();
   collisions_.insert(std::make_pair(c.id, c));
 }
 
 bool Chunk::MoveShip(uint64_t id) {
+  ForgetEncoding();
   if (ships_.erase(id)) {
     return true;
   }
@@ -169,6 +246,7 @@ bool Chunk::MoveShip(uint64_t id) {
 }
 
 bool Chunk::RemoveInstance(uint64_t id) {
+  ForgetEncoding();
   if (ships_.erase(id)) {
     deleted_cur_.insert(id);
     return true;
@@ -215,5 +293,92 @@ void Chunk::GetContents(ServerPacket& resid) {
   }
 }
 
+void Chunk::GetAsteroids(std::vector<Asteroid>& resid) {
+  for (auto& a : asteroids_) {
+    resid.push_back(a.second);
+  }
+}
+
+void Chunk::GetAsteroids(std::vector<Asteroid*>& resid) {
+  ForgetEncoding();
+  for (auto& a : asteroids_) {
+    resid.push_back(&a.second);
+  }
+}
+
+void Chunk::GetProjectiles(std::vector<Projectile>& resid) {
+  for (auto& p : projectiles_) {
+    resid.push_back(p.second);
+  }
+}
+
+void Chunk::Serialize(BinaryWriter& out) const {
+  out.Put(last_server_time_);
+  out.Put<uint32_t>(static_cast<uint32_t>(ships_.size()));
+  for (auto& ship : ships_) {
+    Write(out, ship.second);
+  }
+
+  out.Put<uint32_t>(static_cast<uint32_t>(asteroids_.size()));
+  for (auto& asteroid : asteroids_) {
+    Write(out, asteroid.second);
+  }
+
+  out.Put<uint32_t>(static_cast<uint32_t>(projectiles_.size()));
+  for (auto& proj : projectiles_) {
+    Write(out, proj.second);
+  }
+
+  out.Put<uint32_t>(static_cast<uint32_t>(collisions_.size()));
+  for (auto& collision : collisions_) {
+    Write(out, collision.second);
+  }
+}
+
+std::shared_ptr<const std::vector<uint8_t>> Chunk::Encode() const {
+  if (!encoded_) {
+    BinaryWriter out;
+    Serialize(out);
+    // kept for a while -- don't hold onto the slack
+    out.Data().shrink_to_fit();
+    encoded_ = std::make_shared<const std::vector<uint8_t>>(std::move(out.Data()));
+  }
+
+  return encoded_;
+}
+
+void Chunk::ForgetEncoding() {
+  encoded_.reset();
+}
+
+// reads `count` instances of type T into `map`
+template <typename T>
+static bool ReadInstances(BinaryReader& in, FlatHashMap<uint64_t, T>& map) {
+  uint32_t count = in.Get<uint32_t>();
+  map.clear();
+  map.reserve(std::min<size_t>(count, in.Remaining()));
+  T inst;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!Read(in, inst)) {
+      return false;
+    }
+
+    map.insert(std::make_pair(inst.id, inst));
+  }
+
+  return in.ok();
+}
+
+bool Chunk::Deserialize(BinaryReader& in) {
+  ForgetEncoding();
+  last_server_time_ = in.Get<double>();
+  deleted_cur_.clear();
+  deleted_last_.clear();
+  return ReadInstances(in, ships_)
+      && ReadInstances(in, asteroids_)
+      && ReadInstances(in, projectiles_)
+      && ReadInstances(in, collisions_);
+}
+
 }
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <server/CollisionWorld.hpp>
+#include <server/MemoryStats.hpp>
 #include <AsteroidCollider.hpp>
 #include <AsteroidGenerator.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 namespace vasteroids {
@@ -19,20 +21,113 @@ static void CorrectChunk(Instance& inst, int chunk_dims) {
   inst.position.chunk = new_chunk;
 }
 
-CollisionWorld::CollisionWorld(int chunk_dims) : chunk_count_(chunk_dims) {}
+// number of cells along a chunk edge, for a requested cell size
+static int GetCellsPerChunk(float cell_size) {
+  if (!(cell_size > 0.0f)) {
+    return 8;
+  }
+
+  int cells = static_cast<int>(std::round(chunk_size / cell_size));
+  return std::max(1, std::min(cells, static_cast<int>(chunk_size)));
+}
+
+CollisionWorld::CollisionWorld(int chunk_dims, float cell_size)
+  : chunk_blocks_(chunk_dims * chunk_dims, -1),
+    block_count_(0),
+    chunk_relevant_(chunk_dims * chunk_dims, 0),
+    max_radius_(0.0f),
+    ship_radius_(0.0f),
+    chunk_count_(chunk_dims),
+    cells_per_chunk_(GetCellsPerChunk(cell_size)),
+    cell_size_(chunk_size / GetCellsPerChunk(cell_size)) {}
 
 void CollisionWorld::AddAsteroid(const Asteroid& a) {
-  asteroids_.insert(std::make_pair(a.id, a));
-  Point2D<int> min, max;
-  GetAsteroidBoundingBox(a, &min, &max);
-  for (int i = min.x; i < max.x; i++) {
-    for (int j = min.y; j < max.y; j++) {
-      Point2D<int> chunk_add;
-      chunk_add.x = (i + static_cast<int>(chunk_count_ * chunk_size)) % static_cast<int>(chunk_count_ * chunk_size);
-      chunk_add.y = (j + static_cast<int>(chunk_count_ * chunk_size)) % static_cast<int>(chunk_count_ * chunk_size); 
-      AddToCollisionChunk(a, chunk_add);
+  float radius = GetRadius(a.geometry);
+
+  // only index the asteroid if some projectile or ship passes through a cell it overlaps.
+  // with cells at least as wide as the asteroid, this touches at most 2x2 cells.
+  bool marked = ForEachCell(a.position, radius, [this](int32_t cell) {
+    return (cell_marks_[cell] != 0);
+  });
+
+  if (!marked) {
+    return;
+  }
+
+  // loose grid: store in the center cell only
+  int32_t cell = GetCellIndex(GetCellCoord(static_cast<double>(a.position.chunk.x) * chunk_size + a.position.position.x,
+                                           static_cast<double>(a.position.chunk.y) * chunk_size + a.position.position.y), true);
+  PushEntry(cell_heads_, cell, static_cast<uint32_t>(asteroids_.size()));
+  asteroids_.push_back(a);
+  max_radius_ = std::max(max_radius_, radius);
+}
+
+void CollisionWorld::AddShip(const Ship& s) {
+  double center_x = static_cast<double>(s.position.chunk.x) * chunk_size + s.position.position.x;
+  double center_y = static_cast<double>(s.position.chunk.y) * chunk_size + s.position.position.y;
+  float radius = GetRadius(GetShipGeometry());
+
+  // mark every cell the ship could touch, so asteroids there are indexed
+  Point2D<int> min = GetCellCoord(center_x - radius, center_y - radius);
+  int span_x = static_cast<int>(std::floor((center_x + radius) / cell_size_) - std::floor((center_x - radius) / cell_size_));
+  int span_y = static_cast<int>(std::floor((center_y + radius) / cell_size_) - std::floor((center_y - radius) / cell_size_));
+  for (int i = 0; i <= span_x; i++) {
+    for (int j = 0; j <= span_y; j++) {
+      MarkCell({ min.x + i, min.y + j });
+    }
+  }
+
+  int32_t cell = GetCellIndex(GetCellCoord(center_x, center_y), true);
+  PushEntry(ship_heads_, cell, static_cast<uint32_t>(ships_.size()));
+  ships_.push_back(s);
+  ship_radius_ = std::max(ship_radius_, radius);
+}
+
+void CollisionWorld::PushEntry(std::vector<int32_t>& heads, int32_t cell, uint32_t index) {
+  CellEntry entry;
+  entry.index = index;
+  entry.next = heads[cell];
+  heads[cell] = static_cast<int32_t>(entries_.size());
+  entries_.push_back(entry);
+}
+
+void CollisionWorld::MarkCell(Point2D<int> cell) {
+  int32_t index = GetCellIndex(cell, true);
+  if (cell_marks_[index]) {
+    return;
+  }
+
+  cell_marks_[index] = 1;
+  const int world_cells = chunk_count_ * cells_per_chunk_;
+  Point2D<int> chunk(((cell.x + world_cells) % world_cells) / cells_per_chunk_, ((cell.y + world_cells) % world_cells) / cells_per_chunk_);
+  for (int x = chunk.x - 1; x <= chunk.x + 1; x++) {
+    for (int y = chunk.y - 1; y <= chunk.y + 1; y++) {
+      int32_t chunk_index = ((x + chunk_count_) % chunk_count_) * chunk_count_ + ((y + chunk_count_) % chunk_count_);
+      if (!chunk_relevant_[chunk_index]) {
+        chunk_relevant_[chunk_index] = 1;
+        relevant_chunks_.push_back(chunk_index);
+      }
+    }
+  }
+}
+
+template <typename F>
+bool CollisionWorld::ForEachCell(const WorldPosition& center, float radius, F fn) {
+  double x = static_cast<double>(center.chunk.x) * chunk_size + center.position.x;
+  double y = static_cast<double>(center.chunk.y) * chunk_size + center.position.y;
+  Point2D<int> min = GetCellCoord(x - radius, y - radius);
+  int span_x = static_cast<int>(std::floor((x + radius) / cell_size_) - std::floor((x - radius) / cell_size_));
+  int span_y = static_cast<int>(std::floor((y + radius) / cell_size_) - std::floor((y - radius) / cell_size_));
+  for (int i = 0; i <= span_x; i++) {
+    for (int j = 0; j <= span_y; j++) {
+      int32_t cell = GetCellIndex({ min.x + i, min.y + j }, false);
+      if (cell >= 0 && fn(cell)) {
+        return true;
+      }
     }
   }
+
+  return false;
 }
 
 Point2D<float> CollisionWorld::GetDistance(const WorldPosition& a, const WorldPosition& b) {
@@ -62,135 +157,230 @@ void CollisionWorld::AddProjectile(const Projectile& p) {
   projectiles_.insert(std::make_pair(p.id, p));
   // delta will be determined by distance traveled
   Point2D<float> distFromOrigin = GetDistance(p.origin, p.position);
-  projectiles_.at(p.id).last_collision_delta = p.last_update - std::abs(distFromOrigin.x / p.velocity.x);
+  float speed = std::sqrt(p.velocity.x * p.velocity.x + p.velocity.y * p.velocity.y);
+  float dist = std::sqrt(distFromOrigin.x * distFromOrigin.x + distFromOrigin.y * distFromOrigin.y);
+  // stationary projectiles have nothing to sweep
+  projectiles_.at(p.id).last_collision_delta = p.last_update - (speed > 0.0f ? dist / speed : 0.0f);
+
+  // mark every cell along this projectile's path, so that we only index asteroids which it could hit
+  Projectile path = projectiles_.at(p.id);
+  TraceProjectile(path, [this](const WorldPosition& pos) {
+    MarkCell(GetCellCoord(static_cast<double>(pos.chunk.x) * chunk_size + pos.position.x,
+                          static_cast<double>(pos.chunk.y) * chunk_size + pos.position.y));
+    return false;
+  });
+}
+
+bool CollisionWorld::IsChunkRelevant(Point2D<int> chunk) const {
+  return chunk_relevant_[chunk.x * chunk_count_ + chunk.y];
+}
+
+float CollisionWorld::GetCellSize() const {
+  return cell_size_;
+}
+
+size_t CollisionWorld::GetAllocatedBytes() const {
+  size_t res = GetHeapBytes(chunk_blocks_) + GetHeapBytes(used_chunks_) + GetHeapBytes(cell_heads_)
+             + GetHeapBytes(ship_heads_) + GetHeapBytes(cell_marks_) + GetHeapBytes(entries_)
+             + GetHeapBytes(chunk_relevant_) + GetHeapBytes(relevant_chunks_)
+             + GetHeapBytes(asteroids_) + GetHeapBytes(ships_) + GetHeapBytes(projectiles_);
+
+  // asteroid and ship copies own their geometry and names
+  for (auto& a : asteroids_) {
+    res += GetHeapBytes(a.geometry);
+  }
+
+  for (auto& s : ships_) {
+    res += GetHeapBytes(s.name);
+  }
+
+  return res;
+}
+
+Point2D<int> CollisionWorld::GetCellCoord(double x, double y) const {
+  const int world_cells = chunk_count_ * cells_per_chunk_;
+  Point2D<int> cell(static_cast<int>(std::floor(x / cell_size_)) % world_cells,
+                    static_cast<int>(std::floor(y / cell_size_)) % world_cells);
+  if (cell.x < 0) {
+    cell.x += world_cells;
+  }
+
+  if (cell.y < 0) {
+    cell.y += world_cells;
+  }
+
+  return cell;
 }
 
-std::unordered_map<uint64_t, std::unordered_set<uint32_t>> CollisionWorld::ComputeCollisions(std::unordered_map<uint64_t, Point2D<int>>& deleted_insts, std::vector<std::pair<WorldPosition, float>>& deleted_asteroids) {
+int32_t CollisionWorld::GetCellIndex(Point2D<int> cell, bool create) {
+  const int world_cells = chunk_count_ * cells_per_chunk_;
+  // callers may step one cell past the world edge
+  cell.x = (cell.x + world_cells) % world_cells;
+  cell.y = (cell.y + world_cells) % world_cells;
+
+  int32_t chunk = (cell.x / cells_per_chunk_) * chunk_count_ + (cell.y / cells_per_chunk_);
+  int32_t block = chunk_blocks_[chunk];
+  if (block < 0) {
+    if (!create) {
+      return -1;
+    }
+
+    // blocks are recycled across clears, so only grow storage when we run out
+    const size_t block_cells = cells_per_chunk_ * cells_per_chunk_;
+    block = block_count_++;
+    if (cell_heads_.size() < block_count_ * block_cells) {
+      cell_heads_.resize(block_count_ * block_cells);
+      ship_heads_.resize(block_count_ * block_cells);
+      cell_marks_.resize(block_count_ * block_cells);
+    }
+
+    std::fill(cell_heads_.begin() + block * block_cells, cell_heads_.begin() + (block + 1) * block_cells, -1);
+    std::fill(ship_heads_.begin() + block * block_cells, ship_heads_.begin() + (block + 1) * block_cells, -1);
+    std::fill(cell_marks_.begin() + block * block_cells, cell_marks_.begin() + (block + 1) * block_cells, 0);
+    chunk_blocks_[chunk] = block;
+    used_chunks_.push_back(chunk);
+  }
+
+  int32_t local = (cell.x % cells_per_chunk_) * cells_per_chunk_ + (cell.y % cells_per_chunk_);
+  return block * cells_per_chunk_ * cells_per_chunk_ + local;
+}
+
+template <typename F>
+void CollisionWorld::TraceProjectile(Projectile& proj, F step) {
+  double delta_lookback = proj.last_update - proj.last_collision_delta;
+  
+  // effective 200hz collision detection
+  int delta_count = static_cast<int>(std::ceil(delta_lookback / 0.005));
+  float delta_step = static_cast<float>(delta_lookback / delta_count);
+  proj.position.position += ((proj.velocity) * -static_cast<float>(delta_lookback));
+
+  for (int i = 0; i < delta_count; i++) {
+    if (step(proj.position)) {
+      return;
+    }
+
+    proj.position.position += ((proj.velocity) * delta_step);
+    CorrectChunk(proj, chunk_count_);
+  }
+}
+
+FlatHashMap<uint64_t, FlatHashSet<uint32_t>> CollisionWorld::ComputeCollisions(FlatHashMap<uint64_t, Point2D<int>>& deleted_insts, std::vector<std::pair<WorldPosition, float>>& deleted_asteroids, std::vector<uint64_t>& destroyed_ships) {
+  // ships can only be destroyed once per tick
+  std::vector<uint8_t> ship_hit(ships_.size(), 0);
+  auto destroy_ship = [&](uint32_t index) {
+    ship_hit[index] = 1;
+    destroyed_ships.push_back(ships_[index].id);
+  };
+
   // for each projectile:
-  // see if its chunk has asteroids
-  // test it against each asteroid, breaking if it gets a hit
-  std::unordered_map<uint64_t, std::unordered_set<uint32_t>> res;
-  Point2D<int> chunk;
+  // see if its chunk has asteroids or ships
+  // test it against each, breaking if it gets a hit
+  FlatHashMap<uint64_t, FlatHashSet<uint32_t>> res;
   for (auto& proj : projectiles_) {
-    bool collide = false;
-    double delta_lookback = proj.second.last_update - proj.second.last_collision_delta;
-    
-    // effective 200hz collision detection
-    int delta_count = static_cast<int>(std::ceil(delta_lookback / 0.005));
-    float delta_step = static_cast<float>(delta_lookback / delta_count);
-    proj.second.position.position += ((proj.second.velocity) * -static_cast<float>(delta_lookback));
-
-    for (int i = 0; i < delta_count; i++) {
-      // issue when position modified without fixing chunk
-      chunk.x = static_cast<int>(proj.second.position.chunk.x * chunk_size + proj.second.position.position.x);
-      chunk.y = static_cast<int>(proj.second.position.chunk.y * chunk_size + proj.second.position.position.y);
-      if (asteroid_chunks_.count(chunk)) {
-        auto& contents = asteroid_chunks_.at(chunk);
-        for (auto& id : contents) {
-          if (!asteroids_.count(id)) {
-            std::cout << "what the fuck" << std::endl;
-            std::cout << "asteroid stored in chunk was not retained" << std::endl;
+    TraceProjectile(proj.second, [&](const WorldPosition& pos) {
+      auto hit = [&]() {
+        // add the projectile to our deleted IDs
+        deleted_insts.insert(std::make_pair(proj.second.id, pos.chunk));
+        res[proj.second.ship_ID].insert(proj.second.client_ID);
+      };
+
+      // any asteroid containing this point has its center within max_radius_ of it
+      bool collided = ForEachCell(pos, max_radius_, [&](int32_t cell) {
+        for (int32_t e = cell_heads_[cell]; e >= 0; e = entries_[e].next) {
+          Asteroid& ast = asteroids_[entries_[e].index];
+          if (!Collide(ast, pos, chunk_count_)) {
             continue;
           }
 
-          Asteroid& ast = asteroids_.at(id);
-          collide = (collide || Collide(ast, proj.second.position, chunk_count_));
-          if (collide) {
-            // add the hit asteroid to our deleted IDs
-            deleted_insts.insert(std::make_pair(ast.id, ast.position.chunk));
-            // add the projectile to our deleted IDs as well
-            deleted_insts.insert(std::make_pair(proj.second.id, proj.second.position.chunk));
-            uint64_t ship_id = proj.second.ship_ID;
-            if (!res.count(ship_id)) {
-              res.insert(std::make_pair(ship_id, std::unordered_set<uint32_t>()));
-            }
-
-            res.at(ship_id).insert(proj.second.client_ID);
-            //  - get radius as max (radius) of all points in the asteroid
-            float radius = GetAsteroidRadius(ast);
-            radius *= 0.707f;
-            //  - if the radius is below some threshold, don't generate two new
-            if (radius >= 0.25) {
-              deleted_asteroids.push_back(std::make_pair(ast.position, radius));
-            }
-            break;
+          // add the hit asteroid to our deleted IDs
+          deleted_insts.insert(std::make_pair(ast.id, ast.position.chunk));
+          hit();
+          //  - get radius as max (radius) of all points in the asteroid
+          float radius = GetRadius(ast.geometry);
+          radius *= 0.707f;
+          //  - if the radius is below some threshold, don't generate two new
+          if (radius >= 0.25) {
+            deleted_asteroids.push_back(std::make_pair(ast.position, radius));
           }
+
+          return true;
         }
-      }
 
-      if (collide) {
-        break;
+        return false;
+      });
+
+      if (collided || ships_.empty()) {
+        return collided;
       }
 
-      proj.second.position.position += ((proj.second.velocity) * delta_step);
-      Point2D<float> test = proj.second.velocity * delta_step;
+      // ships can't shoot themselves
+      return ForEachCell(pos, ship_radius_, [&](int32_t cell) {
+        for (int32_t e = ship_heads_[cell]; e >= 0; e = entries_[e].next) {
+          uint32_t index = entries_[e].index;
+          if (ship_hit[index] || ships_[index].id == proj.second.ship_ID || !Collide(ships_[index], pos, chunk_count_)) {
+            continue;
+          }
 
-      CorrectChunk(proj.second, chunk_count_);
+          destroy_ship(index);
+          hit();
+          return true;
+        }
+
+        return false;
+      });
+    });
+  }
+
+  // ships against asteroids -- asteroids survive these
+  for (uint32_t i = 0; i < ships_.size(); i++) {
+    if (ship_hit[i]) {
+      continue;
     }
+
+    ForEachCell(ships_[i].position, ship_radius_ + max_radius_, [&](int32_t cell) {
+      for (int32_t e = cell_heads_[cell]; e >= 0; e = entries_[e].next) {
+        if (Collide(asteroids_[entries_[e].index], ships_[i], chunk_count_)) {
+          destroy_ship(i);
+          return true;
+        }
+      }
+
+      return false;
+    });
   }
+
   return res;
 }
 
 
 void CollisionWorld::clear() {
-  asteroid_chunks_.clear();
-  asteroids_.clear();
-  projectiles_.clear();
-}
-
-void CollisionWorld::GetAsteroidBoundingBox(const Asteroid& a, Point2D<int>* min, Point2D<int>* max) {
-  Point2D<double> center(
-    static_cast<double>(a.position.chunk.x) * chunk_size + static_cast<double>(a.position.position.x),
-    static_cast<double>(a.position.chunk.y) * chunk_size + static_cast<double>(a.position.position.y));
-
-  float rs = sin(a.rotation);
-  float rc = cos(a.rotation);
-
-  // this owrks now :)
-  Point2D<double> bb_min = center, bb_max = center;
-  double geom_x, geom_y;
-  for (auto& point : a.geometry) {
-    geom_x = static_cast<double>(point.x * rc + point.y * rs + center.x);
-    geom_y = static_cast<double>(point.x * -rs + point.y * rc + center.y);
-    bb_min.x = std::min(bb_min.x, geom_x);
-    bb_min.y = std::min(bb_min.y, geom_y);
-    bb_max.x = std::max(bb_max.x, geom_x);
-    bb_max.y = std::max(bb_max.y, geom_y);
+  for (auto chunk : used_chunks_) {
+    chunk_blocks_[chunk] = -1;
   }
 
-  // round truncates
-  min->x = static_cast<int>(bb_min.x);
-  if (bb_min.x < 0) {
-    // floor behavior vs. truncation towards 0
-    min->x--;
+  for (auto chunk : relevant_chunks_) {
+    chunk_relevant_[chunk] = 0;
   }
 
-  min->y = static_cast<int>(bb_min.y);
-  if (bb_min.y < 0) {
-    min->y--;
-  }
-  
-  // will never be < 0 -- so no problem :)
-  max->x = static_cast<int>(bb_max.x + 1);
-  max->y = static_cast<int>(bb_max.y + 1);
+  used_chunks_.clear();
+  relevant_chunks_.clear();
+  block_count_ = 0;
+  entries_.clear();
+  asteroids_.clear();
+  max_radius_ = 0.0f;
+  ships_.clear();
+  ship_radius_ = 0.0f;
+  projectiles_.clear();
 }
 
-float CollisionWorld::GetAsteroidRadius(const Asteroid& a) {
+float CollisionWorld::GetRadius(const std::vector<Point2D<float>>& geometry) {
   double max_radius = 0;
-  for (auto& p : a.geometry) {
+  for (auto& p : geometry) {
     max_radius = std::max(max_radius, static_cast<double>(p.x * p.x + p.y * p.y));
   }
 
   return static_cast<double>(sqrt(max_radius));
 }
 
-void CollisionWorld::AddToCollisionChunk(const Asteroid& a, Point2D<int> chunk) {
-  if (!asteroid_chunks_.count(chunk)) {
-    asteroid_chunks_.insert(std::make_pair(chunk, std::unordered_set<uint64_t>()));
-  }
-
-  asteroid_chunks_.at(chunk).insert(a.id);
 }
-
 }
-}
\ No newline at end of file
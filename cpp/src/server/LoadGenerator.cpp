@@ -0,0 +1,156 @@
+#include <server/LoadGenerator.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace vasteroids {
+namespace server {
+
+// roughly the feel of the client's controls
+static const float bot_thrust = 12.0f;
+static const float bot_drag = 0.5f;
+static const float bot_max_speed = 10.0f;
+static const float bot_turn_rate = 3.0f;
+static const float projectile_speed = 40.0f;
+
+// bursts per second, and shots per second within a burst
+static const double burst_rate = 0.4;
+static const double shot_rate = 5.0;
+
+LoadGenerator::LoadGenerator(World& world, uint64_t seed) : world_(world), seed_(seed), bots_added_(0) {}
+
+void LoadGenerator::SetBotCount(int count) {
+  count = std::max(count, 0);
+  while (static_cast<int>(bots_.size()) > count) {
+    world_.DeleteShip(bots_.back().ship.id);
+    bots_.pop_back();
+  }
+
+  bots_.reserve(count);
+  while (static_cast<int>(bots_.size()) < count) {
+    AddBot();
+  }
+}
+
+void LoadGenerator::ReplaceBots(int count) {
+  count = std::min(std::max(count, 0), static_cast<int>(bots_.size()));
+  for (int i = 0; i < count; i++) {
+    world_.DeleteShip(bots_[i].ship.id);
+  }
+
+  bots_.erase(bots_.begin(), bots_.begin() + count);
+  for (int i = 0; i < count; i++) {
+    AddBot();
+  }
+}
+
+int LoadGenerator::GetBotCount() const {
+  return static_cast<int>(bots_.size());
+}
+
+void LoadGenerator::AddBot() {
+  Bot bot;
+  bot.rng = RandomStream(seed_, RandomPurpose::BOTS, ++bots_added_);
+  bot.ship = *world_.AddShip("bot" + std::to_string(bots_added_));
+  bot.burst = 0;
+  bot.next_projectile = 0;
+  bots_.push_back(bot);
+}
+
+void LoadGenerator::SendInputs(double tick_length) {
+  client::ClientPacket packet;
+  for (auto& bot : bots_) {
+    StepBot(bot, tick_length, packet);
+    world_.HandleClientPacket(packet);
+  }
+}
+
+void LoadGenerator::StepBot(Bot& bot, double tick_length, client::ClientPacket& packet) {
+  Ship& ship = bot.ship;
+  float dt = static_cast<float>(tick_length);
+  double time = world_.GetServerTime();
+
+  // wander: turn a little either way, and thrust most of the time
+  ship.rotation_velocity = bot.rng.NextFloat(-bot_turn_rate, bot_turn_rate);
+  ship.rotation += ship.rotation_velocity * dt;
+  if (bot.rng.NextDouble() < 0.7) {
+    ship.velocity.x += std::cos(ship.rotation) * bot_thrust * dt;
+    ship.velocity.y += std::sin(ship.rotation) * bot_thrust * dt;
+  }
+
+  ship.velocity *= std::max(0.0f, 1.0f - bot_drag * dt);
+  float speed = std::sqrt(ship.velocity.x * ship.velocity.x + ship.velocity.y * ship.velocity.y);
+  if (speed > bot_max_speed) {
+    ship.velocity *= (bot_max_speed / speed);
+  }
+
+  // keep the position within its chunk -- the world wraps the chunk itself
+  ship.position.position += ship.velocity * dt;
+  float cx = std::floor(ship.position.position.x / chunk_size);
+  float cy = std::floor(ship.position.position.y / chunk_size);
+  ship.position.chunk.x += static_cast<int>(cx);
+  ship.position.chunk.y += static_cast<int>(cy);
+  ship.position.position.x -= cx * chunk_size;
+  ship.position.position.y -= cy * chunk_size;
+  ship.last_update = time;
+
+  packet.client_ship = ship;
+  packet.projectiles.clear();
+  if (ship.destroyed) {
+    return;
+  }
+
+  if (bot.burst == 0 && bot.rng.NextDouble() < burst_rate * tick_length) {
+    bot.burst = bot.rng.NextInt(3, 6);
+  }
+
+  if (bot.burst > 0 && bot.rng.NextDouble() < shot_rate * tick_length) {
+    bot.burst--;
+    // every field is set -- the packet is logged as it stands, before the world fills in its own
+    Projectile p;
+    p.id = 0;
+    p.client_ID = bot.next_projectile++;
+    p.ship_ID = 0;
+    p.position = ship.position;
+    p.origin = ship.position;
+    p.velocity.x = ship.velocity.x + std::cos(ship.rotation) * projectile_speed;
+    p.velocity.y = ship.velocity.y + std::sin(ship.rotation) * projectile_speed;
+    p.rotation = ship.rotation;
+    p.rotation_velocity = 0.0f;
+    p.creation_time = time;
+    p.origin_time = time;
+    p.last_update = time;
+    p.last_collision_delta = time;
+    p.ver = 0;
+    packet.projectiles.push_back(p);
+  }
+}
+
+size_t LoadGenerator::HandlePackets(const FlatHashMap<uint64_t, ServerPacket>& packets) {
+  size_t bytes = 0;
+  for (auto& bot : bots_) {
+    auto p = packets.find(bot.ship.id);
+    if (p == packets.end()) {
+      continue;
+    }
+
+    bytes += p->second.GetEncodedSize();
+    if (!p->second.destroyed) {
+      continue;
+    }
+
+    Ship* respawned = world_.RespawnShip(bot.ship.id);
+    if (respawned == nullptr) {
+      world_.DeleteShip(bot.ship.id);
+      respawned = world_.AddShip(bot.ship.name);
+    }
+
+    bot.ship = *respawned;
+  }
+
+  return bytes;
+}
+
+}
+}
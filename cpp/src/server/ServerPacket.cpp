@@ -3,108 +3,41 @@
 namespace vasteroids {
 namespace server {
 
+// sizes from ServerPacketDecoder, in bytes
+static const size_t header_size = 20;
+static const size_t footer_size = 13;
+static const size_t instance_size = 45;
+static const size_t point_size = 8;
+static const size_t id_size = 8;
+
+static const size_t asteroid_size_base = instance_size + 2;
+static const size_t ship_size_base = instance_size + 9;
+static const size_t collision_size = instance_size + 8;
+static const size_t projectile_size = instance_size + 24;
+
 void ServerPacket::ConcatPacket(const ServerPacket& packet) {
   // ignore server time
   asteroids.insert(asteroids.end(), packet.asteroids.begin(), packet.asteroids.end());
   ships.insert(ships.end(), packet.ships.begin(), packet.ships.end());
 }
 
-Napi::Object ServerPacket::ToNodeObject(Napi::Env env) {
-  Napi::Object obj = Napi::Object::New(env);
-
-  {
-    Napi::Array instance_arr = Napi::Array::New(env);
-    uint32_t i = 0;
-    for (const auto& asteroid : asteroids) {
-      instance_arr[i++] = asteroid.ToNodeObject(env);
-    }
-
-    obj.Set("asteroids", instance_arr);
-  }
-
-  {
-    Napi::Array instance_arr = Napi::Array::New(env);
-    uint32_t i = 0;
-    for (const auto& ship : ships) {
-      instance_arr[i++] = ship.ToNodeObject(env);
-    }
-
-    obj.Set("ships", instance_arr);
-  }
-
-  {
-    Napi::Array instance_arr = Napi::Array::New(env);
-    uint32_t i = 0;
-    for (const auto& collision : collisions) {
-      instance_arr[i++] = collision.ToNodeObject(env);
-    }
-
-    obj.Set("collisions", instance_arr);
-  }
-
-  {
-    Napi::Array instance_arr = Napi::Array::New(env);
-    uint32_t i = 0;
-    for (const auto& proj : projectiles) {
-      instance_arr[i++] = proj.ToNodeObject(env);
-    }
-
-    obj.Set("projectiles", instance_arr);
-  }
-
-  {
-    Napi::Array instance_arr = Napi::Array::New(env);
-    uint32_t i = 0;
-    for (const auto& proj : projectiles_local) {
-      instance_arr[i++] = proj.ToNodeObject(env);
-    }
-
-    obj.Set("projectilesLocal", instance_arr);
+size_t ServerPacket::GetEncodedSize() const {
+  size_t res = header_size;
+  for (auto& a : asteroids) {
+    res += asteroid_size_base + a.geometry.size() * point_size;
   }
 
-  {
-    Napi::Array instance_arr = Napi::Array::New(env);
-    uint32_t i = 0;
-    for (const auto& delta : deltas) {
-      instance_arr[i++] = delta.ToNodeObject(env);
-    }
-
-    obj.Set("deltas", instance_arr);
+  for (auto& s : ships) {
+    res += ship_size_base + s.name.size();
   }
-  
-  {
-    Napi::Array deleted_nums = Napi::Array::New(env);
-    uint64_t i = 0;
-    for (const auto& del : deleted) {
-      deleted_nums[i++] = Napi::Number::New(env, del);
-    }
 
-    obj.Set("deleted", deleted_nums);
-  }
-
-  {
-    Napi::Array deleted_nums = Napi::Array::New(env);
-    uint64_t i = 0;
-    for (const auto& del : deleted_local) {
-      deleted_nums[i++] = Napi::Number::New(env, del);
-    }
-
-    obj.Set("deletedLocal", deleted_nums);
-  }
-
-  {
-    Napi::Number time = Napi::Number::New(env, server_time);
-    obj.Set("serverTime", time);
-  }
-
-  {
-    Napi::Number s = Napi::Number::New(env, score);
-    obj.Set("score", s);
-  }
-
-  return obj;
-  
+  res += collisions.size() * collision_size;
+  res += deltas.size() * instance_size;
+  res += (projectiles.size() + projectiles_local.size()) * projectile_size;
+  res += (deleted.size() + deleted_local.size()) * id_size;
+  res += footer_size;
+  return res;
 }
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,168 @@
+#include <server/SweepAndPrune.hpp>
+#include <server/MemoryStats.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vasteroids {
+namespace server {
+
+SweepAndPrune::SweepAndPrune(int chunk_dims) : stamp_(0), chunk_count_(chunk_dims) {}
+
+void SweepAndPrune::BeginTick() {
+  stamp_++;
+}
+
+void SweepAndPrune::Update(const Asteroid& a) {
+  const double world_size = static_cast<double>(chunk_size) * chunk_count_;
+  auto slot = slots_.find(a.id);
+  uint32_t index;
+  if (slot == slots_.end()) {
+    if (free_.empty()) {
+      index = static_cast<uint32_t>(records_.size());
+      records_.emplace_back();
+    } else {
+      index = free_.back();
+      free_.pop_back();
+    }
+
+    // geometry never changes, so the bounding radius only needs computing once
+    float radius = 0.0f;
+    for (auto& p : a.geometry) {
+      radius = std::max(radius, p.x * p.x + p.y * p.y);
+    }
+
+    records_[index].id = a.id;
+    records_[index].radius = std::sqrt(radius);
+    slots_.insert(std::make_pair(a.id, index));
+    added_.push_back(index);
+  } else {
+    index = slot->second;
+  }
+
+  Record& r = records_[index];
+  double x = static_cast<double>(a.position.chunk.x) * chunk_size + a.position.position.x;
+  r.min_x = x - r.radius;
+  // keep min_x in bounds -- anything crossing the world's edge does so past max_x
+  if (r.min_x < 0.0) {
+    r.min_x += world_size;
+  } else if (r.min_x >= world_size) {
+    r.min_x -= world_size;
+  }
+
+  r.max_x = r.min_x + 2.0 * r.radius;
+  r.y = static_cast<double>(a.position.chunk.y) * chunk_size + a.position.position.y;
+  r.chunk = a.position.chunk;
+  r.stamp = stamp_;
+}
+
+void SweepAndPrune::Prune() {
+  auto stale = [this](uint32_t index) {
+    if (records_[index].stamp == stamp_) {
+      return false;
+    }
+
+    slots_.erase(records_[index].id);
+    free_.push_back(index);
+    return true;
+  };
+
+  auto by_min = [this](uint32_t a, uint32_t b) {
+    return records_[a].min_x < records_[b].min_x;
+  };
+
+  order_.erase(std::remove_if(order_.begin(), order_.end(), stale), order_.end());
+
+  // asteroids move a little each tick, so insertion sort is close to linear here
+  for (size_t i = 1; i < order_.size(); i++) {
+    uint32_t cur = order_[i];
+    size_t j = i;
+    while (j > 0 && by_min(cur, order_[j - 1])) {
+      order_[j] = order_[j - 1];
+      j--;
+    }
+
+    order_[j] = cur;
+  }
+
+  // new records could land anywhere -- sort them on their own and merge them in
+  std::sort(added_.begin(), added_.end(), by_min);
+  size_t mid = order_.size();
+  order_.insert(order_.end(), added_.begin(), added_.end());
+  std::inplace_merge(order_.begin(), order_.begin() + mid, order_.end(), by_min);
+  added_.clear();
+}
+
+bool SweepAndPrune::OverlapY(const Record& a, const Record& b) const {
+  const double world_size = static_cast<double>(chunk_size) * chunk_count_;
+  double dy = std::abs(a.y - b.y);
+  dy = std::min(dy, world_size - dy);
+  return dy <= (a.radius + b.radius);
+}
+
+void SweepAndPrune::FindPairs(std::vector<AsteroidPair>& pairs) {
+  Prune();
+
+  const double world_size = static_cast<double>(chunk_size) * chunk_count_;
+  size_t start = pairs.size();
+  AsteroidPair pair;
+  for (size_t i = 0; i < order_.size(); i++) {
+    const Record& a = records_[order_[i]];
+    for (size_t j = i + 1; j < order_.size(); j++) {
+      const Record& b = records_[order_[j]];
+      if (b.min_x > a.max_x) {
+        break;
+      }
+
+      if (OverlapY(a, b)) {
+        pair.id_a = a.id;
+        pair.chunk_a = a.chunk;
+        pair.id_b = b.id;
+        pair.chunk_b = b.chunk;
+        pairs.push_back(pair);
+      }
+    }
+
+    // bounds which run past the world's edge wrap around to the start of the list
+    if (a.max_x >= world_size) {
+      for (size_t j = 0; j < i; j++) {
+        const Record& b = records_[order_[j]];
+        if (b.min_x > a.max_x - world_size) {
+          break;
+        }
+
+        if (OverlapY(a, b)) {
+          pair.id_a = b.id;
+          pair.chunk_a = b.chunk;
+          pair.id_b = a.id;
+          pair.chunk_b = a.chunk;
+          pairs.push_back(pair);
+        }
+      }
+    }
+  }
+
+  // tiny worlds can report a pair both directly and across the edge
+  auto lower_first = [](const AsteroidPair& p) {
+    return (p.id_a < p.id_b ? std::make_pair(p.id_a, p.id_b) : std::make_pair(p.id_b, p.id_a));
+  };
+
+  std::sort(pairs.begin() + start, pairs.end(), [&](const AsteroidPair& a, const AsteroidPair& b) {
+    return lower_first(a) < lower_first(b);
+  });
+
+  pairs.erase(std::unique(pairs.begin() + start, pairs.end(), [&](const AsteroidPair& a, const AsteroidPair& b) {
+    return lower_first(a) == lower_first(b);
+  }), pairs.end());
+}
+
+size_t SweepAndPrune::size() const {
+  return slots_.size();
+}
+
+size_t SweepAndPrune::GetAllocatedBytes() const {
+  return GetHeapBytes(records_) + GetHeapBytes(free_) + GetHeapBytes(slots_) + GetHeapBytes(order_) + GetHeapBytes(added_);
+}
+
+}
+}
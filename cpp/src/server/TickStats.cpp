@@ -0,0 +1,116 @@
+#include <server/TickStats.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vasteroids {
+namespace server {
+
+// buckets per power of two
+static const int bucket_steps = 8;
+
+// smallest bucket bound, in seconds -- anything below lands in bucket 0
+static const double bucket_min = 1e-7;
+
+// covers 0.1us to ~30 minutes
+static const int bucket_count = 34 * bucket_steps;
+
+RollingHistogram::RollingHistogram(size_t window)
+  : samples_(std::max<size_t>(window, 1), 0.0), next_(0), count_(0), buckets_(bucket_count, 0), sum_(0.0) {}
+
+void RollingHistogram::Record(double seconds) {
+  seconds = std::max(seconds, 0.0);
+  if (count_ == samples_.size()) {
+    double evicted = samples_[next_];
+    buckets_[GetBucket(evicted)]--;
+    sum_ -= evicted;
+  } else {
+    count_++;
+  }
+
+  samples_[next_] = seconds;
+  next_ = (next_ + 1) % samples_.size();
+  buckets_[GetBucket(seconds)]++;
+  sum_ += seconds;
+}
+
+size_t RollingHistogram::GetCount() const {
+  return count_;
+}
+
+double RollingHistogram::GetMean() const {
+  // the running sum drifts a hair with each eviction -- never let it go negative
+  return (count_ == 0 ? 0.0 : std::max(sum_, 0.0) / count_);
+}
+
+double RollingHistogram::GetPercentile(double p) const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+
+  p = std::min(std::max(p, 0.0), 1.0);
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * count_)));
+  uint64_t seen = 0;
+  for (int i = 0; i < bucket_count; i++) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // no bucket reaches past the largest sample -- and the last holds everything too big for the others
+      return (i == bucket_count - 1 ? GetMax() : std::min(GetBucketBound(i), GetMax()));
+    }
+  }
+
+  return GetMax();
+}
+
+double RollingHistogram::GetMax() const {
+  double res = 0.0;
+  for (size_t i = 0; i < count_; i++) {
+    res = std::max(res, samples_[i]);
+  }
+
+  return res;
+}
+
+int RollingHistogram::GetBucket(double seconds) {
+  if (seconds <= bucket_min) {
+    return 0;
+  }
+
+  int bucket = static_cast<int>(std::ceil(std::log2(seconds / bucket_min) * bucket_steps));
+  return std::min(bucket, bucket_count - 1);
+}
+
+double RollingHistogram::GetBucketBound(int bucket) {
+  return bucket_min * std::exp2(static_cast<double>(bucket) / bucket_steps);
+}
+
+TickStats::TickStats(size_t window) : phases_(tick_phase_count, RollingHistogram(window)), total_(window), ticks_(0) {}
+
+void TickStats::Record(const TickTimings& timings, const TickCounts& counts) {
+  for (int i = 0; i < tick_phase_count; i++) {
+    phases_[i].Record(timings.phases[i]);
+  }
+
+  total_.Record(timings.total);
+  last_counts_ = counts;
+  ticks_++;
+}
+
+const RollingHistogram& TickStats::GetPhase(TickPhase phase) const {
+  return phases_[static_cast<int>(phase)];
+}
+
+const RollingHistogram& TickStats::GetTotal() const {
+  return total_;
+}
+
+const TickCounts& TickStats::GetLastCounts() const {
+  return last_counts_;
+}
+
+uint64_t TickStats::GetTickCount() const {
+  return ticks_;
+}
+
+}
+}
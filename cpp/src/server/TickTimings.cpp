@@ -0,0 +1,26 @@
+#include <server/TickTimings.hpp>
+
+namespace vasteroids {
+namespace server {
+
+static const char* phase_names[tick_phase_count] = {
+  "capture",
+  "materialize",
+  "update_chunks",
+  "reinsert",
+  "asteroid_collisions",
+  "collision_build",
+  "compute_collisions",
+  "respawn",
+  "release_chunks",
+  "packets",
+  "to_node"
+};
+
+const char* TickPhaseToString(TickPhase phase) {
+  int index = static_cast<int>(phase);
+  return (index >= 0 && index < tick_phase_count ? phase_names[index] : "unknown");
+}
+
+}
+}
@@ -0,0 +1,186 @@
+#include <server/TraceRecorder.hpp>
+
+namespace vasteroids {
+namespace server {
+
+// how often the flusher wakes to drain the buffers
+static const std::chrono::milliseconds flush_interval(50);
+
+static std::atomic<uint64_t> next_recorder_id(1);
+
+// the buffer this thread last recorded into, and the recorder it belongs to
+struct CachedBuffer {
+  uint64_t recorder = 0;
+  void* buffer = nullptr;
+};
+
+static thread_local CachedBuffer cached_buffer;
+
+std::shared_ptr<TraceRecorder> TraceRecorder::Open(const std::string& path, std::string& error, size_t buffer_events) {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    error = "Could not open trace file " + path;
+    return nullptr;
+  }
+
+  size_t size = 1;
+  while (size < buffer_events) {
+    size <<= 1;
+  }
+
+  return std::shared_ptr<TraceRecorder>(new TraceRecorder(file, size));
+}
+
+TraceRecorder::TraceRecorder(FILE* file, size_t buffer_events)
+  : file_(file), buffer_mask_(buffer_events - 1), epoch_(TraceClock::now()), id_(next_recorder_id++),
+    dropped_(0), wrote_event_(false), stopping_(false) {
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file_);
+  flusher_ = std::thread([this]() { FlushLoop(); });
+}
+
+TraceRecorder::~TraceRecorder() {
+  {
+    std::lock_guard<std::mutex> lock(flush_lock_);
+    stopping_ = true;
+  }
+
+  flush_cv_.notify_one();
+  flusher_.join();
+
+  // anything recorded since the flusher's last pass
+  Drain();
+
+  // thread names go in as metadata events, which can sit anywhere in the trace
+  std::lock_guard<std::mutex> lock(buffers_lock_);
+  for (auto& buffer : buffers_) {
+    if (buffer->name.empty()) {
+      continue;
+    }
+
+    std::fprintf(file_, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 (wrote_event_ ? ",\n" : ""), buffer->tid, buffer->name.c_str());
+    wrote_event_ = true;
+  }
+
+  std::fputs("\n]}\n", file_);
+  std::fclose(file_);
+}
+
+void TraceRecorder::Record(const char* name, TraceClock::time_point start, TraceClock::time_point end,
+                           const char* arg0, int64_t val0, const char* arg1, int64_t val1) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  if (head - buffer->tail.load(std::memory_order_acquire) > buffer_mask_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  TraceEvent& event = buffer->events[head & buffer_mask_];
+  event.name = name;
+  event.start = start;
+  event.end = end;
+  event.arg_names[0] = arg0;
+  event.args[0] = val0;
+  event.arg_names[1] = arg1;
+  event.args[1] = val1;
+
+  // publishes the event to the flusher
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void TraceRecorder::NameThread(const std::string& name) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffers_lock_);
+  buffer->name = name;
+}
+
+uint64_t TraceRecorder::GetDroppedCount() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::GetThreadBuffer() {
+  if (cached_buffer.recorder == id_) {
+    return static_cast<ThreadBuffer*>(cached_buffer.buffer);
+  }
+
+  std::lock_guard<std::mutex> lock(buffers_lock_);
+  std::thread::id self = std::this_thread::get_id();
+  ThreadBuffer* res = nullptr;
+  for (auto& buffer : buffers_) {
+    if (buffer->owner == self) {
+      res = buffer.get();
+      break;
+    }
+  }
+
+  if (res == nullptr) {
+    buffers_.emplace_back(new ThreadBuffer());
+    res = buffers_.back().get();
+    res->owner = self;
+    res->tid = static_cast<uint32_t>(buffers_.size());
+    res->events.resize(buffer_mask_ + 1);
+    res->head.store(0);
+    res->tail.store(0);
+  }
+
+  cached_buffer.recorder = id_;
+  cached_buffer.buffer = res;
+  return res;
+}
+
+void TraceRecorder::Drain() {
+  // buffers are never removed, so the pointers stay good once the lock is released
+  std::vector<ThreadBuffer*> buffers;
+  {
+    std::lock_guard<std::mutex> lock(buffers_lock_);
+    for (auto& buffer : buffers_) {
+      buffers.push_back(buffer.get());
+    }
+  }
+
+  for (ThreadBuffer* buffer : buffers) {
+    uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    for (; tail < head; tail++) {
+      WriteEvent(buffer->tid, buffer->events[tail & buffer_mask_]);
+    }
+
+    // hands the slots back to the recording thread
+    buffer->tail.store(tail, std::memory_order_release);
+  }
+
+  std::fflush(file_);
+}
+
+void TraceRecorder::WriteEvent(uint32_t tid, const TraceEvent& event) {
+  // trace-event times are in microseconds
+  double ts = std::chrono::duration<double, std::micro>(event.start - epoch_).count();
+  double dur = std::chrono::duration<double, std::micro>(event.end - event.start).count();
+  std::fprintf(file_, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+               (wrote_event_ ? ",\n" : ""), event.name, tid, ts, dur);
+  wrote_event_ = true;
+
+  if (event.arg_names[0] != nullptr) {
+    std::fprintf(file_, ",\"args\":{\"%s\":%" PRId64, event.arg_names[0], event.args[0]);
+    if (event.arg_names[1] != nullptr) {
+      std::fprintf(file_, ",\"%s\":%" PRId64, event.arg_names[1], event.args[1]);
+    }
+
+    std::fputc('}', file_);
+  }
+
+  std::fputc('}', file_);
+}
+
+void TraceRecorder::FlushLoop() {
+  std::unique_lock<std::mutex> lock(flush_lock_);
+  while (!stopping_) {
+    flush_cv_.wait_for(lock, flush_interval);
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+}
+
+}
+}
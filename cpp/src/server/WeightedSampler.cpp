@@ -0,0 +1,100 @@
+#include <server/WeightedSampler.hpp>
+#include <server/MemoryStats.hpp>
+
+namespace vasteroids {
+namespace server {
+
+WeightedSampler::WeightedSampler(size_t count) : weights_(count, 0.0), tree_(count + 1, 0.0), top_bit_(1), updates_(0) {
+  while (top_bit_ * 2 <= count) {
+    top_bit_ *= 2;
+  }
+}
+
+void WeightedSampler::Build(const std::vector<double>& weights) {
+  weights_ = weights;
+  weights_.resize(tree_.size() - 1, 0.0);
+  Rebuild();
+}
+
+void WeightedSampler::SetWeight(size_t index, double weight) {
+  double delta = weight - weights_[index];
+  if (delta == 0.0) {
+    return;
+  }
+
+  weights_[index] = weight;
+  // every update leaves a bit of rounding error in the sums -- rebuild once per n updates to keep it bounded
+  if (++updates_ >= weights_.size()) {
+    Rebuild();
+    return;
+  }
+
+  for (size_t i = index + 1; i < tree_.size(); i += (i & (~i + 1))) {
+    tree_[i] += delta;
+  }
+}
+
+double WeightedSampler::GetWeight(size_t index) const {
+  return weights_[index];
+}
+
+double WeightedSampler::GetTotal() const {
+  double total = 0.0;
+  for (size_t i = tree_.size() - 1; i > 0; i -= (i & (~i + 1))) {
+    total += tree_[i];
+  }
+
+  return total;
+}
+
+size_t WeightedSampler::Sample(double u) const {
+  if (weights_.empty()) {
+    return 0;
+  }
+
+  double target = u * GetTotal();
+  // walk down the implicit tree, skipping every block whose sum falls at or below the target
+  size_t pos = 0;
+  for (size_t step = top_bit_; step > 0; step >>= 1) {
+    size_t next = pos + step;
+    if (next < tree_.size() && tree_[next] <= target) {
+      pos = next;
+      target -= tree_[next];
+    }
+  }
+
+  // `pos` weights lie below the target, so the sample is the next one.
+  // rounding can push us off the end -- settle for the last index with any weight.
+  while (pos >= weights_.size() || (weights_[pos] <= 0.0 && pos > 0)) {
+    pos--;
+  }
+
+  return pos;
+}
+
+size_t WeightedSampler::size() const {
+  return weights_.size();
+}
+
+size_t WeightedSampler::GetAllocatedBytes() const {
+  return GetHeapBytes(weights_) + GetHeapBytes(tree_);
+}
+
+void WeightedSampler::Rebuild() {
+  for (size_t i = 1; i < tree_.size(); i++) {
+    tree_[i] = weights_[i - 1];
+  }
+
+  // push each partial sum up to its parent
+  for (size_t i = 1; i < tree_.size(); i++) {
+    size_t parent = i + (i & (~i + 1));
+    if (parent < tree_.size()) {
+      tree_[parent] += tree_[i];
+    }
+  }
+
+  updates_ = 0;
+}
+
+}
+}
@@ -0,0 +1,1865 @@
+#include <server/World.hpp>
+
+#include <AsteroidCollider.hpp>
+#include <AsteroidGenerator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace vasteroids {
+namespace server {
+
+using client::ClientPacket;
+
+// seconds after (re)spawning during which a ship can't be destroyed -- matches the client
+static const double invuln_time = 3.0;
+
+// width of a biome tile, in chunks -- matches BIOME_TILE_SIZE on the TS side
+static const int biome_tile_size = 32;
+
+// bytes per chunk in an encoded biome tile: u16 x, u16 y, u8 biome
+static const int biome_entry_size = 5;
+
+// "VREC" -- identifies an input recording
+static const uint32_t recording_magic = 0x43455256;
+static const uint32_t recording_version = 1;
+
+// "VSNP" -- identifies a world snapshot
+static const uint32_t snapshot_magic = 0x504E5356;
+static const uint32_t snapshot_version = 1;
+
+// "VCAP" -- identifies a slow tick capture
+static const uint32_t capture_magic = 0x50414356;
+static const uint32_t capture_version = 1;
+
+std::unique_ptr<World> World::Create(int chunk_dims, int asteroids, const WorldOptions& options, std::string& error) {
+  std::shared_ptr<Clock> clock = options.clock;
+  if (!clock) {
+    clock = std::make_shared<SystemClock>();
+  }
+
+  std::unique_ptr<World> world(new World(chunk_dims, std::move(clock)));
+  world->persist_path_ = options.persist_path;
+
+  // started first, so that generation is traced too
+  if (!options.trace_path.empty() && !world->StartTrace(options.trace_path, error)) {
+    return nullptr;
+  }
+
+  // a slow tick's capture holds the world it started from
+  if (!options.slow_tick_replay_path.empty()) {
+    if (!world->ReplaySlowTick(options.slow_tick_replay_path, error)) {
+      return nullptr;
+    }
+
+    return world;
+  }
+
+  // a replay rebuilds whatever world its recording started from
+  if (!options.replay_path.empty()) {
+    if (!world->ReplayRecording(options.replay_path, error)) {
+      return nullptr;
+    }
+  } else {
+    world->SetUpWorld(chunk_dims);
+
+    // a persisted world picks up where it left off
+    bool restored = (!world->persist_path_.empty() && world->RestoreWorld(error));
+    if (!error.empty()) {
+      return nullptr;
+    }
+
+    if (!restored) {
+      if (options.has_seed) {
+        world->seed_ = options.seed;
+      } else {
+        // keep it within a double's precision, so the seed can be handed back to JS and reused
+        std::random_device dev;
+        world->seed_ = ((static_cast<uint64_t>(dev()) << 32) | dev()) & ((1ULL << 53) - 1);
+      }
+
+      world->GenerateWorld(asteroids, options.eager);
+
+      // recordings start from a freshly generated world, so that the seed and settings are all it takes to rebuild it
+      if (!options.record_path.empty()) {
+        world->StartRecording(options.record_path, asteroids, options.eager);
+      }
+    }
+  }
+
+  if (!world->persist_path_.empty()) {
+    world->StartPersistence();
+  }
+
+  if (options.slow_tick_threshold > 0.0) {
+    if (options.slow_tick_dir.empty() || options.slow_tick_window <= 0) {
+      error = "Slow tick capture needs a directory, and a window of at least one tick!";
+      return nullptr;
+    }
+
+    world->slow_tick_threshold_ = options.slow_tick_threshold;
+    world->slow_tick_dir_ = options.slow_tick_dir;
+    world->slow_tick_window_ = options.slow_tick_window;
+
+    // windows share chunks' encodings -- make them now, rather than in the first window's tick
+    for (auto& chunk : world->chunks_) {
+      chunk.second.Encode();
+    }
+  }
+
+  return world;
+}
+
+World::World(int chunk_dims, std::shared_ptr<Clock> clock) : chunk_dims_(chunk_dims), clock_(std::move(clock)) {
+  now_ = 0.0;
+  id_max_ = 1;
+  generation_ = 0;
+  seed_ = 0;
+  biome_tile_dims_ = 0;
+  slow_tick_threshold_ = 0.0;
+  slow_tick_window_ = 0;
+  tick_count_ = 0;
+  window_captured_ = false;
+  window_pending_ = false;
+  replay_packets_ = false;
+  coord_gen = std::uniform_real_distribution<float>(0.0f, chunk_size);
+  velo_gen = std::uniform_real_distribution<float>(-1.8f, 1.8f);
+}
+
+void World::SetUpWorld(int chunk_dims) {
+  chunk_dims_ = chunk_dims;
+  cw_ = std::make_shared<CollisionWorld>(chunk_dims_);
+  sweep_ = std::make_shared<SweepAndPrune>(chunk_dims_);
+
+  biome_tile_dims_ = (chunk_dims_ + biome_tile_size - 1) / biome_tile_size;
+}
+
+void World::GenerateWorld(int asteroids, bool eager) {
+  rng_ = RandomStream(seed_, RandomPurpose::WORLD);
+
+  // pot. costly, but then again we only really have to do it once
+  mgr = std::make_shared<BiomeManager>(chunk_dims_, ((chunk_dims_ * chunk_dims_) / 36), seed_);
+
+  // asteroids aren't generated until their chunk is first touched -- see MaterializeChunk.
+  // until then, each chunk counts as holding its share.
+  asteroid_count_ = 0;
+  asteroid_min_ = asteroids;
+  unmaterialized_share_ = asteroids;
+  all_materialized_ = false;
+  mgr->SetAsteroidTarget(asteroid_min_);
+
+  // or generate the whole world now, if we'd rather pay for it up front
+  if (eager) {
+    BootstrapWorld();
+  }
+}
+
+int World::GetChunkDims() const {
+  return chunk_dims_;
+}
+
+bool World::HasShip(uint64_t id) const {
+  return ships_.count(id) > 0;
+}
+
+bool World::HandleClientPacket(ClientPacket& packet) {
+  if (!ships_.count(packet.client_ship.id)) {
+    return false;
+  }
+
+  now_ = clock_->Now();
+  if (IsLogging()) {
+    BinaryWriter entry = StartLogEntry(LogEntryType::CLIENT_PACKET);
+    Write(entry, packet.client_ship);
+    entry.Put<uint32_t>(static_cast<uint32_t>(packet.projectiles.size()));
+    for (auto& proj : packet.projectiles) {
+      Write(entry, proj);
+    }
+
+    LogInput(entry);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  bool res = HandleClientPacket_(packet);
+  ShipCost& cost = ship_costs_[packet.client_ship.id];
+  cost.input_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  cost.projectiles += (res ? packet.projectiles.size() : 0);
+  return res;
+}
+
+bool World::HandleClientPacket_(ClientPacket& packet) {
+  // find old ship record
+  auto ship_old = ships_.find(packet.client_ship.id);
+  if (ship_old == ships_.end()) {
+    return false;
+  }
+
+  Point2D<int> chunk = ship_old->second;
+
+  // ships might enter chunks which have yet to be occupied
+  auto c = chunks_.find(chunk);
+  if (c == chunks_.end()) {
+    return false;
+  }
+
+  auto& ship_new = packet.client_ship;
+
+  {
+    // update ver number
+    // we're grabbing this ship from the chunk we *think* has it
+    // but that chunk has since moved
+    Ship* ship_last = c->second.GetShip(packet.client_ship.id);
+    ship_new.ver = ship_last->ver + 1;
+    // update score lole
+    ship_new.score = ship_last->score;
+    // the server decides when ships are destroyed, not the client
+    ship_new.destroyed = ship_last->destroyed;
+    ship_new.lives = ship_last->lives;
+    ship_new.spawn_time = ship_last->spawn_time;
+  }
+  
+  // remove old ship from old chunk
+  // differentiate from deletion :(
+  c->second.MoveShip(packet.client_ship.id);
+
+  CorrectChunk(ship_new);
+  Point2D<int> new_chunk = ship_new.position.chunk;
+
+  if (chunks_.find(new_chunk) == chunks_.end()) {
+    CreateChunk(new_chunk);
+  }
+
+  ship_new.last_update = GetServerTime_();
+  chunks_.at(new_chunk).InsertShip(ship_new);
+
+  // update ships list to match new chunk
+  ships_.erase(ship_new.id);
+  ships_.insert(std::make_pair(ship_new.id, new_chunk));
+  if (!(new_chunk == chunk)) {
+    ReleaseChunksAround(chunk);
+  }
+
+  // if the ship is destroyed, we should start ignoring these
+  if (packet.projectiles.size() > 4) {
+    std::cout << "something funny is going on" << std::endl;
+  }
+  for (auto& proj : packet.projectiles) {
+    HandleNewProjectile(packet.client_ship.id, proj);
+  }
+
+  return true;
+}
+
+void World::CorrectChunk(Instance& inst) {
+  Point2D<int> new_chunk = inst.position.chunk;
+  if (new_chunk.x < 0 || new_chunk.x >= chunk_dims_
+  ||  new_chunk.y < 0 || new_chunk.y >= chunk_dims_) {
+    // scoop it back around back in bounds
+    new_chunk.x -= (chunk_dims_ * static_cast<int>(std::floor(new_chunk.x / static_cast<double>(chunk_dims_))));
+    new_chunk.y -= (chunk_dims_ * static_cast<int>(std::floor(new_chunk.y / static_cast<double>(chunk_dims_))));
+  }
+
+  inst.position.chunk = new_chunk;
+}
+
+
+
+void World::DestroyShip(Ship& ship, Point2D<int> chunk) {
+  ship.destroyed = true;
+  ship.ver++;
+
+  Collision c;
+  c.id = id_max_++;
+  c.creation_time = GetServerTime_();
+  c.velocity.x = 0;
+  c.velocity.y = 0;
+  c.position = ship.position;
+  c.rotation = 0;
+  c.rotation_velocity = 0;
+  c.last_update = GetServerTime_();
+  c.origin_time = GetServerTime_() - coord_gen(rng_) / 8.0f;
+  chunks_.at(chunk).InsertCollision(c);
+}
+
+void World::HandleNewProjectile(uint64_t ship_id, Projectile& proj) {
+  CorrectChunk(proj);
+  proj.id = id_max_++;
+  proj.ship_ID = ship_id;
+  proj.origin_time = GetServerTime_() - coord_gen(rng_) / 8.0f;
+  // creation time is subject to client lag :(
+  proj.creation_time = GetServerTime_();
+  new_projectiles_.at(ship_id).insert(proj.client_ID);
+  Point2D<int> new_chunk = proj.position.chunk;
+  if (chunks_.find(new_chunk) == chunks_.end()) {
+    CreateChunk(new_chunk);
+  }
+
+  chunks_.at(new_chunk).InsertProjectile(proj);
+}
+
+Point2D<float> World::GetDistance(WorldPosition a, WorldPosition b) {
+  Point2D<int> chunkDist{b.chunk.x - a.chunk.x, b.chunk.y - a.chunk.y};
+  Point2D<float> posDist{b.position.x - a.position.x, b.position.y - a.position.y};
+
+  posDist.x += (chunkDist.x * chunk_size);
+  posDist.y += (chunkDist.y * chunk_size);
+
+  if (posDist.x > (chunk_size * chunk_dims_) / 2) {
+    posDist.x -= (chunk_size * chunk_dims_);
+  } else if (posDist.x < -(chunk_size * chunk_dims_) / 2) {
+    posDist.x += (chunk_size * chunk_dims_);
+  }
+
+  if (posDist.y > (chunk_size * chunk_dims_) / 2) {
+    posDist.y -= (chunk_size * chunk_dims_);
+  } else if (posDist.y < -(chunk_size * chunk_dims_) / 2) {
+    posDist.y += (chunk_size * chunk_dims_);
+  }
+
+  return posDist;
+}
+
+FlatHashSet<Point2D<int>> World::GetActiveChunks() {
+  FlatHashSet<Point2D<int>> res;
+  for (auto ship : ships_) {
+    for (int x = ship.second.x - 1; x <= ship.second.x + 1; x++) {
+      for (int y = ship.second.y - 1; y <= ship.second.y + 1; y++) {
+        Point2D<int> chunk(x, y);
+        FixChunkBoundaries(chunk);
+
+        res.insert(chunk);
+      }
+    }
+  }
+
+  return res;
+}
+
+void World::ReinsertInstances(ServerPacket& collate, const FlatHashSet<Point2D<int>>& update_chunks) {
+  double server_time = GetServerTime_();
+  for (auto a : collate.asteroids) {
+    FixChunkBoundaries(a.position.chunk);
+    Point2D<int> chunk_coord = a.position.chunk;
+    // we need to fix the chunk
+    if (!chunks_.count(chunk_coord)) {
+      CreateChunk(chunk_coord);
+    }
+
+    a.last_update = server_time;
+    chunks_.at(chunk_coord).InsertAsteroid(a);
+  }
+
+  for (auto s : collate.ships) {
+    FixChunkBoundaries(s.position.chunk);
+    Point2D<int> chunk_coord = s.position.chunk;
+    if (!chunks_.count(chunk_coord)) {
+      CreateChunk(chunk_coord);
+    }
+
+    s.last_update = server_time;
+    chunks_.at(chunk_coord).InsertShip(s);
+    // handle ships which have been moved!
+    // does not quantify an update yet, so do not adjust ver number
+    ships_.erase(s.id);
+    ships_.insert(std::make_pair(s.id, chunk_coord));
+  }
+
+  for (auto p : collate.projectiles) {
+    FixChunkBoundaries(p.position.chunk);
+    Point2D<int> chunk_coord = p.position.chunk;
+    // no one can see it, and nothing would expire it
+    if (!update_chunks.count(chunk_coord)) {
+      continue;
+    }
+
+    if (!chunks_.count(chunk_coord)) {
+      CreateChunk(chunk_coord);
+    }
+
+    p.last_update = server_time;
+    chunks_.at(chunk_coord).InsertProjectile(p);
+  }
+}
+
+void World::CollideAsteroids(const FlatHashSet<Point2D<int>>& update_chunks) {
+  std::vector<Asteroid*> asteroids;
+  for (auto point : update_chunks) {
+    if (!chunks_.count(point)) {
+      continue;
+    }
+
+    chunks_.at(point).GetAsteroids(asteroids);
+  }
+
+  sweep_->BeginTick();
+  for (auto* a : asteroids) {
+    sweep_->Update(*a);
+  }
+
+  std::vector<AsteroidPair> pairs;
+  sweep_->FindPairs(pairs);
+  for (auto& pair : pairs) {
+    Asteroid* a = chunks_.at(pair.chunk_a).GetAsteroid(pair.id_a);
+    Asteroid* b = chunks_.at(pair.chunk_b).GetAsteroid(pair.id_b);
+    if (a == nullptr || b == nullptr || !Collide(*a, *b, chunk_dims_)) {
+      continue;
+    }
+
+    BounceAsteroids(*a, *b, chunk_dims_);
+  }
+}
+
+void World::UpdateSim(FlatHashMap<uint64_t, ServerPacket>* packets) {
+  now_ = clock_->Now();
+  // windows start between ticks, so that a capture can begin from a clean state.
+  // the state itself is copied once the tick is under way, so that its cost is timed with the tick
+  if (IsCapturing() && tick_count_ % slow_tick_window_ == 0) {
+    window_inputs_.clear();
+    window_captured_ = false;
+    window_pending_ = true;
+  }
+
+  if (IsLogging()) {
+    BinaryWriter entry = StartLogEntry(LogEntryType::UPDATE_SIM);
+    LogInput(entry);
+    // once per tick -- a crash loses at most the tick in flight
+    log_.Flush();
+    recording_.Flush();
+  }
+
+  UpdateSim_(packets);
+  tick_count_++;
+
+  if (IsCapturing() && last_tick_.total > slow_tick_threshold_) {
+    CaptureSlowTick();
+  }
+}
+
+void World::UpdateSim_(FlatHashMap<uint64_t, ServerPacket>* packets) {
+  // update all components
+  // figure out which chunks we need to update
+  TraceRecorder* trace = trace_.get();
+  TraceSpan tick_span(trace, "tick");
+  TickTimer timer(last_tick_, trace);
+  if (window_pending_) {
+    StartCaptureWindow();
+    window_pending_ = false;
+  }
+
+  timer.Next(TickPhase::CAPTURE);
+
+  double server_time = GetServerTime_();
+  FlatHashSet<Point2D<int>> update_chunks = GetActiveChunks();
+  for (auto point : update_chunks) {
+    MaterializeChunk(point);
+  }
+
+  timer.Next(TickPhase::MATERIALIZE);
+
+  ServerPacket collate;
+
+  // it would be nice to keep these outskirt chunks updated, but there is no reliable way to do it
+  // maybe push it onto a separate thread?
+
+  // create a component which scours our chunk list and just updates one whenever it can
+  // aim for an update rate of ~1 / sec
+  // caveat: we have to put a lock on each chunk
+  // no collision testing, just updates.
+  for (auto point : update_chunks) {
+    if (!chunks_.count(point)) {
+      // chunk currently contains no items -- do not update it.
+      continue;
+    }
+
+    TraceSpan span(trace, "update_chunk", "x", point.x, "y", point.y);
+    chunks_.at(point).UpdateChunk(collate, server_time);
+  }
+
+  timer.Next(TickPhase::UPDATE_CHUNKS);
+  ReinsertInstances(collate, update_chunks);
+  timer.Next(TickPhase::REINSERT);
+
+  CollideAsteroids(update_chunks);
+  timer.Next(TickPhase::ASTEROID_COLLISIONS);
+
+  cw_->clear();
+
+  // projectiles drive the collision pass -- asteroids are only fed in near their paths
+  std::vector<Projectile> projectiles;
+  for (auto point : update_chunks) {
+    if (!chunks_.count(point)) {
+      continue;
+    }
+
+    chunks_.at(point).GetProjectiles(projectiles);
+  }
+
+  for (auto& p : projectiles) {
+    cw_->AddProjectile(p);
+    // we need to update this collision delta :(
+    // we insert a copy though, so it's OK to do here.
+    chunks_.at(p.position.chunk).GetProjectile(p.id)->last_collision_delta = p.last_update;
+    chunks_.at(p.position.chunk).GetProjectile(p.id)->origin = p.position;
+  }
+
+  // ships share the projectile broadphase -- freshly spawned ships are invulnerable for a bit
+  for (auto& ship : ships_) {
+    Ship* s = chunks_.at(ship.second).GetShip(ship.first);
+    if (s->destroyed || (server_time - s->spawn_time) < invuln_time) {
+      continue;
+    }
+
+    cw_->AddShip(*s);
+  }
+
+  std::vector<Asteroid> asteroids;
+  for (auto point : update_chunks) {
+    // quiet chunks cost nothing
+    if (!chunks_.count(point) || !cw_->IsChunkRelevant(point)) {
+      continue;
+    }
+
+    chunks_.at(point).GetAsteroids(asteroids);
+  }
+
+  for (auto& a : asteroids) {
+    cw_->AddAsteroid(a);
+  }
+
+  timer.Next(TickPhase::COLLISION_BUILD);
+
+  FlatHashMap<uint64_t, Point2D<int>> deleted;
+  std::vector<std::pair<WorldPosition, float>> collide_pos;
+  std::vector<uint64_t> destroyed_ships;
+
+  auto client_map = cw_->ComputeCollisions(deleted, collide_pos, destroyed_ships);
+  for (auto& del : deleted) {
+    Projectile* proj = chunks_.at(del.second).GetProjectile(del.first);
+    if (proj) {
+      uint64_t client = proj->ship_ID;
+      if (ships_.count(client)) {
+        Point2D<int> pt = ships_.at(client);
+        chunks_.at(pt).GetShip(client)->score += 10;
+      }
+    } else if (chunks_.at(del.second).GetAsteroid(del.first)) {
+      asteroid_count_--;
+    }
+
+    chunks_.at(del.second).RemoveInstance(del.first);
+  }
+
+  for (auto id : destroyed_ships) {
+    Point2D<int> chunk = ships_.at(id);
+    DestroyShip(*chunks_.at(chunk).GetShip(id), chunk);
+  }
+
+  for (auto& pos : collide_pos) {
+    SpawnNewAsteroid(pos.first, pos.second, 12);
+    SpawnNewAsteroid(pos.first, pos.second, 12);
+    asteroid_count_ += 2;
+  }
+
+  timer.Next(TickPhase::COMPUTE_COLLISIONS);
+
+  // only simulated chunks change their asteroid counts
+  for (auto point : update_chunks) {
+    if (chunks_.count(point)) {
+      mgr->UpdateChunkCrowding(point, static_cast<int>(chunks_.at(point).GetAsteroidCount()));
+    }
+  }
+
+  WorldPosition temp;
+  // the share is a sum of fractions -- round it, so drift never costs or gains an asteroid
+  while (asteroid_count_ + std::lround(unmaterialized_share_) < asteroid_min_) {
+    temp.chunk = mgr->GetRandomChunk();
+    temp.position.x = coord_gen(rng_);
+    temp.position.y = coord_gen(rng_);
+
+    SpawnNewAsteroid(temp);
+    asteroid_count_++;
+    mgr->UpdateChunkCrowding(temp.chunk, static_cast<int>(chunks_.at(temp.chunk).GetAsteroidCount()));
+  }
+
+  timer.Next(TickPhase::RESPAWN);
+
+  ReleaseUnwatchedChunks(update_chunks);
+  timer.Next(TickPhase::RELEASE_CHUNKS);
+
+  last_counts_.chunks = static_cast<int>(chunks_.size());
+  last_counts_.active_chunks = static_cast<int>(update_chunks.size());
+  last_counts_.asteroids = asteroid_count_;
+  last_counts_.ships = static_cast<int>(ships_.size());
+  last_counts_.projectiles = static_cast<int>(projectiles.size());
+  last_counts_.packets = 0;
+
+  // lastly, we need to figure out which entities to expose to which instances
+  // replay has no one to send them to
+  if (packets == nullptr) {
+    timer.Next(TickPhase::PACKETS);
+    return;
+  }
+
+  // note: we can really easily multithread this  
+  for (auto& ship : ships_) {
+    uint64_t id = ship.first;
+    TraceSpan span(trace, "ship_packet", "ship", static_cast<int64_t>(id));
+    auto ship_start = std::chrono::steady_clock::now();
+    FlatHashMap<uint64_t, uint32_t>& knowns = known_ids_.at(id);
+
+    FlatHashMap<uint64_t, uint32_t> knowns_new;
+    
+    ServerPacket res;
+    FlatHashSet<Point2D<int>> chunks_read;
+    for (int x = ship.second.x - 1; x <= ship.second.x + 1; x++) {
+      for (int y = ship.second.y - 1; y <= ship.second.y + 1; y++) {
+        Point2D<int> chunk(x, y);
+        FixChunkBoundaries(chunk);
+        if (chunks_read.count(chunk)) {
+          continue;
+        }
+
+        chunks_read.insert(chunk);
+
+        // chunk does not contain anything
+        if (!chunks_.count(chunk)) {
+          continue;
+        }
+
+        chunks_.at(chunk).GetContents(res);
+      }
+    }
+
+    size_t scanned = res.asteroids.size() + res.projectiles.size() + res.ships.size() + res.collisions.size();
+
+    Instance delta_pkt;
+    // res now contains all nearby objects -- trim it down based on `knowns`
+    int asteroid_count = 0;
+    auto itr_a = res.asteroids.begin();
+    while (itr_a != res.asteroids.end()) {
+      if (deleted.count(itr_a->id)) {
+        // delete immediately!
+        res.deleted.insert(itr_a->id);
+        itr_a = res.asteroids.erase(itr_a);
+        continue;
+      }
+
+      knowns_new.insert(std::make_pair(itr_a->id, itr_a->ver));
+      if (knowns.count(itr_a->id)) {
+        if (knowns.at(itr_a->id) != itr_a->ver) {
+          delta_pkt.id = itr_a->id;
+          delta_pkt.position = itr_a->position;
+          delta_pkt.velocity = itr_a->velocity;
+          delta_pkt.rotation = itr_a->rotation;
+          delta_pkt.rotation_velocity = itr_a->rotation_velocity;
+          delta_pkt.last_update = itr_a->last_update;
+          res.deltas.push_back(std::move(delta_pkt));
+        }
+
+        itr_a = res.asteroids.erase(itr_a);
+      } else {
+        // worry about new asteroids only
+        if (asteroid_count > 32) {
+          // erase it anyway
+          // remove it from knowns
+          knowns_new.erase(itr_a->id);
+          itr_a = res.asteroids.erase(itr_a);
+        } else {
+          asteroid_count++;
+          itr_a++;
+        }
+      }
+    }
+
+    auto* proj_new = &new_projectiles_.at(id);
+    auto itr_p = res.projectiles.begin();
+    while (itr_p != res.projectiles.end()) {
+      if (deleted.count(itr_p->id)) {
+        res.deleted.insert(itr_p->id);
+        if (proj_new->count(itr_p->client_ID) && itr_p->ship_ID == id) {
+          res.deleted_local.insert(itr_p->client_ID);
+        }
+        itr_p = res.projectiles.erase(itr_p);
+        continue;
+      }
+      if (proj_new->count(itr_p->client_ID) && itr_p->ship_ID == id) {
+        res.projectiles_local.push_back(*itr_p);
+        proj_new->erase(itr_p->client_ID);
+        itr_p = res.projectiles.erase(itr_p);
+        continue;
+      }
+      // we have sent this projectile before
+      if (knowns.count(itr_p->id)) {
+        if (knowns.at(itr_p->id) != itr_p->ver) {
+          delta_pkt.id = itr_p->id;
+          delta_pkt.position = itr_p->position;
+          delta_pkt.velocity = itr_p->velocity;
+          delta_pkt.rotation = itr_p->rotation;
+          delta_pkt.rotation_velocity = itr_p->rotation_velocity;
+          delta_pkt.last_update = itr_p->last_update;
+          res.deltas.push_back(std::move(delta_pkt));
+        }
+
+        itr_p = res.projectiles.erase(itr_p);
+      } else {
+        itr_p++;
+      }
+    }
+    
+    auto itr_s = res.ships.begin();
+    while (itr_s != res.ships.end()) {
+      if (itr_s->id == id) {
+        itr_s = res.ships.erase(itr_s);
+      } else {
+        itr_s++;
+      }
+    }
+
+    auto itr_c = res.collisions.begin();
+    while (itr_c != res.collisions.end()) {
+      knowns_new.insert(std::make_pair(itr_c->id, itr_c->ver));
+      if (knowns.count(itr_c->id)) {
+        if (knowns.at(itr_c->id) != itr_c->ver) {
+          delta_pkt.id = itr_c->id;
+          delta_pkt.position = itr_c->position;
+          delta_pkt.velocity = itr_c->velocity;
+          delta_pkt.rotation = itr_c->rotation;
+          delta_pkt.rotation_velocity = itr_c->rotation_velocity;
+          delta_pkt.last_update = itr_c->last_update;
+          res.deltas.push_back(std::move(delta_pkt));
+        }
+
+        itr_c = res.collisions.erase(itr_c);
+      } else {
+        itr_c++;
+      }
+    }
+
+    res.server_time = server_time;
+    if (client_map.count(id)) {
+      for (auto& pr : client_map.at(id)) {
+        res.deleted_local.insert(pr);
+      }
+    }
+
+    res.score = chunks_.at(ship.second).GetShip(id)->score;
+    res.destroyed = chunks_.at(ship.second).GetShip(id)->destroyed;
+
+    // everything in knowns which is not in knowns_new should be marked as deleted -- either it's out of scope, or completely gone.
+    for (auto& id : knowns) {
+      if (!knowns_new.count(id.first)) {
+        res.deleted.insert(id.first);
+      }
+    }
+    knowns = std::move(knowns_new);
+
+    ShipCost& cost = ship_costs_[id];
+    cost.chunk = ship.second;
+    cost.ticks++;
+    cost.scanned += scanned;
+    cost.deltas += res.deltas.size();
+    cost.bytes += res.GetEncodedSize();
+    cost.last_fanout_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - ship_start).count();
+    cost.fanout_time += cost.last_fanout_time;
+    packets->insert(std::make_pair(id, std::move(res)));
+  }
+
+  last_counts_.packets = static_cast<int>(packets->size());
+  timer.Next(TickPhase::PACKETS);
+}
+
+Ship* World::RespawnShip(uint64_t id) {
+  if (!ships_.count(id)) {
+    // bad id!
+    return nullptr;
+  }
+
+  now_ = clock_->Now();
+  if (IsLogging()) {
+    BinaryWriter entry = StartLogEntry(LogEntryType::RESPAWN_SHIP);
+    entry.Put(id);
+    LogInput(entry);
+  }
+
+  return RespawnShip_(id);
+}
+
+Ship* World::RespawnShip_(uint64_t id) {
+  auto chunk = ships_.find(id);
+  if (chunk == ships_.end()) {
+    return nullptr;
+  }
+
+  Ship* s = chunks_.at(chunk->second).GetShip(id);
+  // repeated requests shouldn't cost extra lives
+  if (!s->destroyed) {
+    return s;
+  }
+
+  if (s->lives == 0) {
+    return nullptr;
+  }
+
+  s->lives--;
+  s->destroyed = false;
+  s->ver++;
+  s->spawn_time = GetServerTime_();
+  s->last_update = GetServerTime_();
+  return s;
+}
+
+Point2D<int> World::GetSpawnChunk() {
+  // ships cluster around the middle of the world
+  Point2D<int> res;
+  do {
+    res.x = static_cast<int>(rng_.NextGaussian(chunk_dims_ / 2.0, chunk_dims_ / 4.0));
+    res.y = static_cast<int>(rng_.NextGaussian(chunk_dims_ / 2.0, chunk_dims_ / 4.0));
+  } while (res.x < 0 || res.x >= chunk_dims_
+        || res.y < 0 || res.y >= chunk_dims_);
+
+  return res;
+}
+
+void World::SpawnShip(Ship& s) {
+  s.position.chunk = GetSpawnChunk();
+  if (!chunks_.count(s.position.chunk)) {
+    CreateChunk(s.position.chunk);
+  }
+
+  s.position.position.x = coord_gen(rng_);
+  s.position.position.y = coord_gen(rng_);
+
+  s.velocity = {0.0f, 0.0f};
+  s.rotation = 0.0f;
+  s.rotation_velocity = 0.0f;
+  s.last_update = GetServerTime_();
+  // the client will un-destroy the ship
+  // if we fix it now, something will desync
+}
+
+Ship* World::AddShip(const std::string& name) {
+  now_ = clock_->Now();
+  if (IsLogging()) {
+    BinaryWriter entry = StartLogEntry(LogEntryType::ADD_SHIP);
+    entry.PutString(name);
+    LogInput(entry);
+  }
+
+  return AddShip_(name);
+}
+
+Ship* World::AddShip_(const std::string& name) {
+  Ship s;
+  s.name = name;
+  // find a random position for it to roam
+  SpawnShip(s);
+  s.id = id_max_++;
+  s.ver = 0;
+  s.score = 0;
+  s.origin_time = GetServerTime_() - coord_gen(rng_) / 8.0f;
+
+  s.lives = 3;
+  s.destroyed = false;
+  s.spawn_time = GetServerTime_();
+
+  // add entries for our new ship
+  new_projectiles_.insert(std::make_pair(s.id, FlatHashSet<uint64_t>()));
+  ships_.insert(std::make_pair(s.id, s.position.chunk));
+  known_ids_.insert(std::make_pair(s.id, FlatHashMap<uint64_t, uint32_t>()));
+  ship_costs_[s.id].id = s.id;
+  Chunk& c = chunks_.at(s.position.chunk);
+  c.InsertShip(s);
+  return c.GetShip(s.id);
+}
+
+bool World::DeleteShip(uint64_t id) {
+  if (!ships_.count(id)) {
+    return false;
+  }
+
+  now_ = clock_->Now();
+  if (IsLogging()) {
+    BinaryWriter entry = StartLogEntry(LogEntryType::DELETE_SHIP);
+    entry.Put(id);
+    LogInput(entry);
+  }
+
+  return DeleteShip_(id);
+}
+
+bool World::DeleteShip_(uint64_t id) {
+  // remove from chunk
+  auto chunk = ships_.find(id);
+  if (chunk == ships_.end() || !chunks_.at(chunk->second).RemoveInstance(id)) {
+    return false;
+  }
+
+  // remove from class
+  Point2D<int> last_chunk = chunk->second;
+  ships_.erase(id);
+  known_ids_.erase(id);
+  new_projectiles_.erase(id);
+  ship_costs_.erase(id);
+  ReleaseChunksAround(last_chunk);
+  return true;
+}
+
+// private funcs
+void World::CreateChunk(Point2D<int> chunk_coord) {
+  chunks_.insert(std::make_pair(chunk_coord, Chunk(GetServerTime_())));
+  MaterializeChunk(chunk_coord);
+}
+
+void World::ReleaseUnwatchedChunks(const FlatHashSet<Point2D<int>>& candidates) {
+  // ships may have moved since the candidates were picked
+  FlatHashSet<Point2D<int>> watched = GetActiveChunks();
+  for (auto point : candidates) {
+    auto chunk = chunks_.find(point);
+    if (chunk == chunks_.end() || watched.count(point)) {
+      continue;
+    }
+
+    chunk->second.ReleaseTransients();
+    if (chunk->second.IsEmpty()) {
+      chunks_.erase(chunk);
+    }
+  }
+}
+
+void World::ReleaseChunksAround(Point2D<int> center) {
+  for (int x = center.x - 1; x <= center.x + 1; x++) {
+    for (int y = center.y - 1; y <= center.y + 1; y++) {
+      Point2D<int> point(x, y);
+      FixChunkBoundaries(point);
+      auto chunk = chunks_.find(point);
+      if (chunk == chunks_.end() || IsChunkWatched(point)) {
+        continue;
+      }
+
+      chunk->second.ReleaseTransients();
+      if (chunk->second.IsEmpty()) {
+        chunks_.erase(chunk);
+      }
+    }
+  }
+}
+
+bool World::IsChunkWatched(Point2D<int> chunk) const {
+  for (auto& ship : ships_) {
+    // distance in chunks, the short way around
+    int dx = std::abs(ship.second.x - chunk.x);
+    int dy = std::abs(ship.second.y - chunk.y);
+    if (std::min(dx, chunk_dims_ - dx) <= 1 && std::min(dy, chunk_dims_ - dy) <= 1) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void World::MaterializeChunk(Point2D<int> chunk_coord) {
+  if (all_materialized_ || !materialized_.insert(chunk_coord).second) {
+    return;
+  }
+
+  int count = GetInitialAsteroidCount(chunk_coord);
+  if (count > 0) {
+    std::vector<Asteroid> asteroids(count);
+    GenerateChunkContents(chunk_coord, id_max_, GetServerTime_(), asteroids.data(), count);
+    id_max_ += count;
+
+    if (!chunks_.count(chunk_coord)) {
+      CreateChunk(chunk_coord);
+    }
+
+    chunks_.at(chunk_coord).InsertAsteroids(asteroids.begin(), asteroids.end());
+  }
+
+  asteroid_count_ += count;
+  unmaterialized_share_ -= mgr->GetExpectedAsteroids(chunk_coord);
+  mgr->UpdateChunkCrowding(chunk_coord, count);
+}
+
+void World::BootstrapWorld() {
+  const int chunk_count = chunk_dims_ * chunk_dims_;
+  const double time = GetServerTime_();
+
+  TraceSpan bootstrap_span(trace_.get(), "bootstrap");
+
+  // rows are independent -- split them across threads
+  auto for_each_row = [this](const std::function<void(int)>& fn) {
+    int thread_count = static_cast<int>(std::thread::hardware_concurrency());
+    thread_count = std::max(1, std::min(thread_count, chunk_dims_ / 16));
+    std::vector<std::thread> threads;
+    for (int t = 1; t < thread_count; t++) {
+      threads.emplace_back([&, t]() {
+        if (trace_) {
+          trace_->NameThread("bootstrap_worker");
+        }
+
+        TraceSpan span(trace_.get(), "bootstrap_rows", "thread", t);
+        for (int i = t; i < chunk_dims_; i += thread_count) {
+          fn(i);
+        }
+      });
+    }
+
+    TraceSpan span(trace_.get(), "bootstrap_rows", "thread", 0);
+    for (int i = 0; i < chunk_dims_; i += thread_count) {
+      fn(i);
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+
+  // count first, so that every chunk knows where its asteroids go and which IDs they get
+  std::vector<int> counts(chunk_count);
+  for_each_row([&](int i) {
+    for (int j = 0; j < chunk_dims_; j++) {
+      counts[i * chunk_dims_ + j] = GetInitialAsteroidCount(Point2D<int>(i, j));
+    }
+  });
+
+  std::vector<size_t> offsets(chunk_count + 1, 0);
+  size_t occupied = 0;
+  for (int i = 0; i < chunk_count; i++) {
+    offsets[i + 1] = offsets[i] + counts[i];
+    occupied += (counts[i] > 0 ? 1 : 0);
+  }
+
+  const size_t total = offsets[chunk_count];
+  std::vector<Asteroid> asteroids(total);
+  for_each_row([&](int i) {
+    for (int j = 0; j < chunk_dims_; j++) {
+      int index = i * chunk_dims_ + j;
+      if (counts[index] > 0) {
+        GenerateChunkContents(Point2D<int>(i, j), id_max_ + offsets[index], time, &asteroids[offsets[index]], counts[index]);
+      }
+    }
+  });
+
+  // hash maps aren't thread safe, so the inserts stay on this thread -- but they never rehash
+  all_materialized_ = true;
+  chunks_.reserve(chunks_.size() + occupied);
+  for (int i = 0; i < chunk_count; i++) {
+    if (counts[i] == 0) {
+      continue;
+    }
+
+    Point2D<int> chunk_coord(i / chunk_dims_, i % chunk_dims_);
+    auto chunk = chunks_.insert(std::make_pair(chunk_coord, Chunk(time))).first;
+    chunk->second.InsertAsteroids(asteroids.begin() + offsets[i], asteroids.begin() + offsets[i + 1]);
+  }
+
+  id_max_ += total;
+  asteroid_count_ = static_cast<int>(total);
+  unmaterialized_share_ = 0.0;
+  mgr->SetAsteroidCounts(counts);
+}
+
+int World::GetInitialAsteroidCount(Point2D<int> chunk_coord) const {
+  RandomStream rng(seed_, RandomPurpose::CHUNK_CONTENTS, chunk_coord);
+  double expected = mgr->GetExpectedAsteroids(chunk_coord);
+  // round the expected count up or down at random, so the world holds the same number on average
+  int count = static_cast<int>(expected);
+  if (rng.NextDouble() < expected - count) {
+    count++;
+  }
+
+  return count;
+}
+
+void World::GenerateChunkContents(Point2D<int> chunk_coord, uint64_t first_id, double time, Asteroid* out, int count) const {
+  RandomStream rng(seed_, RandomPurpose::CHUNK_CONTENTS, chunk_coord);
+  // skip the draw which decided the count
+  rng.Seek(1);
+
+  WorldPosition temp;
+  temp.chunk = chunk_coord;
+  for (int i = 0; i < count; i++) {
+    temp.position.x = rng.NextFloat(0.0f, chunk_size);
+    temp.position.y = rng.NextFloat(0.0f, chunk_size);
+    RandomStream ast_rng = rng.Substream(i);
+    out[i] = MakeAsteroid(temp, 1.5f, 12, first_id + i, time, ast_rng);
+  }
+}
+
+void World::SpawnNewAsteroid(WorldPosition coord) {
+  SpawnNewAsteroid(coord, 1.5f, 12);
+}
+
+void World::SpawnNewAsteroid(WorldPosition coord, float radius, int points) {
+  // materialize first, so that the next ID goes to this asteroid
+  if (!chunks_.count(coord.chunk)) {
+    CreateChunk(coord.chunk);
+  }
+
+  uint64_t id = id_max_++;
+  // each asteroid draws from its own stream, so its shape doesn't depend on what else was spawned
+  RandomStream ast_rng(seed_, RandomPurpose::ASTEROID, id);
+  auto ast = MakeAsteroid(coord, radius, points, id, GetServerTime_(), ast_rng);
+  chunks_.at(coord.chunk).InsertAsteroid(ast);
+}
+
+Asteroid World::MakeAsteroid(WorldPosition coord, float radius, int points, uint64_t id, double time, RandomStream& rng) const {
+  auto ast = GenerateAsteroid(radius, points, rng);
+  // random velocity
+  // TODO: we should look up chunks' biomes here
+  ast.velocity = { rng.NextFloat(-2.0f, 2.0f), rng.NextFloat(-2.0f, 2.0f) };
+  ast.rotation_velocity = rng.NextFloat(-2.0f, 2.0f);
+  ast.position = coord;
+  ast.ver = 0;
+  ast.id = id;
+  ast.last_update = time;
+  ast.origin_time = time - rng.NextFloat(0.0f, chunk_size) / 8.0f;
+  return ast;
+}
+
+void World::FixChunkBoundaries(Point2D<int>& chunk) {
+  if (chunk.x >= chunk_dims_ || chunk.x < 0 || chunk.y >= chunk_dims_ || chunk.y < 0) {
+    chunk.x -= std::floor(chunk.x / static_cast<double>(chunk_dims_)) * chunk_dims_;
+    chunk.y -= std::floor(chunk.y / static_cast<double>(chunk_dims_)) * chunk_dims_;
+  }
+}
+
+double World::GetServerTime() {
+  return clock_->Now();
+}
+
+uint64_t World::GetSeed() const {
+  return seed_;
+}
+
+void World::GetBiomeRegion(Point2D<int> origin, Point2D<int> dims, uint8_t* out) const {
+  mgr->GetBiomeRegion(origin, dims, out);
+}
+
+int World::GetBiomeTileDims() const {
+  return biome_tile_dims_;
+}
+
+void World::EncodeBiomeTile(Point2D<int> tile, std::vector<uint8_t>& res) const {
+  Point2D<int> origin(tile.x * biome_tile_size, tile.y * biome_tile_size);
+  // tiles on the far edge are clipped to the world
+  Point2D<int> dims(std::min(biome_tile_size, chunk_dims_ - origin.x), std::min(biome_tile_size, chunk_dims_ - origin.y));
+
+  uint8_t region[biome_tile_size * biome_tile_size];
+  mgr->GetBiomeRegion(origin, dims, region);
+
+  uint32_t count = static_cast<uint32_t>(dims.x * dims.y);
+  res.resize(4 + count * biome_entry_size);
+  uint8_t* out = res.data();
+
+  // little endian, to match DataView reads on the client
+  auto put16 = [&out](int val) {
+    *out++ = static_cast<uint8_t>(val & 0xFF);
+    *out++ = static_cast<uint8_t>((val >> 8) & 0xFF);
+  };
+
+  put16(count & 0xFFFF);
+  put16(count >> 16);
+  for (int i = 0; i < dims.x; i++) {
+    for (int j = 0; j < dims.y; j++) {
+      put16(origin.x + i);
+      put16(origin.y + j);
+      *out++ = region[i * dims.y + j];
+    }
+  }
+}
+
+void World::PrintBiomeMap(std::ostream& out) const {
+  mgr->PrintMap(out);
+}
+
+const TickTimings& World::GetLastTickTimings() const {
+  return last_tick_;
+}
+
+const TickCounts& World::GetLastTickCounts() const {
+  return last_counts_;
+}
+
+void World::GetCostliestShips(size_t count, std::vector<ShipCost>& out) const {
+  out.clear();
+  out.reserve(ship_costs_.size());
+  for (auto& cost : ship_costs_) {
+    out.push_back(cost.second);
+  }
+
+  count = std::min(count, out.size());
+  std::partial_sort(out.begin(), out.begin() + count, out.end(), [](const ShipCost& a, const ShipCost& b) {
+    return a.fanout_time > b.fanout_time;
+  });
+
+  out.resize(count);
+  for (auto& cost : out) {
+    cost.biome = mgr->GetBiome(cost.chunk);
+  }
+}
+
+void World::GetMemoryStats(MemoryStats& out, size_t top_chunks) const {
+  out = MemoryStats();
+  out.chunks = { chunks_.size(), GetHeapBytes(chunks_) };
+
+  std::vector<ChunkMemory> chunk_memory;
+  chunk_memory.reserve(chunks_.size());
+  for (auto& chunk : chunks_) {
+    ChunkMemory mem;
+    mem.chunk = chunk.first;
+    chunk.second.GetMemoryUsage(mem);
+    out.asteroids += mem.asteroids;
+    out.ships += mem.ships;
+    out.projectiles += mem.projectiles;
+    out.collisions += mem.collisions;
+    out.deleted += mem.deleted;
+    out.encoded += mem.encoded;
+    if (chunk.second.IsEmpty()) {
+      out.empty_chunks++;
+    }
+
+    chunk_memory.push_back(mem);
+  }
+
+  top_chunks = std::min(top_chunks, chunk_memory.size());
+  std::partial_sort(chunk_memory.begin(), chunk_memory.begin() + top_chunks, chunk_memory.end(), [](const ChunkMemory& a, const ChunkMemory& b) {
+    return a.GetTotalBytes() > b.GetTotalBytes();
+  });
+
+  chunk_memory.resize(top_chunks);
+  out.largest_chunks = std::move(chunk_memory);
+
+  out.materialized = { materialized_.size(), GetHeapBytes(materialized_) };
+
+  out.known_ids = { known_ids_.size(), GetHeapBytes(known_ids_) };
+  for (auto& knowns : known_ids_) {
+    out.known_ids.bytes += GetHeapBytes(knowns.second);
+  }
+
+  out.new_projectiles = { new_projectiles_.size(), GetHeapBytes(new_projectiles_) };
+  for (auto& projs : new_projectiles_) {
+    out.new_projectiles.bytes += GetHeapBytes(projs.second);
+  }
+
+  out.ship_index = { ships_.size(), GetHeapBytes(ships_) + GetHeapBytes(ship_costs_) };
+  out.collision_world = { 0, cw_->GetAllocatedBytes() };
+  out.sweep_and_prune = { sweep_->size(), sweep_->GetAllocatedBytes() };
+  out.biome_manager = { mgr->GetBiomeMap().size(), mgr->GetAllocatedBytes() };
+}
+
+const SlowTickInfo& World::GetReplayedSlowTick() const {
+  return replayed_slow_tick_;
+}
+
+bool World::SaveSnapshot(std::string& error) {
+  if (!log_.IsOpen() || snapshot_writer_.IsBusy()) {
+    return false;
+  }
+
+  // inputs from here on are replayed on top of the new snapshot -- it's no use without a log to hold them
+  TickLog next_log;
+  if (!next_log.Open(GetLogPath(generation_ + 1))) {
+    error = "Could not open tick log " + GetLogPath(generation_ + 1) + " -- snapshot abandoned";
+    return false;
+  }
+
+  // chunks which haven't changed since they were last encoded are shared as they are.
+  // the rest of the copying, and the disk, are left to the writer's thread.
+  generation_++;
+  SegmentedWriter snapshot;
+  {
+    TraceSpan span(trace_.get(), "encode_snapshot");
+    EncodeSnapshot(snapshot);
+  }
+
+  log_ = std::move(next_log);
+
+  // the old log is needed until the new snapshot is safely on disk
+  snapshot_writer_.Write(GetSnapshotPath(), std::move(snapshot), { GetLogPath(generation_ - 1) }, trace_);
+  return true;
+}
+
+bool World::StartTrace(const std::string& path, std::string& error) {
+  // the old trace is finished before the new one is opened, in case they share a path
+  StopTrace();
+  trace_ = TraceRecorder::Open(path, error);
+  if (!trace_) {
+    return false;
+  }
+
+  trace_->NameThread("sim");
+  return true;
+}
+
+bool World::StopTrace() {
+  if (!trace_) {
+    return false;
+  }
+
+  trace_.reset();
+  return true;
+}
+
+TraceRecorder* World::GetTrace() const {
+  return trace_.get();
+}
+
+BinaryWriter World::StartLogEntry(LogEntryType type) {
+  BinaryWriter entry;
+  entry.Put(static_cast<uint8_t>(type));
+  entry.Put(now_);
+  return entry;
+}
+
+bool World::IsLogging() const {
+  return log_.IsOpen() || recording_.IsOpen() || IsCapturing();
+}
+
+void World::LogInput(BinaryWriter& entry) {
+  log_.Append(entry.Data());
+  recording_.Append(entry.Data());
+  if (IsCapturing()) {
+    TickLog::AppendTo(window_inputs_, entry.Data());
+  }
+}
+
+void World::StartRecording(const std::string& path, int asteroids, bool eager) {
+  if (!recording_.Create(path)) {
+    std::cout << "could not create recording " << path << std::endl;
+    return;
+  }
+
+  // everything needed to generate the world again
+  BinaryWriter header;
+  header.Put(recording_magic);
+  header.Put(recording_version);
+  header.Put<int32_t>(chunk_dims_);
+  header.Put<int32_t>(asteroids);
+  header.Put(seed_);
+  header.Put<uint8_t>(eager ? 1 : 0);
+  recording_.Append(header.Data());
+  recording_.Flush();
+}
+
+bool World::ReplayRecording(const std::string& path, std::string& error) {
+  MappedFile recording(path);
+  if (!recording.ok()) {
+    error = "Could not open recording " + path;
+    return false;
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  bool has_header = false;
+  bool valid = false;
+  size_t inputs = TickLog::ForEachEntry(recording.Data(), recording.size(), [&](const uint8_t* data, size_t len) {
+    if (has_header) {
+      if (valid) {
+        ApplyLogEntry(data, len);
+      }
+
+      return;
+    }
+
+    // the first entry describes the world the recording started from
+    has_header = true;
+    BinaryReader in(data, len);
+    if (in.Get<uint32_t>() != recording_magic || in.Get<uint32_t>() != recording_version) {
+      return;
+    }
+
+    int chunk_dims = in.Get<int32_t>();
+    int asteroids = in.Get<int32_t>();
+    uint64_t seed = in.Get<uint64_t>();
+    bool eager = (in.Get<uint8_t>() != 0);
+    if (!in.ok() || chunk_dims <= 0) {
+      return;
+    }
+
+    valid = true;
+    seed_ = seed;
+    SetUpWorld(chunk_dims);
+    GenerateWorld(asteroids, eager);
+  });
+
+  if (!valid) {
+    error = path + " is not a recording!";
+    return false;
+  }
+
+  double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+  std::cout << "replayed " << (inputs - 1) << " inputs (" << now_ << "s of play) in " << elapsed << "s" << std::endl;
+
+  // carry on from the end of the recording
+  clock_->Reset(now_);
+  return true;
+}
+
+void World::ApplyLogEntry(const uint8_t* data, size_t len) {
+  BinaryReader in(data, len);
+  LogEntryType type = static_cast<LogEntryType>(in.Get<uint8_t>());
+  now_ = in.Get<double>();
+  if (!in.ok()) {
+    return;
+  }
+
+  switch (type) {
+    case LogEntryType::ADD_SHIP: {
+      std::string name = in.GetString();
+      if (in.ok()) {
+        AddShip_(name);
+      }
+
+      break;
+    }
+    case LogEntryType::CLIENT_PACKET: {
+      ClientPacket packet;
+      Read(in, packet.client_ship);
+      uint32_t count = in.Get<uint32_t>();
+      // don't trust a corrupt count with a huge allocation
+      if (!in.ok() || count > in.Remaining()) {
+        break;
+      }
+
+      packet.projectiles.resize(count);
+      for (auto& proj : packet.projectiles) {
+        Read(in, proj);
+      }
+
+      if (in.ok()) {
+        HandleClientPacket_(packet);
+      }
+
+      break;
+    }
+    case LogEntryType::DELETE_SHIP: {
+      uint64_t id = in.Get<uint64_t>();
+      if (in.ok()) {
+        DeleteShip_(id);
+      }
+
+      break;
+    }
+    case LogEntryType::RESPAWN_SHIP: {
+      uint64_t id = in.Get<uint64_t>();
+      if (in.ok()) {
+        RespawnShip_(id);
+      }
+
+      break;
+    }
+    case LogEntryType::UPDATE_SIM:
+      if (replay_packets_) {
+        FlatHashMap<uint64_t, ServerPacket> packets;
+        UpdateSim_(&packets);
+      } else {
+        UpdateSim_(nullptr);
+      }
+
+      break;
+    default:
+      std::cout << "skipping unknown tick log entry" << std::endl;
+  }
+}
+
+void World::EncodeSnapshot(SegmentedWriter& out) {
+  out.Put(snapshot_magic);
+  out.Put(snapshot_version);
+  out.Put<int32_t>(chunk_dims_);
+
+  out.Put(seed_);
+  out.Put(rng_.GetCounter());
+  out.Put(id_max_);
+  out.Put<int32_t>(asteroid_count_);
+  out.Put<int32_t>(asteroid_min_);
+  out.Put(unmaterialized_share_);
+  out.Put<uint8_t>(all_materialized_ ? 1 : 0);
+  out.Put(now_);
+  out.Put(generation_);
+  out.Put(mgr->GetSpawnCounter());
+
+  // the map is cheap to store, and pricey to regenerate
+  auto& biome_map = mgr->GetBiomeMap();
+  out.PutBytes(biome_map.data(), biome_map.size());
+
+  out.Put<uint32_t>(static_cast<uint32_t>(materialized_.size()));
+  for (auto& chunk : materialized_) {
+    out.Put(chunk.x);
+    out.Put(chunk.y);
+  }
+
+  out.Put<uint32_t>(static_cast<uint32_t>(chunks_.size()));
+  for (auto& chunk : chunks_) {
+    out.Put(chunk.first.x);
+    out.Put(chunk.first.y);
+    out.PutShared(chunk.second.Encode());
+  }
+
+  out.Put<uint32_t>(static_cast<uint32_t>(ships_.size()));
+  for (auto& ship : ships_) {
+    out.Put(ship.first);
+    out.Put(ship.second.x);
+    out.Put(ship.second.y);
+  }
+}
+
+bool World::RestoreSnapshot(BinaryReader& in) {
+  if (in.Get<uint32_t>() != snapshot_magic || in.Get<uint32_t>() != snapshot_version) {
+    return false;
+  }
+
+  if (in.Get<int32_t>() != chunk_dims_) {
+    return false;
+  }
+
+  seed_ = in.Get<uint64_t>();
+  rng_ = RandomStream(seed_, RandomPurpose::WORLD);
+  rng_.Seek(in.Get<uint64_t>());
+  id_max_ = in.Get<uint64_t>();
+  asteroid_count_ = in.Get<int32_t>();
+  asteroid_min_ = in.Get<int32_t>();
+  unmaterialized_share_ = in.Get<double>();
+  all_materialized_ = (in.Get<uint8_t>() != 0);
+  now_ = in.Get<double>();
+  generation_ = in.Get<uint64_t>();
+  uint64_t spawn_counter = in.Get<uint64_t>();
+
+  const size_t map_size = static_cast<size_t>(chunk_dims_) * chunk_dims_;
+  const uint8_t* biome_map = in.Skip(map_size);
+  if (biome_map == nullptr) {
+    return false;
+  }
+
+  mgr = std::make_shared<BiomeManager>(chunk_dims_, std::vector<uint8_t>(biome_map, biome_map + map_size), seed_);
+  mgr->SetSpawnCounter(spawn_counter);
+  mgr->SetAsteroidTarget(asteroid_min_);
+
+  Point2D<int> coord;
+  uint32_t count = in.Get<uint32_t>();
+  if (count > in.Remaining() / (2 * sizeof(int))) {
+    return false;
+  }
+
+  materialized_.clear();
+  for (uint32_t i = 0; i < count; i++) {
+    coord.x = in.Get<int>();
+    coord.y = in.Get<int>();
+    materialized_.insert(coord);
+  }
+
+  count = in.Get<uint32_t>();
+  if (count > in.Remaining() / (2 * sizeof(int))) {
+    return false;
+  }
+
+  chunks_.clear();
+  chunks_.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    coord.x = in.Get<int>();
+    coord.y = in.Get<int>();
+    Chunk chunk(now_);
+    if (!chunk.Deserialize(in)) {
+      return false;
+    }
+
+    chunks_.insert(std::make_pair(coord, std::move(chunk)));
+  }
+
+  count = in.Get<uint32_t>();
+  if (count > in.Remaining() / (sizeof(uint64_t) + 2 * sizeof(int))) {
+    return false;
+  }
+
+  ships_.clear();
+  known_ids_.clear();
+  new_projectiles_.clear();
+  ship_costs_.clear();
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t id = in.Get<uint64_t>();
+    coord.x = in.Get<int>();
+    coord.y = in.Get<int>();
+    ships_.insert(std::make_pair(id, coord));
+    known_ids_.insert(std::make_pair(id, FlatHashMap<uint64_t, uint32_t>()));
+    new_projectiles_.insert(std::make_pair(id, FlatHashSet<uint64_t>()));
+    ship_costs_[id].id = id;
+  }
+
+  // crowding follows what the chunks actually hold
+  if (all_materialized_) {
+    std::vector<int> counts(map_size, 0);
+    for (auto& chunk : chunks_) {
+      counts[chunk.first.x * chunk_dims_ + chunk.first.y] = static_cast<int>(chunk.second.GetAsteroidCount());
+    }
+
+    mgr->SetAsteroidCounts(counts);
+  } else {
+    for (auto& chunk : materialized_) {
+      auto c = chunks_.find(chunk);
+      mgr->UpdateChunkCrowding(chunk, (c == chunks_.end() ? 0 : static_cast<int>(c->second.GetAsteroidCount())));
+    }
+  }
+
+  return in.ok();
+}
+
+bool World::RestoreWorld(std::string& error) {
+  {
+    MappedFile snapshot(GetSnapshotPath());
+    if (!snapshot.ok()) {
+      return false;
+    }
+
+    BinaryReader in(snapshot.Data(), snapshot.size());
+    if (!RestoreSnapshot(in)) {
+      error = "Snapshot at " + GetSnapshotPath() + " is corrupt, or does not match this world!";
+      return false;
+    }
+  }
+
+  // replay every log written since -- a snapshot which never made it to disk leaves two behind
+  size_t entries = 0;
+  for (uint64_t gen = generation_; ; gen++) {
+    MappedFile log(GetLogPath(gen));
+    if (!log.ok()) {
+      break;
+    }
+
+    entries += TickLog::ForEachEntry(log.Data(), log.size(), [this](const uint8_t* data, size_t len) {
+      ApplyLogEntry(data, len);
+    });
+
+    generation_ = gen;
+  }
+
+  // the clients which owned these ships went down with the old server
+  std::vector<uint64_t> orphans;
+  for (auto& ship : ships_) {
+    orphans.push_back(ship.first);
+  }
+
+  for (auto id : orphans) {
+    DeleteShip_(id);
+  }
+
+  // resume the clock where the log left off
+  clock_->Reset(now_);
+
+  std::cout << "restored world from " << GetSnapshotPath() << ", replayed " << entries << " inputs" << std::endl;
+  return true;
+}
+
+void World::StartPersistence() {
+  // a fresh snapshot takes in everything replayed so far
+  generation_++;
+  SegmentedWriter snapshot;
+  {
+    TraceSpan span(trace_.get(), "encode_snapshot");
+    EncodeSnapshot(snapshot);
+  }
+
+  if (!SnapshotWriter::WriteFile(GetSnapshotPath(), snapshot)) {
+    std::cout << "could not write snapshot to " << GetSnapshotPath() << " -- world will not be persisted" << std::endl;
+    return;
+  }
+
+  // older logs are folded into the snapshot now
+  for (uint64_t gen = generation_; gen-- > 0;) {
+    if (std::remove(GetLogPath(gen).c_str()) != 0) {
+      break;
+    }
+  }
+
+  if (!log_.Open(GetLogPath(generation_))) {
+    std::cout << "could not open tick log " << GetLogPath(generation_) << " -- world will not be persisted" << std::endl;
+  }
+}
+
+bool World::IsCapturing() const {
+  return slow_tick_threshold_ > 0.0;
+}
+
+void World::StartCaptureWindow() {
+  // chunks which haven't changed since they were last encoded are shared, rather than copied
+  window_state_ = SegmentedWriter();
+  EncodeSnapshot(window_state_);
+  BinaryWriter clients;
+  EncodeClientState(clients);
+  window_state_.PutShared(std::make_shared<const std::vector<uint8_t>>(std::move(clients.Data())));
+}
+
+void World::CaptureSlowTick() {
+  if (window_captured_ || capture_writer_.IsBusy()) {
+    return;
+  }
+
+  window_captured_ = true;
+  uint64_t tick = tick_count_ - 1;
+
+  SegmentedWriter capture;
+  capture.Put(capture_magic);
+  capture.Put(capture_version);
+  capture.Put<int32_t>(chunk_dims_);
+  capture.Put(tick);
+  capture.Put(slow_tick_threshold_);
+
+  capture.Put<int32_t>(tick_phase_count);
+  for (int i = 0; i < tick_phase_count; i++) {
+    capture.Put(last_tick_.phases[i]);
+  }
+
+  capture.Put(last_tick_.total);
+  capture.Put(last_counts_);
+
+  capture.Put<uint64_t>(window_state_.size());
+  capture.Append(window_state_);
+  capture.Put<uint64_t>(window_inputs_.size());
+  capture.PutBytes(window_inputs_.data(), window_inputs_.size());
+
+  std::string path = slow_tick_dir_ + "/slowtick." + std::to_string(tick) + ".vcap";
+  std::cout << "tick " << tick << " took " << (last_tick_.total * 1000.0) << "ms -- capturing it to " << path << std::endl;
+  capture_writer_.Write(path, std::move(capture), {}, trace_);
+}
+
+bool World::ReplaySlowTick(const std::string& path, std::string& error) {
+  MappedFile file(path);
+  if (!file.ok()) {
+    error = "Could not open capture " + path;
+    return false;
+  }
+
+  BinaryReader in(file.Data(), file.size());
+  if (in.Get<uint32_t>() != capture_magic || in.Get<uint32_t>() != capture_version) {
+    error = path + " is not a slow tick capture!";
+    return false;
+  }
+
+  int chunk_dims = in.Get<int32_t>();
+  replayed_slow_tick_.tick = in.Get<uint64_t>();
+  replayed_slow_tick_.threshold = in.Get<double>();
+  if (in.Get<int32_t>() != tick_phase_count) {
+    error = path + " was captured by a different version of the sim!";
+    return false;
+  }
+
+  for (int i = 0; i < tick_phase_count; i++) {
+    replayed_slow_tick_.timings.phases[i] = in.Get<double>();
+  }
+
+  replayed_slow_tick_.timings.total = in.Get<double>();
+  replayed_slow_tick_.counts = in.Get<TickCounts>();
+
+  uint64_t state_size = in.Get<uint64_t>();
+  const uint8_t* state = in.Skip(state_size);
+  uint64_t inputs_size = in.Get<uint64_t>();
+  const uint8_t* inputs = in.Skip(inputs_size);
+  if (!in.ok() || state == nullptr || inputs == nullptr || chunk_dims <= 0) {
+    error = "Capture at " + path + " is corrupt!";
+    return false;
+  }
+
+  SetUpWorld(chunk_dims);
+  BinaryReader state_in(state, state_size);
+  if (!RestoreSnapshot(state_in) || !RestoreClientState(state_in)) {
+    error = "Capture at " + path + " is corrupt!";
+    return false;
+  }
+
+  // the last input is the slow tick itself -- it's left for the caller to run
+  size_t count = TickLog::ForEachEntry(inputs, inputs_size, [](const uint8_t*, size_t) {});
+  if (count == 0) {
+    error = "Capture at " + path + " holds no ticks!";
+    return false;
+  }
+
+  size_t applied = 0;
+  replay_packets_ = true;
+  TickLog::ForEachEntry(inputs, inputs_size, [&](const uint8_t* data, size_t len) {
+    if (++applied < count) {
+      ApplyLogEntry(data, len);
+      return;
+    }
+
+    BinaryReader entry(data, len);
+    entry.Get<uint8_t>();
+    now_ = entry.Get<double>();
+  });
+
+  replay_packets_ = false;
+  clock_->Reset(now_);
+  return true;
+}
+
+void World::EncodeClientState(BinaryWriter& out) {
+  out.Put<uint32_t>(static_cast<uint32_t>(known_ids_.size()));
+  for (auto& knowns : known_ids_) {
+    out.Put(knowns.first);
+    out.Put<uint32_t>(static_cast<uint32_t>(knowns.second.size()));
+    for (auto& known : knowns.second) {
+      out.Put(known.first);
+      out.Put(known.second);
+    }
+  }
+
+  out.Put<uint32_t>(static_cast<uint32_t>(new_projectiles_.size()));
+  for (auto& projs : new_projectiles_) {
+    out.Put(projs.first);
+    out.Put<uint32_t>(static_cast<uint32_t>(projs.second.size()));
+    for (auto id : projs.second) {
+      out.Put(id);
+    }
+  }
+}
+
+bool World::RestoreClientState(BinaryReader& in) {
+  uint32_t count = in.Get<uint32_t>();
+  for (uint32_t i = 0; i < count && in.ok(); i++) {
+    uint64_t id = in.Get<uint64_t>();
+    uint32_t known_count = in.Get<uint32_t>();
+    if (known_count > in.Remaining() / (sizeof(uint64_t) + sizeof(uint32_t))) {
+      return false;
+    }
+
+    auto& knowns = known_ids_[id];
+    knowns.reserve(known_count);
+    for (uint32_t j = 0; j < known_count; j++) {
+      uint64_t known = in.Get<uint64_t>();
+      knowns[known] = in.Get<uint32_t>();
+    }
+  }
+
+  count = in.Get<uint32_t>();
+  for (uint32_t i = 0; i < count && in.ok(); i++) {
+    uint64_t id = in.Get<uint64_t>();
+    uint32_t proj_count = in.Get<uint32_t>();
+    if (proj_count > in.Remaining() / sizeof(uint64_t)) {
+      return false;
+    }
+
+    auto& projs = new_projectiles_[id];
+    for (uint32_t j = 0; j < proj_count; j++) {
+      projs.insert(in.Get<uint64_t>());
+    }
+  }
+
+  return in.ok();
+}
+
+std::string World::GetSnapshotPath() const {
+  return persist_path_ + "/world.snap";
+}
+
+std::string World::GetLogPath(uint64_t generation) const {
+  return persist_path_ + "/world." + std::to_string(generation) + ".wal";
+}
+
+double World::GetServerTime_() {
+  return now_;
+}
+
+}
+}
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include <server/WorldSnapshot.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vasteroids {
+namespace server {
+
+void BinaryWriter::PutBytes(const void* data, size_t len) {
+  size_t offset = data_.size();
+  data_.resize(offset + len);
+  if (len > 0) {
+    std::memcpy(&data_[offset], data, len);
+  }
+}
+
+void BinaryWriter::PutString(const std::string& str) {
+  Put<uint32_t>(static_cast<uint32_t>(str.size()));
+  PutBytes(str.data(), str.size());
+}
+
+void SegmentedWriter::PutBytes(const void* data, size_t len) {
+  own_.PutBytes(data, len);
+  size_ += len;
+}
+
+void SegmentedWriter::PutShared(SharedBytes piece) {
+  size_ += piece->size();
+  pieces_.push_back({ own_.size(), std::move(piece) });
+}
+
+void SegmentedWriter::Append(const SegmentedWriter& other) {
+  const uint8_t* own = other.own_.Data().data();
+  size_t offset = 0;
+  for (auto& piece : other.pieces_) {
+    PutBytes(own + offset, piece.own_end - offset);
+    PutShared(piece.bytes);
+    offset = piece.own_end;
+  }
+
+  PutBytes(own + offset, other.own_.size() - offset);
+}
+
+std::vector<uint8_t> SegmentedWriter::Join() const {
+  std::vector<uint8_t> res;
+  res.reserve(size_);
+  ForEachRange([&res](const uint8_t* data, size_t len) {
+    res.insert(res.end(), data, data + len);
+  });
+
+  return res;
+}
+
+bool BinaryReader::GetBytes(void* out, size_t len) {
+  const uint8_t* src = Skip(len);
+  if (src == nullptr) {
+    return false;
+  }
+
+  if (len > 0) {
+    std::memcpy(out, src, len);
+  }
+
+  return true;
+}
+
+std::string BinaryReader::GetString() {
+  uint32_t len = Get<uint32_t>();
+  const uint8_t* src = Skip(len);
+  if (src == nullptr) {
+    return std::string();
+  }
+
+  return std::string(reinterpret_cast<const char*>(src), len);
+}
+
+const uint8_t* BinaryReader::Skip(size_t len) {
+  if (failed_ || len > len_ - offset_) {
+    failed_ = true;
+    return nullptr;
+  }
+
+  const uint8_t* res = data_ + offset_;
+  offset_ += len;
+  return res;
+}
+
+void Write(BinaryWriter& out, const WorldPosition& pos) {
+  out.Put(pos.chunk.x);
+  out.Put(pos.chunk.y);
+  out.Put(pos.position.x);
+  out.Put(pos.position.y);
+}
+
+void Write(BinaryWriter& out, const Instance& inst) {
+  Write(out, inst.position);
+  out.Put(inst.velocity.x);
+  out.Put(inst.velocity.y);
+  out.Put(inst.rotation);
+  out.Put(inst.rotation_velocity);
+  out.Put(inst.id);
+  out.Put(inst.ver);
+  out.Put(inst.last_update);
+  out.Put(inst.origin_time);
+}
+
+void Write(BinaryWriter& out, const Asteroid& asteroid) {
+  Write(out, static_cast<const Instance&>(asteroid));
+  out.Put<uint32_t>(static_cast<uint32_t>(asteroid.geometry.size()));
+  for (auto& point : asteroid.geometry) {
+    out.Put(point.x);
+    out.Put(point.y);
+  }
+}
+
+void Write(BinaryWriter& out, const Ship& ship) {
+  Write(out, static_cast<const Instance&>(ship));
+  out.PutString(ship.name);
+  out.Put(ship.score);
+  out.Put<uint8_t>(ship.destroyed ? 1 : 0);
+  out.Put<int32_t>(ship.lives);
+  out.Put(ship.spawn_time);
+}
+
+void Write(BinaryWriter& out, const Projectile& proj) {
+  Write(out, static_cast<const Instance&>(proj));
+  out.Put(proj.client_ID);
+  out.Put(proj.creation_time);
+  Write(out, proj.origin);
+  out.Put(proj.ship_ID);
+  out.Put(proj.last_collision_delta);
+}
+
+void Write(BinaryWriter& out, const Collision& collision) {
+  Write(out, static_cast<const Instance&>(collision));
+  out.Put(collision.creation_time);
+}
+
+bool Read(BinaryReader& in, WorldPosition& pos) {
+  pos.chunk.x = in.Get<int>();
+  pos.chunk.y = in.Get<int>();
+  pos.position.x = in.Get<float>();
+  pos.position.y = in.Get<float>();
+  return in.ok();
+}
+
+bool Read(BinaryReader& in, Instance& inst) {
+  Read(in, inst.position);
+  inst.velocity.x = in.Get<float>();
+  inst.velocity.y = in.Get<float>();
+  inst.rotation = in.Get<float>();
+  inst.rotation_velocity = in.Get<float>();
+  inst.id = in.Get<uint64_t>();
+  inst.ver = in.Get<uint32_t>();
+  inst.last_update = in.Get<double>();
+  inst.origin_time = in.Get<double>();
+  return in.ok();
+}
+
+bool Read(BinaryReader& in, Asteroid& asteroid) {
+  Read(in, static_cast<Instance&>(asteroid));
+  uint32_t points = in.Get<uint32_t>();
+  // don't trust a corrupt count with a huge allocation
+  if (!in.ok() || points > in.Remaining() / (2 * sizeof(float))) {
+    return false;
+  }
+
+  asteroid.geometry.resize(points);
+  for (auto& point : asteroid.geometry) {
+    point.x = in.Get<float>();
+    point.y = in.Get<float>();
+  }
+
+  return in.ok();
+}
+
+bool Read(BinaryReader& in, Ship& ship) {
+  Read(in, static_cast<Instance&>(ship));
+  ship.name = in.GetString();
+  ship.score = in.Get<int64_t>();
+  ship.destroyed = (in.Get<uint8_t>() != 0);
+  ship.lives = in.Get<int32_t>();
+  ship.spawn_time = in.Get<double>();
+  return in.ok();
+}
+
+bool Read(BinaryReader& in, Projectile& proj) {
+  Read(in, static_cast<Instance&>(proj));
+  proj.client_ID = in.Get<uint32_t>();
+  proj.creation_time = in.Get<double>();
+  Read(in, proj.origin);
+  proj.ship_ID = in.Get<uint64_t>();
+  proj.last_collision_delta = in.Get<double>();
+  return in.ok();
+}
+
+bool Read(BinaryReader& in, Collision& collision) {
+  Read(in, static_cast<Instance&>(collision));
+  collision.creation_time = in.Get<double>();
+  return in.ok();
+}
+
+MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0), ok_(false), mapped_(false) {
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == 0) {
+    size_ = static_cast<size_t>(info.st_size);
+    ok_ = true;
+    if (size_ > 0) {
+      void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        ok_ = false;
+        size_ = 0;
+      } else {
+        data_ = static_cast<const uint8_t*>(addr);
+        mapped_ = true;
+      }
+    }
+  }
+
+  // the mapping outlives the descriptor
+  close(fd);
+#else
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return;
+  }
+
+  buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  ok_ = true;
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (mapped_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+#endif
+}
+
+TickLog::TickLog() : file_(nullptr) {}
+
+TickLog::~TickLog() {
+  Close();
+}
+
+TickLog::TickLog(TickLog&& other) : file_(other.file_) {
+  other.file_ = nullptr;
+}
+
+TickLog& TickLog::operator=(TickLog&& other) {
+  if (this != &other) {
+    Close();
+    file_ = other.file_;
+    other.file_ = nullptr;
+  }
+
+  return *this;
+}
+
+bool TickLog::Open(const std::string& path) {
+  Close();
+  file_ = std::fopen(path.c_str(), "ab");
+  return file_ != nullptr;
+}
+
+bool TickLog::Create(const std::string& path) {
+  Close();
+  file_ = std::fopen(path.c_str(), "wb");
+  return file_ != nullptr;
+}
+
+void TickLog::Close() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+void TickLog::Append(const std::vector<uint8_t>& entry) {
+  if (file_ == nullptr) {
+    return;
+  }
+
+  uint32_t header[2] = { static_cast<uint32_t>(entry.size()), Checksum(entry.data(), entry.size()) };
+  std::fwrite(header, sizeof(header), 1, file_);
+  std::fwrite(entry.data(), 1, entry.size(), file_);
+}
+
+void TickLog::AppendTo(std::vector<uint8_t>& out, const std::vector<uint8_t>& entry) {
+  uint32_t header[2] = { static_cast<uint32_t>(entry.size()), Checksum(entry.data(), entry.size()) };
+  const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(header);
+  out.insert(out.end(), header_bytes, header_bytes + sizeof(header));
+  out.insert(out.end(), entry.begin(), entry.end());
+}
+
+void TickLog::Flush() {
+  if (file_ != nullptr) {
+    std::fflush(file_);
+  }
+}
+
+uint32_t TickLog::Checksum(const uint8_t* data, size_t len) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+SnapshotWriter::SnapshotWriter() : busy_(false) {}
+
+SnapshotWriter::~SnapshotWriter() {
+  Wait();
+}
+
+bool SnapshotWriter::Write(const std::string& path, SegmentedWriter data, std::vector<std::string> obsolete,
+                           std::shared_ptr<TraceRecorder> trace) {
+  if (busy_.load()) {
+    return false;
+  }
+
+  // the last writer has finished, but still needs to be joined
+  Wait();
+  busy_.store(true);
+  worker_ = std::thread([this, path, data = std::move(data), obsolete = std::move(obsolete), trace = std::move(trace)]() {
+    if (trace) {
+      trace->NameThread("snapshot_writer");
+    }
+
+    TraceSpan span(trace.get(), "write_snapshot", "bytes", static_cast<int64_t>(data.size()));
+    if (WriteFile(path, data)) {
+      for (auto& file : obsolete) {
+        std::remove(file.c_str());
+      }
+    } else {
+      std::cout << "could not write snapshot to " << path << std::endl;
+    }
+
+    busy_.store(false);
+  });
+
+  return true;
+}
+
+bool SnapshotWriter::IsBusy() const {
+  return busy_.load();
+}
+
+void SnapshotWriter::Wait() {
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+bool SnapshotWriter::WriteFile(const std::string& path, const SegmentedWriter& data) {
+  // write next to the old file, then swap -- a crash halfway leaves the old snapshot intact
+  std::string temp = path + ".tmp";
+  FILE* file = std::fopen(temp.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  bool ok = true;
+  data.ForEachRange([file, &ok](const uint8_t* bytes, size_t len) {
+    ok = ok && (std::fwrite(bytes, 1, len, file) == len);
+  });
+
+  ok = (std::fflush(file) == 0) && ok;
+#ifndef _WIN32
+  ok = (fsync(fileno(file)) == 0) && ok;
+#endif
+  ok = (std::fclose(file) == 0) && ok;
+  if (!ok) {
+    std::remove(temp.c_str());
+    return false;
+  }
+
+#ifdef _WIN32
+  // rename won't replace an existing file here
+  std::remove(path.c_str());
+#endif
+  return std::rename(temp.c_str(), path.c_str()) == 0;
+}
+
+}
+}
@@ -0,0 +1,30 @@
+#include <AsteroidGenerator.hpp>
+#include <node/NodeTypes.hpp>
+
+#include <napi.h>
+
+using namespace vasteroids;
+
+static RandomStream test_rng(0, RandomPurpose::ASTEROID);
+
+static Napi::Value GenerateAsteroidNode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2) {
+    Napi::TypeError::New(env, "Wrong arguments").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  float radius = info[0].As<Napi::Number>().FloatValue();
+  int32_t points = info[1].As<Napi::Number>().Int32Value();
+  Asteroid a = GenerateAsteroid(radius, points, test_rng);
+
+  return node::ToNodeObject(env, a);
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("generateAsteroid", Napi::Function::New(env, GenerateAsteroidNode));
+  return exports;
+}
+
+NODE_API_MODULE(asteroidstest, Init);
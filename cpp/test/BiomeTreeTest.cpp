@@ -4,18 +4,22 @@
 
 #include <napi.h>
 
+#include <vector>
+
 using namespace vasteroids;
 using server::BiomeTree;
 
 void InsertTest(Napi::Env);
 void LookupTest(Napi::Env);
 void StressTest(Napi::Env);
+void BuildTest(Napi::Env);
 
 void RunTest(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   InsertTest(env);
   LookupTest(env);
   StressTest(env);
+  BuildTest(env);
 }
 
 void InsertTest(Napi::Env env) {
@@ -78,6 +82,35 @@ void StressTest(Napi::Env env) {
   }
 }
 
+void BuildTest(Napi::Env env) {
+  std::vector<std::pair<float, int>> entries;
+  for (int i = 0; i < 1000; i++) {
+    entries.push_back(std::make_pair(static_cast<float>(i * 2), i));
+  }
+
+  BiomeTree<float, int> tree;
+  tree.Build(std::move(entries));
+  ASSERT_E(1000, tree.size(), env);
+
+  int val;
+  ASSERT_T(!tree.Lookup(-0.5f, &val), env);
+  for (int i = 0; i < 1000; i++) {
+    // exact hits and keys between entries both resolve to the entry below
+    ASSERT_T(tree.Lookup(static_cast<float>(i * 2), &val), env);
+    ASSERT_E(i, val, env);
+    ASSERT_T(tree.Lookup(static_cast<float>(i * 2) + 1.5f, &val), env);
+    ASSERT_E(i, val, env);
+  }
+
+  // inserting after a build still works, and the latest of equal keys wins
+  tree.Insert(10.0f, -1);
+  tree.Insert(-10.0f, -2);
+  ASSERT_T(tree.Lookup(10.5f, &val), env);
+  ASSERT_E(-1, val, env);
+  ASSERT_T(tree.Lookup(-5.0f, &val), env);
+  ASSERT_E(-2, val, env);
+}
+
 static Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("RUNBIOMETEST", Napi::Function::New(env, RunTest));
   return exports;
@@ -7,6 +7,8 @@
 
 #include <napitest.hpp>
 
+#include <napi.h>
+
 using namespace vasteroids;
 using server::Chunk;
 
@@ -59,7 +61,8 @@ void RunTest(const Napi::CallbackInfo& info) {
 
   ASSERT_E(1, s_copy.ver, env, "version number updated when it should not.");
 
-  Asteroid a = GenerateAsteroid(1.5, 12);
+  RandomStream rng(0, RandomPurpose::ASTEROID);
+  Asteroid a = GenerateAsteroid(1.5, 12, rng);
   a.id = 2;
   a.position.chunk = {0, 0};
   a.position.position = {0.5f, 0.5f};
@@ -75,6 +78,29 @@ void RunTest(const Napi::CallbackInfo& info) {
   a = sr.asteroids[0];
   ASSERT_E(-1, a.position.chunk.x, env, "chunk is not right :(");
   ASSERT_E(-1, a.position.chunk.y, env, "chunk is not right :(");
+
+  // only the ship is left
+  server::ChunkMemory mem;
+  c.GetMemoryUsage(mem);
+  ASSERT_E(1, mem.ships.count, env);
+  ASSERT_E(0, mem.asteroids.count, env);
+  ASSERT_T(mem.ships.bytes > 0, env, "ship takes up no memory?");
+  ASSERT_T(!c.IsEmpty(), env, "chunk still holds a ship!");
+
+  // deletions don't count as contents, but are still accounted for
+  ASSERT_T(c.RemoveInstance(1), env);
+  ASSERT_T(c.IsEmpty(), env, "chunk should be empty!");
+  c.GetMemoryUsage(mem);
+  ASSERT_E(0, mem.ships.count, env);
+  ASSERT_E(1, mem.deleted.count, env);
+
+  // once no one is watching, even the empty tables are let go
+  c.ReleaseTransients();
+  c.GetMemoryUsage(mem);
+  ASSERT_E(0, mem.deleted.count, env);
+  ASSERT_E(0, mem.deleted.bytes, env);
+  ASSERT_E(0, mem.ships.bytes, env);
+  ASSERT_T(c.IsEmpty(), env, "chunk should still be empty!");
 }
 
 static Napi::Object Init(Napi::Env env, Napi::Object exports) {
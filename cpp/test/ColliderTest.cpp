@@ -0,0 +1,37 @@
+#include <AsteroidCollider.hpp>
+#include <node/NodeTypes.hpp>
+
+#include <napi.h>
+
+using namespace vasteroids;
+
+static Napi::Value CollideNode(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 3) {
+    Napi::TypeError::New(env, "Bad args").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object asteroid = info[0].As<Napi::Object>();
+  Napi::Object point = info[1].As<Napi::Object>();
+  Napi::Number dims = info[2].As<Napi::Number>();
+
+  Asteroid a;
+  WorldPosition c;
+  if (!node::FromNodeObject(asteroid, a) || !node::FromNodeObject(point, c)) {
+    return env.Null();
+  }
+
+  int d = dims.Int32Value();
+  Napi::Boolean ret = Napi::Boolean::New(env, Collide(a, c, d));
+
+  return ret;
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("collide", Napi::Function::New(env, CollideNode));
+  return exports;
+}
+
+NODE_API_MODULE(collidertest, Init);
@@ -0,0 +1,239 @@
+#include <server/CollisionWorld.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+void ProjectileHitTest(Napi::Env);
+void ChunkRelevanceTest(Napi::Env);
+void CellSizeTest(Napi::Env);
+void BoundaryTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ProjectileHitTest(env);
+  ChunkRelevanceTest(env);
+  CellSizeTest(env);
+  BoundaryTest(env);
+}
+
+// a round asteroid, as a 12-gon
+static Asteroid MakeAsteroid(uint64_t id, Point2D<int> chunk, Point2D<float> pos, float radius) {
+  Asteroid a;
+  a.id = id;
+  a.position.chunk = chunk;
+  a.position.position = pos;
+  a.velocity = { 0.0f, 0.0f };
+  a.rotation = 0.0f;
+  a.rotation_velocity = 0.0f;
+  a.ver = 0;
+  a.last_update = 1.0;
+  for (int i = 0; i < 12; i++) {
+    double theta = (M_PI / 6) * i;
+    a.geometry.push_back({ static_cast<float>(std::cos(theta) * radius), static_cast<float>(std::sin(theta) * radius) });
+  }
+
+  return a;
+}
+
+// a projectile which moved from `start` to `end` over the second leading up to t = 1.0
+static Projectile MakeProjectile(uint64_t id, uint64_t ship_id, uint32_t client_id, WorldPosition start, WorldPosition end, int chunk_dims) {
+  Projectile p;
+  p.id = id;
+  p.ship_ID = ship_id;
+  p.client_ID = client_id;
+  p.origin = start;
+  p.position = end;
+
+  Point2D<float> dist = end.position - start.position;
+  dist.x += (end.chunk.x - start.chunk.x) * chunk_size;
+  dist.y += (end.chunk.y - start.chunk.y) * chunk_size;
+  // the short way around the world
+  const float world_size = chunk_size * chunk_dims;
+  dist.x -= world_size * std::round(dist.x / world_size);
+  dist.y -= world_size * std::round(dist.y / world_size);
+
+  p.velocity = dist;
+  p.rotation = 0.0f;
+  p.rotation_velocity = 0.0f;
+  p.ver = 0;
+  p.last_update = 1.0;
+  p.origin_time = 0.0;
+  p.creation_time = 0.0;
+  p.last_collision_delta = 0.0;
+  return p;
+}
+
+static WorldPosition At(Point2D<int> chunk, Point2D<float> pos) {
+  WorldPosition res;
+  res.chunk = chunk;
+  res.position = pos;
+  return res;
+}
+
+void ProjectileHitTest(Napi::Env env) {
+  CollisionWorld cw(16);
+  FlatHashMap<uint64_t, Point2D<int>> deleted;
+  std::vector<std::pair<WorldPosition, float>> split;
+  std::vector<uint64_t> destroyed;
+
+  // one asteroid in the projectile's path, one beside it, and one far away
+  cw.AddProjectile(MakeProjectile(1, 100, 7, At({3, 3}, {4.0f, 16.0f}), At({3, 3}, {28.0f, 16.0f}), 16));
+  cw.AddAsteroid(MakeAsteroid(2, {3, 3}, {16.0f, 16.0f}, 1.5f));
+  cw.AddAsteroid(MakeAsteroid(3, {3, 3}, {16.0f, 24.0f}, 1.5f));
+  cw.AddAsteroid(MakeAsteroid(4, {10, 10}, {16.0f, 16.0f}, 1.5f));
+
+  auto hits = cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_E(2, deleted.size(), env, "expected the projectile and one asteroid to be deleted");
+  ASSERT_T(deleted.count(1), env, "projectile which hit was not deleted");
+  ASSERT_T(deleted.count(2), env, "asteroid in the projectile's path was not hit");
+  ASSERT_T(!deleted.count(3), env, "asteroid beside the projectile's path was hit");
+  ASSERT_T(!deleted.count(4), env, "asteroid far from any projectile was hit");
+  ASSERT_T(deleted.count(2) && deleted.at(2) == Point2D<int>(3, 3), env, "asteroid deleted from the wrong chunk");
+
+  // the projectile's owner learns which of its shots were used up
+  ASSERT_E(1, hits.size(), env);
+  ASSERT_T(hits.count(100) && hits.at(100).count(7), env, "hit was not reported to the projectile's ship");
+
+  // big enough to split in two
+  ASSERT_E(1, split.size(), env);
+  ASSERT_N(1.5f * 0.707f, split[0].second, 0.01f, env, "split asteroids should be a bit smaller");
+  ASSERT_E(0, destroyed.size(), env, "no ships to destroy");
+
+  // a projectile which is used up doesn't keep going through a second asteroid
+  cw.clear();
+  deleted.clear();
+  split.clear();
+  cw.AddProjectile(MakeProjectile(1, 100, 7, At({3, 3}, {4.0f, 16.0f}), At({3, 3}, {28.0f, 16.0f}), 16));
+  cw.AddAsteroid(MakeAsteroid(2, {3, 3}, {10.0f, 16.0f}, 1.5f));
+  cw.AddAsteroid(MakeAsteroid(3, {3, 3}, {20.0f, 16.0f}, 1.5f));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_T(deleted.count(2), env, "first asteroid along the path was not hit");
+  ASSERT_T(!deleted.count(3), env, "projectile passed through an asteroid");
+
+  // tiny asteroids are destroyed outright
+  cw.clear();
+  deleted.clear();
+  split.clear();
+  cw.AddProjectile(MakeProjectile(1, 100, 7, At({3, 3}, {4.0f, 16.0f}), At({3, 3}, {28.0f, 16.0f}), 16));
+  cw.AddAsteroid(MakeAsteroid(2, {3, 3}, {16.0f, 16.0f}, 0.3f));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_T(deleted.count(2), env, "small asteroid was not hit");
+  ASSERT_E(0, split.size(), env, "small asteroid should not split");
+
+  std::cout << "projectile hit test passed!" << std::endl;
+}
+
+void ChunkRelevanceTest(Napi::Env env) {
+  CollisionWorld cw(16);
+
+  // nothing to hit anything -- no chunk needs its asteroids fed in
+  for (int x = 0; x < 16; x++) {
+    for (int y = 0; y < 16; y++) {
+      ASSERT_T(!cw.IsChunkRelevant({x, y}), env, "chunk is relevant with no projectiles");
+    }
+  }
+
+  // a projectile within chunk (3, 3) -- asteroids in neighboring chunks could reach into its path
+  cw.AddProjectile(MakeProjectile(1, 100, 7, At({3, 3}, {4.0f, 16.0f}), At({3, 3}, {28.0f, 16.0f}), 16));
+  for (int x = 0; x < 16; x++) {
+    for (int y = 0; y < 16; y++) {
+      bool near = (std::abs(x - 3) <= 1 && std::abs(y - 3) <= 1);
+      ASSERT_E(near, cw.IsChunkRelevant({x, y}), env, "only chunks around the projectile should be relevant");
+    }
+  }
+
+  // neighbors wrap around the world's edge
+  cw.clear();
+  ASSERT_T(!cw.IsChunkRelevant({3, 3}), env, "relevance survived a clear");
+  cw.AddProjectile(MakeProjectile(1, 100, 7, At({0, 0}, {1.0f, 16.0f}), At({0, 0}, {1.0f, 17.0f}), 16));
+  ASSERT_T(cw.IsChunkRelevant({15, 0}), env, "chunk across the world's edge is not relevant");
+  ASSERT_T(cw.IsChunkRelevant({15, 15}), env, "chunk across the world's corner is not relevant");
+  ASSERT_T(cw.IsChunkRelevant({1, 1}), env);
+  ASSERT_T(!cw.IsChunkRelevant({2, 0}), env);
+  ASSERT_T(!cw.IsChunkRelevant({14, 0}), env);
+
+  // asteroids which are only fed in from relevant chunks can still be hit
+  std::vector<std::pair<WorldPosition, float>> split;
+  FlatHashMap<uint64_t, Point2D<int>> deleted;
+  std::vector<uint64_t> destroyed;
+  cw.AddAsteroid(MakeAsteroid(2, {0, 0}, {1.0f, 16.5f}, 1.5f));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_T(deleted.count(2), env, "asteroid near a projectile was not hit");
+
+  std::cout << "chunk relevance test passed!" << std::endl;
+}
+
+void CellSizeTest(Napi::Env env) {
+  // cells always tile a chunk
+  ASSERT_N(4.0f, CollisionWorld(16).GetCellSize(), 0.0001f, env);
+  ASSERT_N(2.0f, CollisionWorld(16, 2.0f).GetCellSize(), 0.0001f, env);
+  ASSERT_N(chunk_size / 6, CollisionWorld(16, 5.0f).GetCellSize(), 0.0001f, env, "cell size was not rounded to tile a chunk");
+  ASSERT_N(chunk_size, CollisionWorld(16, 64.0f).GetCellSize(), 0.0001f, env, "cells should be at most a chunk wide");
+  ASSERT_N(1.0f, CollisionWorld(16, 0.01f).GetCellSize(), 0.0001f, env, "cells should be at least a unit wide");
+  ASSERT_N(4.0f, CollisionWorld(16, 0.0f).GetCellSize(), 0.0001f, env, "bad cell sizes should fall back to the default");
+
+  std::cout << "cell size test passed!" << std::endl;
+}
+
+// a projectile passing by an asteroid, whose center lies in a different cell
+struct BoundaryCase {
+  const char* name;
+  int chunk_dims;
+  WorldPosition start;
+  WorldPosition end;
+  Asteroid asteroid;
+  bool hit;
+};
+
+void BoundaryTest(Napi::Env env) {
+  std::vector<BoundaryCase> cases = {
+    // 1.1 units apart, within the asteroid's outline -- and 1.7 units apart, outside of it
+    { "across a cell edge", 16, At({3, 3}, {15.7f, 4.0f}), At({3, 3}, {15.7f, 28.0f}), MakeAsteroid(2, {3, 3}, {16.8f, 16.0f}, 1.5f), true },
+    { "beside a cell edge", 16, At({3, 3}, {15.7f, 4.0f}), At({3, 3}, {15.7f, 28.0f}), MakeAsteroid(2, {3, 3}, {17.4f, 16.0f}, 1.5f), false },
+    { "across a chunk edge", 16, At({3, 3}, {31.7f, 4.0f}), At({3, 3}, {31.7f, 28.0f}), MakeAsteroid(2, {4, 3}, {0.8f, 16.0f}, 1.5f), true },
+    { "across a chunk edge in y", 16, At({3, 3}, {4.0f, 31.7f}), At({3, 3}, {28.0f, 31.7f}), MakeAsteroid(2, {3, 4}, {16.0f, 0.8f}, 1.5f), true },
+    { "across the world's edge", 16, At({15, 5}, {31.7f, 4.0f}), At({15, 5}, {31.7f, 28.0f}), MakeAsteroid(2, {0, 5}, {0.8f, 16.0f}, 1.5f), true },
+    { "across the world's edge in y", 16, At({5, 0}, {4.0f, 0.3f}), At({5, 0}, {28.0f, 0.3f}), MakeAsteroid(2, {5, 15}, {16.0f, 31.2f}, 1.5f), true },
+    { "beside the world's edge", 16, At({15, 5}, {31.7f, 4.0f}), At({15, 5}, {31.7f, 28.0f}), MakeAsteroid(2, {0, 5}, {1.4f, 16.0f}, 1.5f), false },
+    // the projectile itself wraps around, from one side of the world to the other
+    { "through the world's edge", 16, At({15, 5}, {24.0f, 16.0f}), At({0, 5}, {8.0f, 16.0f}), MakeAsteroid(2, {0, 5}, {4.0f, 16.0f}, 1.5f), true },
+    { "through the world's edge in y", 16, At({5, 15}, {16.0f, 24.0f}), At({5, 0}, {16.0f, 8.0f}), MakeAsteroid(2, {5, 0}, {16.0f, 4.0f}, 1.5f), true },
+    { "through the world's corner", 16, At({15, 15}, {28.0f, 28.0f}), At({0, 0}, {4.0f, 4.0f}), MakeAsteroid(2, {0, 0}, {1.0f, 1.0f}, 1.5f), true },
+    // a single chunk wraps onto itself -- paths there are short, as they always take the short way around
+    { "across a one chunk world", 1, At({0, 0}, {31.7f, 12.0f}), At({0, 0}, {31.7f, 20.0f}), MakeAsteroid(2, {0, 0}, {0.8f, 16.0f}, 1.5f), true }
+  };
+
+  FlatHashMap<uint64_t, Point2D<int>> deleted;
+  std::vector<std::pair<WorldPosition, float>> split;
+  std::vector<uint64_t> destroyed;
+
+  // the grid is only a broadphase -- its size never changes what is hit
+  for (float cell_size : { 1.0f, 2.0f, 4.0f, 5.0f, 8.0f, 32.0f }) {
+    for (auto& c : cases) {
+      CollisionWorld cw(c.chunk_dims, cell_size);
+      deleted.clear();
+      split.clear();
+      cw.AddProjectile(MakeProjectile(1, 100, 7, c.start, c.end, c.chunk_dims));
+      cw.AddAsteroid(c.asteroid);
+      cw.ComputeCollisions(deleted, split, destroyed);
+      ASSERT_E(c.hit, static_cast<bool>(deleted.count(2)), env, std::string(c.name) + ", with cells " + std::to_string(cell_size) + " wide");
+      ASSERT_E(c.hit, static_cast<bool>(deleted.count(1)), env, std::string(c.name) + ": projectile");
+    }
+  }
+
+  std::cout << "boundary test passed!" << std::endl;
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNCOLLISIONWORLDTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(collisionworldtest, Init);
@@ -0,0 +1,127 @@
+#include <FlatHashMap.hpp>
+#include <GameTypes.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <random>
+#include <unordered_map>
+
+using namespace vasteroids;
+
+void InsertTest(Napi::Env);
+void EraseTest(Napi::Env);
+void PointTest(Napi::Env);
+void StressTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  InsertTest(env);
+  EraseTest(env);
+  PointTest(env);
+  StressTest(env);
+}
+
+void InsertTest(Napi::Env env) {
+  FlatHashMap<uint64_t, int> map;
+  ASSERT_E(0, map.bucket_count(), env);
+  ASSERT_T(map.insert(std::make_pair(1, 1)).second, env);
+  ASSERT_T(map.insert(std::make_pair(2, 2)).second, env);
+  // duplicate keys keep the old value
+  ASSERT_T(!map.insert(std::make_pair(1, 5)).second, env);
+  ASSERT_E(1, map.at(1), env);
+  ASSERT_E(2, map.size(), env);
+
+  map[3] = 3;
+  map[1] = 4;
+  ASSERT_E(4, map.at(1), env);
+  ASSERT_E(3, map.size(), env);
+  ASSERT_T(map.find(7) == map.end(), env);
+  ASSERT_E(0, map.count(7), env);
+  ASSERT_T(map.bucket_count() >= map.size(), env);
+  std::cout << "insert test passed!" << std::endl;
+}
+
+void EraseTest(Napi::Env env) {
+  FlatHashSet<uint64_t> set;
+  for (uint64_t i = 0; i < 1000; i++) {
+    set.insert(i);
+  }
+
+  // erase while iterating, like the chunk update loops
+  auto itr = set.begin();
+  while (itr != set.end()) {
+    if (*itr % 2) {
+      itr = set.erase(itr);
+    } else {
+      itr++;
+    }
+  }
+
+  ASSERT_E(500, set.size(), env);
+  for (uint64_t i = 0; i < 1000; i++) {
+    ASSERT_E(static_cast<size_t>(i % 2 ? 0 : 1), set.count(i), env);
+  }
+
+  ASSERT_E(1, set.erase(0), env);
+  ASSERT_E(0, set.erase(0), env);
+  size_t buckets = set.bucket_count();
+  set.clear();
+  ASSERT_T(set.empty(), env);
+  ASSERT_E(buckets, set.bucket_count(), env);
+  ASSERT_T(set.begin() == set.end(), env);
+}
+
+void PointTest(Napi::Env env) {
+  // negative coordinates used to clobber each other in the old hash
+  std::hash<Point2D<int>> hash;
+  ASSERT_T(hash(Point2D<int>(0, -1)) != hash(Point2D<int>(1, -1)), env);
+  ASSERT_T(hash(Point2D<int>(-1, 0)) != hash(Point2D<int>(0, -1)), env);
+
+  FlatHashMap<Point2D<int>, int> map;
+  for (int x = -16; x < 16; x++) {
+    for (int y = -16; y < 16; y++) {
+      map.insert(std::make_pair(Point2D<int>(x, y), x * 100 + y));
+    }
+  }
+
+  ASSERT_E(1024, map.size(), env);
+  for (int x = -16; x < 16; x++) {
+    for (int y = -16; y < 16; y++) {
+      ASSERT_E(x * 100 + y, map.at(Point2D<int>(x, y)), env);
+    }
+  }
+}
+
+void StressTest(Napi::Env env) {
+  // churn against std::unordered_map, so that tombstones pile up and get cleaned out
+  std::mt19937_64 gen(1);
+  FlatHashMap<uint64_t, uint64_t> map;
+  std::unordered_map<uint64_t, uint64_t> expected;
+  for (int i = 0; i < 1000000; i++) {
+    uint64_t key = gen() % 4096;
+    if (gen() % 2) {
+      map[key] = i;
+      expected[key] = i;
+    } else {
+      ASSERT_E(expected.erase(key), map.erase(key), env);
+    }
+  }
+
+  ASSERT_E(expected.size(), map.size(), env);
+  size_t count = 0;
+  for (auto& entry : map) {
+    ASSERT_E(expected.at(entry.first), entry.second, env);
+    count++;
+  }
+
+  ASSERT_E(expected.size(), count, env);
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNFLATHASHTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(flathashtest, Init);
@@ -0,0 +1,114 @@
+#include <RandomStream.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <limits>
+#include <vector>
+
+using namespace vasteroids;
+
+void ReproduceTest(Napi::Env);
+void IndependenceTest(Napi::Env);
+void SeekTest(Napi::Env);
+void RangeTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ReproduceTest(env);
+  IndependenceTest(env);
+  SeekTest(env);
+  RangeTest(env);
+}
+
+void ReproduceTest(Napi::Env env) {
+  RandomStream a(1234, RandomPurpose::ASTEROID, Point2D<int>(3, 7));
+  RandomStream b(1234, RandomPurpose::ASTEROID, Point2D<int>(3, 7));
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_T(a() == b(), env, "same key produced different streams");
+  }
+
+  std::cout << "reproduce test passed!" << std::endl;
+}
+
+void IndependenceTest(Napi::Env env) {
+  // streams which differ in any part of their key should share nothing
+  std::vector<RandomStream> streams = {
+    RandomStream(1234, RandomPurpose::ASTEROID, Point2D<int>(3, 7)),
+    RandomStream(1235, RandomPurpose::ASTEROID, Point2D<int>(3, 7)),
+    RandomStream(1234, RandomPurpose::WORLD, Point2D<int>(3, 7)),
+    RandomStream(1234, RandomPurpose::ASTEROID, Point2D<int>(7, 3)),
+    RandomStream(1234, RandomPurpose::ASTEROID, Point2D<int>(-3, 7)),
+    RandomStream(1234, RandomPurpose::ASTEROID, Point2D<int>(3, 7)).Substream(1)
+  };
+
+  std::vector<std::vector<uint64_t>> values(streams.size());
+  for (size_t i = 0; i < streams.size(); i++) {
+    for (int j = 0; j < 64; j++) {
+      values[i].push_back(streams[i]());
+    }
+  }
+
+  for (size_t i = 0; i < values.size(); i++) {
+    for (size_t j = i + 1; j < values.size(); j++) {
+      for (auto x : values[i]) {
+        for (auto y : values[j]) {
+          ASSERT_T(x != y, env, "distinct streams overlap");
+        }
+      }
+    }
+  }
+}
+
+void SeekTest(Napi::Env env) {
+  RandomStream a(99, RandomPurpose::SPAWN_CHUNKS);
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 16; i++) {
+    values.push_back(a());
+  }
+
+  ASSERT_E(16, a.GetCounter(), env);
+
+  RandomStream b(99, RandomPurpose::SPAWN_CHUNKS);
+  b.Seek(10);
+  ASSERT_T(values[10] == b(), env, "seeking did not land on the expected value");
+  ASSERT_T(values[11] == b(), env);
+}
+
+void RangeTest(Napi::Env env) {
+  RandomStream rng(5, RandomPurpose::WORLD);
+  std::vector<int> hits(6, 0);
+  double sum = 0.0;
+  const int samples = 600000;
+  for (int i = 0; i < samples; i++) {
+    double d = rng.NextDouble();
+    ASSERT_T(d >= 0.0 && d < 1.0, env);
+    sum += d;
+
+    float f = rng.NextFloat(-2.0f, 2.0f);
+    ASSERT_T(f >= -2.0f && f <= 2.0f, env);
+
+    int n = rng.NextInt(1, 6);
+    ASSERT_T(n >= 1 && n <= 6, env);
+    hits[n - 1]++;
+  }
+
+  ASSERT_N(0.5, sum / samples, 0.005, env);
+  for (int h : hits) {
+    // expected 100000 +- ~300
+    ASSERT_N(100000.0, h, 2000.0, env);
+  }
+
+  // full range shouldn't overflow
+  for (int i = 0; i < 1000; i++) {
+    rng.NextInt(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+  }
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNRANDOMTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(randomtest, Init);
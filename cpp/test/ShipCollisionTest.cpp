@@ -0,0 +1,243 @@
+#include <server/CollisionWorld.hpp>
+#include <server/World.hpp>
+#include <Clock.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+void ProjectileShipTest(Napi::Env);
+void AsteroidShipTest(Napi::Env);
+void InvulnerabilityTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ProjectileShipTest(env);
+  AsteroidShipTest(env);
+  InvulnerabilityTest(env);
+}
+
+static Ship MakeShip(uint64_t id, Point2D<int> chunk, Point2D<float> pos) {
+  Ship s;
+  s.id = id;
+  s.name = "ship " + std::to_string(id);
+  s.position.chunk = chunk;
+  s.position.position = pos;
+  s.velocity = { 0.0f, 0.0f };
+  s.rotation = 0.0f;
+  s.rotation_velocity = 0.0f;
+  s.ver = 0;
+  s.last_update = 1.0;
+  return s;
+}
+
+// a round asteroid, as a 12-gon
+static Asteroid MakeAsteroid(uint64_t id, Point2D<int> chunk, Point2D<float> pos, float radius) {
+  Asteroid a;
+  a.id = id;
+  a.position.chunk = chunk;
+  a.position.position = pos;
+  a.velocity = { 0.0f, 0.0f };
+  a.rotation = 0.0f;
+  a.rotation_velocity = 0.0f;
+  a.ver = 0;
+  a.last_update = 1.0;
+  for (int i = 0; i < 12; i++) {
+    double theta = (M_PI / 6) * i;
+    a.geometry.push_back({ static_cast<float>(std::cos(theta) * radius), static_cast<float>(std::sin(theta) * radius) });
+  }
+
+  return a;
+}
+
+// a projectile fired by `ship_id`, which moved along x from `start` over the second leading up to t = 1.0
+static Projectile MakeProjectile(uint64_t id, uint64_t ship_id, uint32_t client_id, Point2D<int> chunk, Point2D<float> start, float distance) {
+  Projectile p;
+  p.id = id;
+  p.ship_ID = ship_id;
+  p.client_ID = client_id;
+  p.origin.chunk = chunk;
+  p.origin.position = start;
+  p.position = p.origin;
+  p.position.position.x += distance;
+  p.velocity = { distance, 0.0f };
+  p.rotation = 0.0f;
+  p.rotation_velocity = 0.0f;
+  p.ver = 0;
+  p.last_update = 1.0;
+  p.origin_time = 0.0;
+  p.creation_time = 0.0;
+  p.last_collision_delta = 0.0;
+  return p;
+}
+
+void ProjectileShipTest(Napi::Env env) {
+  CollisionWorld cw(16);
+  FlatHashMap<uint64_t, Point2D<int>> deleted;
+  std::vector<std::pair<WorldPosition, float>> split;
+  std::vector<uint64_t> destroyed;
+
+  // ship 10 fires through itself, then into ship 11
+  cw.AddProjectile(MakeProjectile(1, 10, 7, {3, 3}, {9.5f, 16.0f}, 8.0f));
+  cw.AddShip(MakeShip(10, {3, 3}, {10.0f, 16.0f}));
+  cw.AddShip(MakeShip(11, {3, 3}, {16.0f, 16.0f}));
+  auto hits = cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_E(1, destroyed.size(), env, "expected one ship to be destroyed");
+  ASSERT_T(std::count(destroyed.begin(), destroyed.end(), 11), env, "ship in the projectile's path was not destroyed");
+  ASSERT_T(!std::count(destroyed.begin(), destroyed.end(), 10), env, "ship was destroyed by its own projectile");
+  ASSERT_T(deleted.count(1), env, "projectile which hit a ship was not deleted");
+  ASSERT_T(hits.count(10) && hits.at(10).count(7), env, "hit was not reported to the projectile's ship");
+  ASSERT_E(0, split.size(), env, "ships don't split");
+
+  // a projectile which only passes through its own ship carries on
+  cw.clear();
+  deleted.clear();
+  destroyed.clear();
+  cw.AddProjectile(MakeProjectile(1, 10, 7, {3, 3}, {9.5f, 16.0f}, 4.0f));
+  cw.AddShip(MakeShip(10, {3, 3}, {10.0f, 16.0f}));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_E(0, destroyed.size(), env, "ship was destroyed by its own projectile");
+  ASSERT_E(0, deleted.size(), env, "projectile was used up on its own ship");
+
+  // two projectiles into the same ship -- it's only destroyed once, and the second shot carries on
+  cw.clear();
+  deleted.clear();
+  destroyed.clear();
+  cw.AddProjectile(MakeProjectile(1, 10, 7, {3, 3}, {12.0f, 16.0f}, 8.0f));
+  cw.AddProjectile(MakeProjectile(2, 12, 8, {3, 3}, {14.0f, 16.0f}, 8.0f));
+  cw.AddShip(MakeShip(11, {3, 3}, {16.0f, 16.0f}));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_E(1, destroyed.size(), env, "ship was destroyed more than once");
+  ASSERT_E(1, deleted.size(), env, "both projectiles were used up on one ship");
+
+  // across the world's edge
+  cw.clear();
+  deleted.clear();
+  destroyed.clear();
+  cw.AddProjectile(MakeProjectile(1, 10, 7, {15, 5}, {28.0f, 16.0f}, 8.0f));
+  cw.AddShip(MakeShip(11, {0, 5}, {2.0f, 16.0f}));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_E(1, destroyed.size(), env, "ship across the world's edge was not destroyed");
+
+  // projectiles passing beside a ship miss it
+  cw.clear();
+  deleted.clear();
+  destroyed.clear();
+  cw.AddProjectile(MakeProjectile(1, 10, 7, {3, 3}, {12.0f, 16.2f}, 8.0f));
+  cw.AddShip(MakeShip(11, {3, 3}, {16.0f, 16.0f}));
+  cw.ComputeCollisions(deleted, split, destroyed);
+  ASSERT_E(0, destroyed.size(), env, "ship was destroyed by a projectile which missed it");
+
+  std::cout << "projectile ship test passed!" << std::endl;
+}
+
+void AsteroidShipTest(Napi::Env env) {
+  CollisionWorld cw(16);
+  FlatHashMap<uint64_t, Point2D<int>> deleted;
+  std::vector<std::pair<WorldPosition, float>> split;
+  std::vector<uint64_t> destroyed;
+
+  // ships are destroyed by asteroids they touch -- the asteroids survive
+  cw.AddShip(MakeShip(10, {3, 3}, {10.0f, 16.0f}));
+  cw.AddShip(MakeShip(11, {3, 3}, {20.0f, 16.0f}));
+  cw.AddShip(MakeShip(12, {15, 5}, {31.0f, 16.0f}));
+  cw.AddAsteroid(MakeAsteroid(1, {3, 3}, {11.0f, 16.0f}, 1.5f));
+  cw.AddAsteroid(MakeAsteroid(2, {3, 3}, {24.0f, 16.0f}, 1.5f));
+  cw.AddAsteroid(MakeAsteroid(3, {0, 5}, {0.2f, 16.0f}, 1.5f));
+  cw.ComputeCollisions(deleted, split, destroyed);
+
+  std::sort(destroyed.begin(), destroyed.end());
+  ASSERT_E(2, destroyed.size(), env, "expected two ships to be destroyed");
+  ASSERT_T(destroyed.size() == 2 && destroyed[0] == 10, env, "ship touching an asteroid was not destroyed");
+  ASSERT_T(destroyed.size() == 2 && destroyed[1] == 12, env, "ship touching an asteroid across the world's edge was not destroyed");
+  ASSERT_E(0, deleted.size(), env, "asteroids should survive hitting ships");
+  ASSERT_E(0, split.size(), env);
+
+  std::cout << "asteroid ship test passed!" << std::endl;
+}
+
+// moves a ship into place, firing `shots` from it
+static void MoveShip(World& world, uint64_t id, Point2D<float> pos, std::vector<Projectile> shots) {
+  client::ClientPacket packet;
+  packet.client_ship = MakeShip(id, {2, 2}, pos);
+  packet.projectiles = shots;
+  world.HandleClientPacket(packet);
+}
+
+// a projectile fired along x at `time`, as a client sends it
+static Projectile Fire(uint32_t client_id, Point2D<float> pos, double time) {
+  Projectile p = MakeProjectile(0, 0, client_id, {2, 2}, pos, 8.0f);
+  p.position = p.origin;
+  p.last_update = time;
+  return p;
+}
+
+void InvulnerabilityTest(Napi::Env env) {
+  auto clock = std::make_shared<VirtualClock>();
+  WorldOptions options;
+  options.has_seed = true;
+  options.seed = 29;
+  options.clock = clock;
+
+  // no asteroids -- the only thing which can destroy a ship is another ship
+  std::string error;
+  auto world = World::Create(8, 0, options, error);
+  ASSERT_T(world != nullptr, env, error);
+  if (world == nullptr) {
+    return;
+  }
+
+  uint64_t a = world->AddShip("a")->id;
+  uint64_t b = world->AddShip("b")->id;
+
+  // a fires through itself and into b, just after both have spawned
+  MoveShip(*world, b, {16.0f, 16.0f}, {});
+  MoveShip(*world, a, {10.0f, 16.0f}, { Fire(1, {9.5f, 16.0f}, 0.0) });
+
+  FlatHashMap<uint64_t, ServerPacket> packets;
+  clock->Reset(1.0);
+  world->UpdateSim(&packets);
+  ASSERT_T(!packets[a].destroyed, env, "ship was destroyed by its own projectile");
+  ASSERT_T(!packets[b].destroyed, env, "freshly spawned ship was destroyed");
+
+  // the same shot, once b's invulnerability has run out
+  clock->Reset(4.0);
+  world->UpdateSim(&packets);
+  MoveShip(*world, b, {16.0f, 16.0f}, {});
+  MoveShip(*world, a, {10.0f, 16.0f}, { Fire(2, {9.5f, 16.0f}, 4.0) });
+
+  packets.clear();
+  clock->Reset(5.0);
+  world->UpdateSim(&packets);
+  ASSERT_T(!packets[a].destroyed, env, "ship was destroyed by its own projectile");
+  ASSERT_T(packets[b].destroyed, env, "ship was not destroyed once its invulnerability ran out");
+
+  // respawning makes a ship invulnerable again
+  ASSERT_T(world->RespawnShip(b) != nullptr, env, "destroyed ship could not respawn");
+  world->UpdateSim(&packets);
+  MoveShip(*world, b, {16.0f, 16.0f}, {});
+  MoveShip(*world, a, {10.0f, 16.0f}, { Fire(3, {9.5f, 16.0f}, 5.0) });
+
+  packets.clear();
+  clock->Reset(6.0);
+  world->UpdateSim(&packets);
+  ASSERT_T(!packets[b].destroyed, env, "freshly respawned ship was destroyed");
+
+  std::cout << "invulnerability test passed!" << std::endl;
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNSHIPCOLLISIONTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(shipcollisiontest, Init);
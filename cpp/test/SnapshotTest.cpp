@@ -0,0 +1,219 @@
+#include <server/Chunk.hpp>
+#include <server/WorldSnapshot.hpp>
+#include <AsteroidGenerator.hpp>
+#include <RandomStream.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+void ChunkRoundTripTest(Napi::Env);
+void TruncatedChunkTest(Napi::Env);
+void TickLogTest(Napi::Env);
+void SnapshotWriterTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ChunkRoundTripTest(env);
+  TruncatedChunkTest(env);
+  TickLogTest(env);
+  SnapshotWriterTest(env);
+}
+
+static void FillChunk(Chunk& c) {
+  RandomStream rng(7, RandomPurpose::ASTEROID);
+  for (int i = 0; i < 4; i++) {
+    Asteroid a = GenerateAsteroid(1.5f, 12, rng);
+    a.id = 10 + i;
+    a.position.chunk = {3, 4};
+    a.position.position = {4.0f * i, 2.0f};
+    a.velocity = {0.5f, -0.25f};
+    a.ver = i;
+    c.InsertAsteroid(a);
+  }
+
+  Ship s;
+  s.id = 1;
+  s.name = "snapshot";
+  s.position.chunk = {3, 4};
+  s.position.position = {16.0f, 16.0f};
+  s.score = 120;
+  s.lives = 2;
+  s.spawn_time = 3.5;
+  c.InsertShip(s);
+
+  Projectile p;
+  p.id = 20;
+  p.ship_ID = 1;
+  p.client_ID = 4;
+  p.position = s.position;
+  p.origin = s.position;
+  p.creation_time = 3.75;
+  c.InsertProjectile(p);
+}
+
+void ChunkRoundTripTest(Napi::Env env) {
+  Chunk c(1.0);
+  FillChunk(c);
+
+  BinaryWriter out;
+  c.Serialize(out);
+
+  // the encoding is kept until the chunk changes, and never changes itself
+  SharedBytes encoded = c.Encode();
+  ASSERT_T(*encoded == out.Data(), env, "kept encoding differs from Serialize");
+  ASSERT_T(c.Encode() == encoded, env, "unchanged chunk was encoded again");
+  c.GetAsteroid(10)->ver++;
+  ASSERT_T(c.Encode() != encoded, env, "changed chunk kept its old encoding");
+  ASSERT_T(*encoded == out.Data(), env, "shared encoding was modified");
+  c.GetAsteroid(10)->ver--;
+
+  Chunk copy(0.0);
+  BinaryReader in(out.Data().data(), out.size());
+  ASSERT_T(copy.Deserialize(in), env, "could not read back a chunk");
+  ASSERT_E(0, in.Remaining(), env, "chunk left bytes unread");
+
+  // the copy should write out byte for byte the same
+  BinaryWriter out_copy;
+  copy.Serialize(out_copy);
+  ASSERT_T(out.Data() == out_copy.Data(), env, "restored chunk does not match");
+
+  ASSERT_E(4, copy.GetAsteroidCount(), env);
+  Ship* s = copy.GetShip(1);
+  ASSERT_T(s != nullptr, env, "ship went missing");
+  ASSERT_E(std::string("snapshot"), s->name, env);
+  ASSERT_E(120, s->score, env);
+  ASSERT_E(2, s->lives, env);
+
+  Asteroid* a = copy.GetAsteroid(12);
+  ASSERT_T(a != nullptr, env, "asteroid went missing");
+  ASSERT_E(12, a->geometry.size(), env);
+  ASSERT_E(2, a->ver, env);
+
+  Projectile* p = copy.GetProjectile(20);
+  ASSERT_T(p != nullptr, env, "projectile went missing");
+  ASSERT_E(4, p->client_ID, env);
+  ASSERT_N(3.75, p->creation_time, 0.0001, env);
+
+  std::cout << "chunk round trip test passed!" << std::endl;
+}
+
+void TruncatedChunkTest(Napi::Env env) {
+  Chunk c(1.0);
+  FillChunk(c);
+
+  BinaryWriter out;
+  c.Serialize(out);
+
+  // every cut should be caught, rather than read past the end
+  for (size_t len = 0; len < out.size(); len += 7) {
+    Chunk copy(0.0);
+    BinaryReader in(out.Data().data(), len);
+    ASSERT_T(!copy.Deserialize(in), env, "truncated chunk was accepted");
+  }
+}
+
+void TickLogTest(Napi::Env env) {
+  std::string path = "snapshottest.wal";
+  std::remove(path.c_str());
+
+  TickLog log;
+  ASSERT_T(log.Open(path), env, "could not open log");
+  for (uint8_t i = 0; i < 3; i++) {
+    std::vector<uint8_t> entry(i + 1, i);
+    log.Append(entry);
+  }
+
+  log.Close();
+
+  // reopening appends
+  ASSERT_T(log.Open(path), env);
+  log.Append(std::vector<uint8_t>(5, 3));
+  log.Flush();
+
+  MappedFile file(path);
+  ASSERT_T(file.ok(), env, "could not map log");
+
+  std::vector<std::vector<uint8_t>> entries;
+  auto collect = [&entries](const uint8_t* data, size_t len) {
+    entries.push_back(std::vector<uint8_t>(data, data + len));
+  };
+
+  ASSERT_E(4, TickLog::ForEachEntry(file.Data(), file.size(), collect), env);
+  ASSERT_E(3, entries[2].size(), env);
+  ASSERT_E(2, entries[2][0], env);
+  ASSERT_E(5, entries[3].size(), env);
+
+  // a torn write at the end loses only the last entry
+  entries.clear();
+  ASSERT_E(3, TickLog::ForEachEntry(file.Data(), file.size() - 2, collect), env);
+
+  // as does a corrupt one
+  std::vector<uint8_t> corrupt(file.Data(), file.Data() + file.size());
+  corrupt.back() ^= 0xFF;
+  entries.clear();
+  ASSERT_E(3, TickLog::ForEachEntry(corrupt.data(), corrupt.size(), collect), env);
+
+  log.Close();
+  std::remove(path.c_str());
+}
+
+void SnapshotWriterTest(Napi::Env env) {
+  std::string path = "snapshottest.snap";
+  std::string obsolete = "snapshottest.old";
+  std::remove(path.c_str());
+
+  TickLog old_log;
+  old_log.Open(obsolete);
+  old_log.Close();
+
+  std::vector<uint8_t> bytes(1 << 20);
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<uint8_t>(i * 31);
+  }
+
+  // shared pieces land between the bytes written around them
+  SegmentedWriter data;
+  data.Put<uint32_t>(7);
+  data.PutShared(std::make_shared<const std::vector<uint8_t>>(bytes));
+  data.PutShared(std::make_shared<const std::vector<uint8_t>>());
+  data.PutBytes(bytes.data(), 3);
+  data.PutShared(std::make_shared<const std::vector<uint8_t>>(bytes.begin(), bytes.begin() + 5));
+  ASSERT_E(sizeof(uint32_t) + bytes.size() + 3 + 5, data.size(), env);
+
+  std::vector<uint8_t> expected(4);
+  uint32_t seven = 7;
+  std::memcpy(expected.data(), &seven, sizeof(seven));
+  expected.insert(expected.end(), bytes.begin(), bytes.end());
+  expected.insert(expected.end(), bytes.begin(), bytes.begin() + 3);
+  expected.insert(expected.end(), bytes.begin(), bytes.begin() + 5);
+  ASSERT_T(data.Join() == expected, env, "segments joined out of order");
+
+  SnapshotWriter writer;
+  ASSERT_T(writer.Write(path, data, { obsolete }), env, "writer refused a snapshot");
+  writer.Wait();
+  ASSERT_T(!writer.IsBusy(), env);
+
+  MappedFile file(path);
+  ASSERT_T(file.ok(), env, "snapshot was not written");
+  ASSERT_T(std::vector<uint8_t>(file.Data(), file.Data() + file.size()) == expected, env, "snapshot contents differ");
+  ASSERT_T(!MappedFile(obsolete).ok(), env, "obsolete file was not removed");
+
+  std::remove(path.c_str());
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNSNAPSHOTTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(snapshottest, Init);
@@ -0,0 +1,252 @@
+#include <server/SweepAndPrune.hpp>
+#include <AsteroidCollider.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace vasteroids;
+using namespace vasteroids::server;
+
+void PairTest(Napi::Env);
+void WrapTest(Napi::Env);
+void TinyWorldTest(Napi::Env);
+void BounceTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PairTest(env);
+  WrapTest(env);
+  TinyWorldTest(env);
+  BounceTest(env);
+}
+
+// a round asteroid, as a 12-gon
+static Asteroid MakeAsteroid(uint64_t id, Point2D<int> chunk, Point2D<float> pos, float radius) {
+  Asteroid a;
+  a.id = id;
+  a.position.chunk = chunk;
+  a.position.position = pos;
+  a.velocity = { 0.0f, 0.0f };
+  a.rotation = 0.0f;
+  a.rotation_velocity = 0.0f;
+  a.ver = 0;
+  a.last_update = 0.0;
+  for (int i = 0; i < 12; i++) {
+    double theta = (M_PI / 6) * i;
+    a.geometry.push_back({ static_cast<float>(std::cos(theta) * radius), static_cast<float>(std::sin(theta) * radius) });
+  }
+
+  return a;
+}
+
+// ids of a pair of asteroids, lowest first
+typedef std::pair<uint64_t, uint64_t> IdPair;
+
+// runs a tick over `asteroids`, returning the pairs found in sorted order
+static std::vector<IdPair> FindPairs(SweepAndPrune& sweep, const std::vector<Asteroid>& asteroids) {
+  sweep.BeginTick();
+  for (auto& a : asteroids) {
+    sweep.Update(a);
+  }
+
+  std::vector<AsteroidPair> pairs;
+  sweep.FindPairs(pairs);
+
+  std::vector<IdPair> res;
+  for (auto& p : pairs) {
+    res.push_back(IdPair(std::min(p.id_a, p.id_b), std::max(p.id_a, p.id_b)));
+  }
+
+  std::sort(res.begin(), res.end());
+  return res;
+}
+
+void PairTest(Napi::Env env) {
+  SweepAndPrune sweep(16);
+  std::vector<Asteroid> asteroids = {
+    MakeAsteroid(1, {3, 3}, {10.0f, 10.0f}, 1.5f),
+    // bounds overlap 1
+    MakeAsteroid(2, {3, 3}, {12.0f, 10.0f}, 1.5f),
+    // overlaps 1 along x only
+    MakeAsteroid(3, {3, 3}, {10.0f, 14.0f}, 1.5f),
+    // far from everything
+    MakeAsteroid(4, {3, 3}, {31.0f, 24.0f}, 1.5f),
+    // bounds overlap 4 from the next chunk
+    MakeAsteroid(5, {4, 3}, {0.5f, 24.0f}, 1.5f)
+  };
+
+  auto pairs = FindPairs(sweep, asteroids);
+  ASSERT_E(2, pairs.size(), env, "expected two overlapping pairs");
+  ASSERT_T(pairs.size() == 2 && pairs[0] == IdPair(1, 2), env, "missed a pair within a chunk");
+  ASSERT_T(pairs.size() == 2 && pairs[1] == IdPair(4, 5), env, "missed a pair across chunks");
+  ASSERT_E(5, sweep.size(), env);
+
+  // pairs report the chunks their asteroids are in
+  std::vector<AsteroidPair> raw;
+  sweep.BeginTick();
+  sweep.Update(asteroids[3]);
+  sweep.Update(asteroids[4]);
+  sweep.FindPairs(raw);
+  ASSERT_E(1, raw.size(), env);
+  for (auto& p : raw) {
+    ASSERT_T(p.chunk_a == (p.id_a == 4 ? Point2D<int>(3, 3) : Point2D<int>(4, 3)), env, "pair has the wrong chunk");
+    ASSERT_T(p.chunk_b == (p.id_b == 4 ? Point2D<int>(3, 3) : Point2D<int>(4, 3)), env, "pair has the wrong chunk");
+  }
+
+  // asteroids which weren't updated this tick are dropped
+  ASSERT_E(2, sweep.size(), env, "stale asteroids were kept");
+
+  // asteroids keep moving between ticks -- the sweep should follow them
+  asteroids[0].position.position = { 30.0f, 22.0f };
+  pairs = FindPairs(sweep, { asteroids[0], asteroids[1], asteroids[3] });
+  ASSERT_E(1, pairs.size(), env);
+  ASSERT_T(pairs.size() == 1 && pairs[0] == IdPair(1, 4), env, "moved asteroid was not tracked");
+  ASSERT_E(3, sweep.size(), env);
+
+  pairs = FindPairs(sweep, {});
+  ASSERT_E(0, pairs.size(), env);
+  ASSERT_E(0, sweep.size(), env, "empty tick should drop every asteroid");
+
+  std::cout << "pair test passed!" << std::endl;
+}
+
+void WrapTest(Napi::Env env) {
+  SweepAndPrune sweep(16);
+
+  // across the world's edge in x, y, and at the corner.
+  // 1 and 5 run past the edge, while 2 and 6 lie wholly at the start of the world
+  auto pairs = FindPairs(sweep, {
+    MakeAsteroid(1, {15, 5}, {31.0f, 16.0f}, 1.5f),
+    MakeAsteroid(2, {0, 5}, {1.8f, 16.0f}, 1.5f),
+    MakeAsteroid(3, {5, 15}, {16.0f, 31.0f}, 1.5f),
+    MakeAsteroid(4, {5, 0}, {16.0f, 1.8f}, 1.5f),
+    MakeAsteroid(5, {15, 15}, {31.0f, 31.0f}, 1.5f),
+    MakeAsteroid(6, {0, 0}, {1.8f, 1.8f}, 1.5f),
+    // its bounds start before the edge
+    MakeAsteroid(7, {15, 10}, {31.5f, 16.0f}, 1.5f),
+    MakeAsteroid(8, {0, 10}, {0.5f, 16.0f}, 1.5f)
+  });
+
+  ASSERT_E(4, pairs.size(), env, "expected a pair across each edge");
+  ASSERT_T(std::count(pairs.begin(), pairs.end(), IdPair(7, 8)), env, "missed a pair straddling the world's edge");
+
+  ASSERT_T(std::count(pairs.begin(), pairs.end(), IdPair(1, 2)), env, "missed a pair across the world's edge in x");
+  ASSERT_T(std::count(pairs.begin(), pairs.end(), IdPair(3, 4)), env, "missed a pair across the world's edge in y");
+  ASSERT_T(std::count(pairs.begin(), pairs.end(), IdPair(5, 6)), env, "missed a pair across the world's corner");
+
+  // straddling the edge, just short of each other
+  pairs = FindPairs(sweep, {
+    MakeAsteroid(1, {15, 5}, {30.0f, 16.0f}, 1.5f),
+    MakeAsteroid(2, {0, 5}, {1.5f, 16.0f}, 1.5f)
+  });
+
+  ASSERT_E(0, pairs.size(), env, "asteroids too far apart across the edge were paired");
+
+  std::cout << "wrap test passed!" << std::endl;
+}
+
+void TinyWorldTest(Napi::Env env) {
+  // in a one chunk world, big asteroids overlap both directly and around the edge -- each pair should come up once
+  SweepAndPrune sweep(1);
+  auto pairs = FindPairs(sweep, {
+    MakeAsteroid(1, {0, 0}, {2.0f, 16.0f}, 10.0f),
+    MakeAsteroid(2, {0, 0}, {20.0f, 16.0f}, 10.0f)
+  });
+
+  ASSERT_E(1, pairs.size(), env, "pair was reported more than once");
+
+  // asteroids wider than the world overlap themselves, which isn't a pair
+  std::vector<Asteroid> asteroids;
+  for (int i = 0; i < 6; i++) {
+    asteroids.push_back(MakeAsteroid(i + 1, {0, 0}, {5.0f * i, 3.0f * i}, 20.0f));
+  }
+
+  pairs = FindPairs(sweep, asteroids);
+  ASSERT_E(15, pairs.size(), env, "expected every pair of six asteroids once");
+  for (size_t i = 0; i < pairs.size(); i++) {
+    ASSERT_T(pairs[i].first != pairs[i].second, env, "asteroid was paired with itself");
+    ASSERT_T(i == 0 || pairs[i] != pairs[i - 1], env, "pair was reported more than once");
+  }
+
+  // two chunks -- every pair overlaps, some only around the edge
+  SweepAndPrune sweep_two(2);
+  pairs = FindPairs(sweep_two, {
+    MakeAsteroid(1, {0, 1}, {4.0f, 0.0f}, 20.0f),
+    MakeAsteroid(2, {1, 0}, {20.0f, 0.0f}, 20.0f),
+    MakeAsteroid(3, {1, 1}, {12.0f, 31.0f}, 20.0f)
+  });
+
+  ASSERT_E(3, pairs.size(), env, "expected every pair of three asteroids once");
+
+  std::cout << "tiny world test passed!" << std::endl;
+}
+
+void BounceTest(Napi::Env env) {
+  // overlapping, and heading into each other -- equal masses swap velocities
+  Asteroid a = MakeAsteroid(1, {3, 3}, {10.0f, 16.0f}, 1.5f);
+  Asteroid b = MakeAsteroid(2, {3, 3}, {12.5f, 16.0f}, 1.5f);
+  a.velocity = { 1.0f, 0.5f };
+  b.velocity = { -1.0f, 0.5f };
+  ASSERT_T(Collide(a, b, 16), env, "asteroids should overlap");
+  ASSERT_T(BounceAsteroids(a, b, 16), env, "approaching asteroids did not bounce");
+  ASSERT_N(-1.0f, a.velocity.x, 0.0001f, env);
+  ASSERT_N(1.0f, b.velocity.x, 0.0001f, env);
+  // only the part along the line between them changes
+  ASSERT_N(0.5f, a.velocity.y, 0.0001f, env);
+  ASSERT_N(0.5f, b.velocity.y, 0.0001f, env);
+  ASSERT_E(1, a.ver, env, "bounced asteroid should send a delta");
+  ASSERT_E(1, b.ver, env, "bounced asteroid should send a delta");
+
+  // now moving apart -- left alone, so they don't stick together
+  ASSERT_T(!BounceAsteroids(a, b, 16), env, "separating asteroids were bounced");
+  ASSERT_N(-1.0f, a.velocity.x, 0.0001f, env);
+  ASSERT_N(1.0f, b.velocity.x, 0.0001f, env);
+  ASSERT_E(1, a.ver, env, "separating asteroids should not send a delta");
+  ASSERT_E(1, b.ver, env, "separating asteroids should not send a delta");
+
+  // across the world's edge, b is just ahead of a
+  a = MakeAsteroid(1, {15, 5}, {31.0f, 16.0f}, 1.5f);
+  b = MakeAsteroid(2, {0, 5}, {1.0f, 16.0f}, 1.5f);
+  a.velocity = { 1.0f, 0.0f };
+  b.velocity = { -1.0f, 0.0f };
+  ASSERT_T(Collide(a, b, 16), env, "asteroids should overlap across the edge");
+  ASSERT_T(BounceAsteroids(a, b, 16), env, "approaching asteroids did not bounce across the edge");
+  ASSERT_N(-1.0f, a.velocity.x, 0.0001f, env);
+  ASSERT_N(1.0f, b.velocity.x, 0.0001f, env);
+
+  // big asteroids push small ones around -- momentum and energy are kept
+  a = MakeAsteroid(1, {3, 3}, {10.0f, 16.0f}, 2.0f);
+  b = MakeAsteroid(2, {3, 3}, {12.0f, 17.0f}, 1.0f);
+  a.velocity = { 0.5f, 0.0f };
+  b.velocity = { -2.0f, 1.0f };
+  ASSERT_T(BounceAsteroids(a, b, 16), env, "approaching asteroids did not bounce");
+  float mass_a = 4.0f, mass_b = 1.0f;
+  Point2D<float> momentum = a.velocity * mass_a + b.velocity * mass_b;
+  ASSERT_N(0.0f, momentum.x, 0.001f, env, "momentum was not kept");
+  ASSERT_N(1.0f, momentum.y, 0.001f, env, "momentum was not kept");
+  float energy = mass_a * (a.velocity.x * a.velocity.x + a.velocity.y * a.velocity.y)
+               + mass_b * (b.velocity.x * b.velocity.x + b.velocity.y * b.velocity.y);
+  ASSERT_N(6.0f, energy, 0.001f, env, "energy was not kept");
+  ASSERT_T(a.velocity.x < 0.5f && b.velocity.x > -2.0f, env, "asteroids did not push each other apart");
+
+  // asteroids sitting right on top of each other have no direction to bounce in
+  a = MakeAsteroid(1, {3, 3}, {10.0f, 16.0f}, 1.5f);
+  b = MakeAsteroid(2, {3, 3}, {10.0f, 16.0f}, 1.5f);
+  a.velocity = { 1.0f, 0.0f };
+  ASSERT_T(!BounceAsteroids(a, b, 16), env, "coincident asteroids were bounced");
+
+  std::cout << "bounce test passed!" << std::endl;
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNSWEEPANDPRUNETEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(sweepandprunetest, Init);
@@ -0,0 +1,94 @@
+#include <server/TickStats.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+using namespace vasteroids;
+using server::RollingHistogram;
+using server::TickStats;
+using server::TickTimings;
+using server::TickCounts;
+using server::TickPhase;
+
+void PercentileTest(Napi::Env);
+void WindowTest(Napi::Env);
+void StatsTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  PercentileTest(env);
+  WindowTest(env);
+  StatsTest(env);
+}
+
+void PercentileTest(Napi::Env env) {
+  RollingHistogram hist(1000);
+  ASSERT_E(0.0, hist.GetPercentile(0.5), env);
+
+  // 1ms through 1000ms
+  for (int i = 1; i <= 1000; i++) {
+    hist.Record(i / 1000.0);
+  }
+
+  ASSERT_E(1000, hist.GetCount(), env);
+  ASSERT_N(0.5005, hist.GetMean(), 0.0001, env);
+  ASSERT_E(1.0, hist.GetMax(), env);
+
+  // buckets are good to within ~9%
+  ASSERT_T(hist.GetPercentile(0.5) >= 0.5 && hist.GetPercentile(0.5) <= 0.5 * 1.1, env, "p50 out of range");
+  ASSERT_T(hist.GetPercentile(0.99) >= 0.99 && hist.GetPercentile(0.99) <= 1.0, env, "p99 out of range");
+  ASSERT_E(1.0, hist.GetPercentile(1.0), env);
+  std::cout << "percentile test passed!" << std::endl;
+}
+
+void WindowTest(Napi::Env env) {
+  RollingHistogram hist(10);
+  for (int i = 0; i < 10; i++) {
+    hist.Record(5.0);
+  }
+
+  // old samples roll out of the window entirely
+  for (int i = 0; i < 10; i++) {
+    hist.Record(0.001);
+  }
+
+  ASSERT_E(10, hist.GetCount(), env);
+  ASSERT_N(0.001, hist.GetMax(), 0.0000001, env);
+  ASSERT_N(0.001, hist.GetMean(), 0.0000001, env);
+  ASSERT_T(hist.GetPercentile(0.99) <= 0.001, env, "evicted sample still counted");
+
+  // tiny and huge samples are clamped to the end buckets, not dropped
+  hist.Record(0.0);
+  hist.Record(1e9);
+  ASSERT_E(1e9, hist.GetMax(), env);
+  ASSERT_E(1e9, hist.GetPercentile(1.0), env);
+  std::cout << "window test passed!" << std::endl;
+}
+
+void StatsTest(Napi::Env env) {
+  TickStats stats(4);
+  TickTimings timings;
+  TickCounts counts;
+  for (int i = 0; i < 8; i++) {
+    timings.phases[static_cast<int>(TickPhase::PACKETS)] = 0.002;
+    timings.total = 0.003;
+    counts.ships = i;
+    stats.Record(timings, counts);
+  }
+
+  ASSERT_E(8, stats.GetTickCount(), env);
+  ASSERT_E(4, stats.GetTotal().GetCount(), env);
+  ASSERT_E(7, stats.GetLastCounts().ships, env);
+  ASSERT_N(0.002, stats.GetPhase(TickPhase::PACKETS).GetMax(), 0.0000001, env);
+  ASSERT_E(0.0, stats.GetPhase(TickPhase::RESPAWN).GetMax(), env);
+  ASSERT_N(0.003, stats.GetTotal().GetMean(), 0.0000001, env);
+  std::cout << "stats test passed!" << std::endl;
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNTICKSTATSTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(tickstatstest, Init);
@@ -0,0 +1,135 @@
+#include <server/TraceRecorder.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vasteroids;
+using server::TraceClock;
+using server::TraceRecorder;
+using server::TraceSpan;
+
+void TraceTest(Napi::Env);
+void DropTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  TraceTest(env);
+  DropTest(env);
+}
+
+static std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream res;
+  res << file.rdbuf();
+  return res.str();
+}
+
+static int CountOf(const std::string& haystack, const std::string& needle) {
+  int res = 0;
+  for (size_t pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) {
+    res++;
+  }
+
+  return res;
+}
+
+void TraceTest(Napi::Env env) {
+  std::string path = "tracerecordertest.json";
+  {
+    std::string error;
+    std::shared_ptr<TraceRecorder> trace = TraceRecorder::Open(path, error);
+    ASSERT_T(trace != nullptr, env, error);
+    trace->NameThread("main");
+
+    // a null recorder records nothing
+    {
+      TraceSpan span(nullptr, "ignored");
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&trace, t]() {
+        trace->NameThread("worker");
+        for (int i = 0; i < 1000; i++) {
+          TraceSpan span(trace.get(), "work", "thread", t, "index", i);
+        }
+      });
+    }
+
+    for (int i = 0; i < 1000; i++) {
+      TraceSpan span(trace.get(), "tick");
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    auto now = TraceClock::now();
+    trace->Record("manual", now, now + std::chrono::milliseconds(2), "bytes", -5);
+    ASSERT_E(0, trace->GetDroppedCount(), env);
+  }
+
+  std::string contents = ReadFile(path);
+  ASSERT_E(0, contents.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), env);
+  ASSERT_T(contents.size() > 3 && contents.compare(contents.size() - 3, 3, "]}\n") == 0, env, "trace was not closed");
+  ASSERT_E(5001, CountOf(contents, "\"ph\":\"X\""), env);
+  ASSERT_E(4000, CountOf(contents, "\"name\":\"work\""), env);
+  ASSERT_E(1000, CountOf(contents, "\"name\":\"tick\""), env);
+  ASSERT_E(0, CountOf(contents, "ignored"), env);
+  ASSERT_E(1, CountOf(contents, "\"dur\":2000.000,\"args\":{\"bytes\":-5}"), env);
+  ASSERT_E(1, CountOf(contents, "\"thread\":3,\"index\":999"), env);
+
+  // one name per thread -- and every thread got a separate tid
+  ASSERT_E(5, CountOf(contents, "\"ph\":\"M\""), env);
+  for (int tid = 1; tid <= 5; tid++) {
+    ASSERT_T(contents.find("\"tid\":" + std::to_string(tid) + ",") != std::string::npos, env, "missing tid");
+  }
+
+  // events are separated by commas, never doubled up
+  ASSERT_E(0, CountOf(contents, ",,"), env);
+  ASSERT_E(0, CountOf(contents, "}{"), env);
+  std::remove(path.c_str());
+  std::cout << "trace test passed!" << std::endl;
+}
+
+void DropTest(Napi::Env env) {
+  std::string path = "tracerecordertest_drop.json";
+  uint64_t dropped = 0;
+  {
+    std::string error;
+    std::shared_ptr<TraceRecorder> trace = TraceRecorder::Open(path, error, 4);
+    ASSERT_T(trace != nullptr, env, error);
+
+    // far faster than the flusher drains -- the overflow is dropped, rather than blocking
+    auto now = TraceClock::now();
+    for (int i = 0; i < 10000; i++) {
+      trace->Record("spam", now, now);
+    }
+
+    dropped = trace->GetDroppedCount();
+  }
+
+  std::string contents = ReadFile(path);
+  ASSERT_T(dropped > 0, env, "nothing was dropped");
+  ASSERT_E(10000, CountOf(contents, "\"name\":\"spam\"") + static_cast<int>(dropped), env);
+  std::remove(path.c_str());
+
+  std::string error;
+  ASSERT_T(TraceRecorder::Open("no/such/dir/trace.json", error) == nullptr, env, "opened a bad path");
+  ASSERT_T(!error.empty(), env);
+  std::cout << "drop test passed!" << std::endl;
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNTRACERECORDERTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(tracerecordertest, Init);
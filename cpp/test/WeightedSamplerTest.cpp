@@ -0,0 +1,92 @@
+#include <server/WeightedSampler.hpp>
+
+#include <napitest.hpp>
+
+#include <napi.h>
+
+#include <random>
+
+using namespace vasteroids;
+using server::WeightedSampler;
+
+void SampleTest(Napi::Env);
+void UpdateTest(Napi::Env);
+void DistributionTest(Napi::Env);
+
+void RunTest(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  SampleTest(env);
+  UpdateTest(env);
+  DistributionTest(env);
+}
+
+void SampleTest(Napi::Env env) {
+  WeightedSampler sampler(5);
+  sampler.Build({ 1.0, 0.0, 2.0, 1.0, 0.0 });
+  ASSERT_N(4.0, sampler.GetTotal(), 0.0001, env);
+
+  // cumulative: [0, 1) -> 0, [1, 3) -> 2, [3, 4) -> 3
+  ASSERT_E(0, sampler.Sample(0.0), env);
+  ASSERT_E(0, sampler.Sample(0.2), env);
+  ASSERT_E(2, sampler.Sample(0.25), env);
+  ASSERT_E(2, sampler.Sample(0.7), env);
+  ASSERT_E(3, sampler.Sample(0.8), env);
+  // zero weight entries are never picked, even at the very end
+  ASSERT_E(3, sampler.Sample(0.99999999), env);
+  std::cout << "sample test passed!" << std::endl;
+}
+
+void UpdateTest(Napi::Env env) {
+  WeightedSampler sampler(7);
+  for (size_t i = 0; i < 7; i++) {
+    sampler.SetWeight(i, 1.0);
+  }
+
+  ASSERT_N(7.0, sampler.GetTotal(), 0.0001, env);
+  sampler.SetWeight(3, 0.0);
+  ASSERT_N(6.0, sampler.GetTotal(), 0.0001, env);
+  ASSERT_E(4, sampler.Sample(3.5 / 6.0), env);
+
+  sampler.SetWeight(6, 5.0);
+  ASSERT_N(5.0, sampler.GetWeight(6), 0.0001, env);
+  ASSERT_E(6, sampler.Sample(0.6), env);
+}
+
+void DistributionTest(Napi::Env env) {
+  // many updates, then check that samples follow the final weights
+  const size_t count = 1000;
+  WeightedSampler sampler(count);
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> weight(0.0, 4.0);
+  std::uniform_int_distribution<size_t> index(0, count - 1);
+  for (int i = 0; i < 100000; i++) {
+    sampler.SetWeight(index(gen), weight(gen));
+  }
+
+  double total = 0.0;
+  for (size_t i = 0; i < count; i++) {
+    total += sampler.GetWeight(i);
+  }
+
+  ASSERT_N(total, sampler.GetTotal(), 0.0001, env);
+
+  std::vector<int> hits(count, 0);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  const int samples = 2000000;
+  for (int i = 0; i < samples; i++) {
+    hits[sampler.Sample(u(gen))]++;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    double expected = samples * sampler.GetWeight(i) / total;
+    // allow ~5 standard deviations
+    ASSERT_T(std::abs(hits[i] - expected) <= 5.0 * std::sqrt(expected) + 1.0, env);
+  }
+}
+
+static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("RUNSAMPLERTEST", Napi::Function::New(env, RunTest));
+  return exports;
+}
+
+NODE_API_MODULE(samplertest, Init);
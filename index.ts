@@ -7,7 +7,7 @@ import { SocketManager } from "./server/SocketManager";
 const app = express();
 const port = process.env.PORT || 8080;
 
-const mgr = new SocketManager(64, 49152);
+const mgr = new SocketManager(64, 49152, { persistPath: process.env.PERSIST_PATH });
 
 const socketStorage : Set<WebSocket> = new Set();
 
@@ -49,6 +49,20 @@ app.post("/respawn", (req, res) => {
   });
 });
 
+app.get("/biome/:x/:y", (req, res) => {
+  let x = parseInt(req.params.x);
+  let y = parseInt(req.params.y);
+  if (isNaN(x) || isNaN(y)) {
+    res.status(400);
+    res.send("Tile coordinates are not numbers :(");
+    return;
+  }
+
+  // tiles are encoded once by the sim -- just hand over the bytes
+  res.type("application/octet-stream");
+  res.send(Buffer.from(mgr.getBiomeTile(x, y)));
+});
+
 app.post("/biome", (req, res) => {
   let body = req.body;
   console.log(body);
@@ -27,6 +27,9 @@ export function biomeToString(b: Biome) {
   }
 }
 
+// width of a biome tile served by the server, in chunks
+export const BIOME_TILE_SIZE = 32;
+
 export interface BiomeInfo {
   chunk: Point2D;
   biome: Biome;
@@ -12,7 +12,7 @@ const SERVER_PACKET_MAGIC = 0x5746534D;
 const INSTANCE_SIZE = 45;
 
 const HEADER_SIZE = 20;
-const FOOTER_SIZE = 12;
+const FOOTER_SIZE = 13;
 
 const FLOAT32_POINT_SIZE = 8;
 const UINT16_POINT_SIZE = 4;
@@ -93,6 +93,7 @@ export class ServerPacketDecoder {
 
     view.writeFloat64(p.serverTime);
     view.writeUint32(p.score);
+    view.writeUint8(p.destroyed ? 1 : 0);
 
     return res;
   }
@@ -186,6 +187,7 @@ export class ServerPacketDecoder {
     // footer
     res.serverTime = view.nextFloat64();
     res.score = view.nextUint32();
+    res.destroyed = (view.nextUint8() > 0);
 
     this.packet = res;
   }
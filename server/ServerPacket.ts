@@ -19,6 +19,9 @@ interface ServerPacket {
 
   // client's current score
   score: number;
+
+  // whether the server has destroyed the client's ship
+  destroyed: boolean;
 }
 
 export { ServerPacket };
\ No newline at end of file
@@ -1,5 +1,5 @@
 import * as WebSocket from "ws";
-import { CreateWorldSim, WorldSim } from "./WorldSim";
+import { CreateWorldSim, WorldSim, WorldSimOptions } from "./WorldSim";
 import { generateID } from "./IDGen";
 import { ServerPacket } from "./ServerPacket";
 import { ConnectionPacket } from "./ConnectionPacket";
@@ -24,15 +24,27 @@ class SocketManager {
 
   update: NodeJS.Timeout;
 
+  snapshot?: NodeJS.Timeout;
+
   // todo: alow sockets to reconnect with a connection packet
 
-  constructor(chunks: number, asts: number) {
-    this.game = CreateWorldSim(chunks, asts);
+  constructor(chunks: number, asts: number, options?: WorldSimOptions) {
+    this.game = CreateWorldSim(chunks, asts, options);
     this.players = new Map();
     this.sockets = new BiMap();
     this.timeouts = new Map();
     // start some regular update event
     this.update = setInterval(this.handleUpdates.bind(this), 30);
+    if (options && options.persistPath) {
+      // snapshots keep the tick log short -- and the replay on restart quick
+      this.snapshot = setInterval(() => {
+        try {
+          this.game.SaveSnapshot();
+        } catch (e) {
+          console.error(e);
+        }
+      }, 60000);
+    }
   }
 
   async addSocket(socket: WebSocket, name: string) : Promise<void> {
@@ -76,6 +88,10 @@ class SocketManager {
     return this.game.GetLocalBiomeInfo(origin, dims);
   }
 
+  getBiomeTile(x: number, y: number) : ArrayBuffer {
+    return this.game.GetBiomeTile(x, y);
+  }
+
   private socketOnMessage_(socket: WebSocket, message: any) {
     // get packet
     let packet = JSON.parse(message) as ClientPacket;
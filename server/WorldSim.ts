@@ -2,7 +2,7 @@
 import { ClientPacket } from "../server/ClientPacket"
 import { ClientShip } from "../instances/Ship";
 import { Point2D } from "../instances/GameTypes";
-import { BiomeInfo } from "../instances/Biome";
+import { Biome, BiomeInfo } from "../instances/Biome";
 
 const worldsim = require("bindings")("worldsim");
 /**
@@ -54,6 +54,18 @@ interface WorldSim {
    */
   GetServerTime() : number;
 
+  /**
+   * Moves the clock of a world created with `virtualClock` forward. Throws for worlds on the system clock.
+   * @param seconds - the amount of time which passes.
+   * @returns the new server time.
+   */
+  AdvanceClock(seconds: number) : number;
+
+  /**
+   * @returns the seed this world was generated from. Pass it back in to get the same world.
+   */
+  GetSeed() : number;
+
   /**
    * Fetches information on localbiomes.
    * @param origin - top left corner of fetched range.
@@ -61,6 +73,56 @@ interface WorldSim {
    */
   GetLocalBiomeInfo(origin: Point2D, dims: Point2D) : Array<BiomeInfo>;
 
+  /**
+   * Fetches a tile of the biome map, encoded in the same layout as BiomePacketDecoder.
+   * Tiles are BIOME_TILE_SIZE chunks wide, and are only encoded once -- don't modify the result!
+   * @param x - x index of the tile, in tiles.
+   * @param y - y index of the tile, in tiles.
+   * @returns the encoded tile.
+   */
+  GetBiomeTile(x: number, y: number) : ArrayBuffer;
+
+  /**
+   * Starts writing a snapshot of the world to its persist path. The write happens in the background.
+   * @returns true if a snapshot was started -- false if the world isn't persisted, or the last snapshot is still being written.
+   * @throws if the tick log which follows the snapshot could not be opened. The world keeps logging to the old one.
+   */
+  SaveSnapshot() : boolean;
+
+  /**
+   * Summarizes how long recent ticks took, phase by phase. Covers the last 1024 calls to UpdateSim.
+   * @returns timings in milliseconds, and the size of the world during the last tick.
+   */
+  GetTickStats() : TickStats;
+
+  /**
+   * Finds the ships which have cost the most to serve since they joined, by the time spent building their updates.
+   * @param count - the most ships to return. Defaults to 10.
+   * @returns the costliest ships, costliest first.
+   */
+  GetCostliestShips(count?: number) : Array<ShipCost>;
+
+  /**
+   * Reports what the world is holding in memory, by entity type and by subsystem.
+   * Bytes are estimated from what each structure has allocated, so they track growth rather than process size.
+   * @param topChunks - the number of largest chunks to list. Defaults to 10.
+   */
+  GetMemoryStats(topChunks?: number) : MemoryStats;
+
+  /**
+   * Starts writing a trace of each tick -- its phases, chunk updates, per-ship packets and background work -- as
+   * Chrome trace-event JSON. Open it in chrome://tracing or ui.perfetto.dev. Replaces any trace already running.
+   * Throws if the file can't be opened.
+   * @param path - the file to write the trace to.
+   */
+  StartTrace(path: string) : void;
+
+  /**
+   * Stops tracing, and finishes writing the trace file.
+   * @returns false if no trace was running.
+   */
+  StopTrace() : boolean;
+
   /**
    * Returns the relative amount of activity in nearby chunks.
    * @param origin - the top-left chunk we wish to fetch.
@@ -70,8 +132,158 @@ interface WorldSim {
   // GetLocalChunkActivity(origin: Point2D, dims: Point2D) : Array<Array<number>>;
 }
 
-function CreateWorldSim(size: number, asts: number) : WorldSim {
-  return new worldsim.sim(size, asts) as WorldSim;
+/**
+ *  Rolling timings of a single phase of the tick, in milliseconds.
+ */
+interface PhaseStats {
+  mean: number;
+  p50: number;
+  p99: number;
+  max: number;
+}
+
+/**
+ *  Timings for recent ticks, as returned by GetTickStats.
+ */
+interface TickStats {
+  // ticks since the world was created
+  ticks: number;
+  // ticks covered by the timings
+  window: number;
+  // keyed by phase: capture, materialize, update_chunks, reinsert, asteroid_collisions, collision_build,
+  // compute_collisions, respawn, release_chunks, packets, to_node
+  phases: { [phase: string]: PhaseStats };
+  total: PhaseStats;
+  // size of the world during the last tick
+  counts: {
+    chunks: number;
+    activeChunks: number;
+    asteroids: number;
+    ships: number;
+    projectiles: number;
+    packets: number;
+  };
+}
+
+/**
+ *  What a single ship has cost the server since it joined, as returned by GetCostliestShips.
+ */
+interface ShipCost {
+  id: number;
+  // where the ship was as of the last tick
+  chunk: Point2D;
+  biome: Biome;
+  // ticks the ship has been updated in
+  ticks: number;
+  // time spent building the ship's updates -- in total, and during the last tick
+  fanoutMs: number;
+  lastFanoutMs: number;
+  // time spent applying the ship's own packets
+  inputMs: number;
+  // instances read from the chunks around the ship, before trimming down to what it needs
+  scanned: number;
+  // updates sent for instances the ship already knew of
+  deltas: number;
+  // encoded size of the ship's updates
+  bytes: number;
+  projectiles: number;
+}
+
+/**
+ *  The number of entries in some structure, and the memory it holds.
+ */
+interface MemoryUsage {
+  count: number;
+  bytes: number;
+}
+
+/**
+ *  Memory held by a single chunk.
+ */
+interface ChunkMemory {
+  chunk: Point2D;
+  bytes: number;
+  asteroids: MemoryUsage;
+  ships: MemoryUsage;
+  projectiles: MemoryUsage;
+  collisions: MemoryUsage;
+  // IDs deleted in the last two updates, kept until clients have heard about them
+  deleted: MemoryUsage;
+  // the chunk's contents as last encoded for a snapshot, kept until it changes
+  encoded: MemoryUsage;
+}
+
+/**
+ *  What a world is holding in memory, as returned by GetMemoryStats.
+ */
+interface MemoryStats {
+  totalBytes: number;
+  // summed over every chunk
+  asteroids: MemoryUsage;
+  ships: MemoryUsage;
+  projectiles: MemoryUsage;
+  collisions: MemoryUsage;
+  deleted: MemoryUsage;
+  // chunk encodings kept for snapshots -- counted per chunk
+  encoded: MemoryUsage;
+  // the chunk map itself
+  chunks: MemoryUsage;
+  // chunks holding nothing, which a ship is still close enough to see
+  emptyChunks: number;
+  // chunks whose contents have been generated
+  materialized: MemoryUsage;
+  // what each client has been sent, and its projectiles awaiting confirmation -- counted per ship
+  knownIds: MemoryUsage;
+  newProjectiles: MemoryUsage;
+  // where each ship is, and what it has cost
+  shipIndex: MemoryUsage;
+  collisionWorld: MemoryUsage;
+  sweepAndPrune: MemoryUsage;
+  biomeManager: MemoryUsage;
+  // the chunks holding the most memory, largest first
+  largestChunks: Array<ChunkMemory>;
+}
+
+/**
+ *  Optional settings for a new WorldSim.
+ */
+interface WorldSimOptions {
+  // if true, prints the biome map to stdout on startup.
+  printBiomeMap?: boolean;
+  // seed for world generation -- random if omitted.
+  seed?: number;
+  // if true, generates every chunk on startup rather than when it is first visited.
+  eager?: boolean;
+  // existing directory to persist the world in. if it holds a snapshot, the world is restored from it.
+  persistPath?: string;
+  // file to record every input to, from creation on. replaced if it exists.
+  recordPath?: string;
+  // if true, time only passes when AdvanceClock is called.
+  virtualClock?: boolean;
+  // recording to replay -- the world is rebuilt from it, and size and asteroid count are ignored.
+  replayPath?: string;
+  // file to trace the world's internals to, from creation on -- see StartTrace.
+  tracePath?: string;
+  // ticks slower than this are captured to `slowTickDir`, so that they can be re-run with tick_replay.
+  slowTickMs?: number;
+  // existing directory receiving slow tick captures, named slowtick.<tick>.vcap.
+  slowTickDir?: string;
+  // ticks between copies of the world's state -- a capture holds one, plus every input since. defaults to 300.
+  slowTickWindow?: number;
+}
+
+function CreateWorldSim(size: number, asts: number, options?: WorldSimOptions) : WorldSim {
+  return new worldsim.sim(size, asts, options || {}) as WorldSim;
+}
+
+/**
+ * Rebuilds a world from a recording, replaying every recorded input as fast as possible.
+ * @param recording - path to a file written with `recordPath`.
+ * @param options - additional settings for the replayed world.
+ * @returns the world as it was at the end of the recording.
+ */
+function ReplayWorldSim(recording: string, options?: WorldSimOptions) : WorldSim {
+  return CreateWorldSim(0, 0, Object.assign({}, options, { replayPath: recording }));
 }
 
-export { CreateWorldSim, WorldSim };
\ No newline at end of file
+export { CreateWorldSim, ReplayWorldSim, WorldSim, WorldSimOptions, TickStats, PhaseStats, ShipCost, MemoryStats };
\ No newline at end of file
@@ -0,0 +1,5 @@
+const CollisionWorldTest = require("bindings")("collisionworldtest");
+
+describe("CollisionWorld", function() {
+  it("should pass :^)", function() { CollisionWorldTest.RUNCOLLISIONWORLDTEST() });
+})
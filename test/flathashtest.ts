@@ -0,0 +1,5 @@
+const FlatHashTest = require("bindings")("flathashtest");
+
+describe("FlatHashMap", function() {
+  it("should pass :^)", function() { FlatHashTest.RUNFLATHASHTEST() });
+})
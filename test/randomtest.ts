@@ -0,0 +1,5 @@
+const RandomTest = require("bindings")("randomtest");
+
+describe("RandomStream", function() {
+  it("should pass :^)", function() { RandomTest.RUNRANDOMTEST() });
+})
\ No newline at end of file
@@ -0,0 +1,5 @@
+const SamplerTest = require("bindings")("samplertest");
+
+describe("WeightedSampler", function() {
+  it("should pass :^)", function() { SamplerTest.RUNSAMPLERTEST() });
+})
@@ -112,6 +112,7 @@ function createServerPacket() : ServerPacket {
   res.projectilesLocal = [];
   res.score = 0;
   res.serverTime = 0;
+  res.destroyed = false;
   res.ships = [];
 
   return res;
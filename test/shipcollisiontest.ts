@@ -0,0 +1,5 @@
+const ShipCollisionTest = require("bindings")("shipcollisiontest");
+
+describe("ShipCollisions", function() {
+  it("should pass :^)", function() { ShipCollisionTest.RUNSHIPCOLLISIONTEST() });
+})
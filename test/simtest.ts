@@ -1,8 +1,12 @@
-import { CreateWorldSim } from "../server/WorldSim";
+import { CreateWorldSim, ReplayWorldSim } from "../server/WorldSim";
 import { ClientShip } from "../instances/Ship";
 import { expect } from "chai";
 import { InstanceType, Point2D } from "../instances/GameTypes";
 import { ClientPacket } from "../server/ClientPacket";
+import { BiomePacketDecoder } from "../packet/BiomePacketDecoder";
+import * as fs from "fs";
+import * as os from "os";
+import * as path from "path";
 
 describe("WorldSim", function() {
   it("Should be able to be created :)", function() {
@@ -105,4 +109,271 @@ describe("WorldSim", function() {
     expect(res[ship_two.id.toString()]).to.be.undefined;
     expect(res[ship_one.id.toString()].deleted.length).to.equal(1);
   })
+
+  it("should serve biome tiles which match the biome map", function() {
+    let worldsim = CreateWorldSim(40, 0);
+    let tile = worldsim.GetBiomeTile(1, 0);
+    // tiles are only encoded once
+    expect(worldsim.GetBiomeTile(1, 0)).to.equal(tile);
+    // wraps around
+    expect(worldsim.GetBiomeTile(-1, 2)).to.equal(tile);
+
+    // clipped to the edge of the world
+    let biomes = new BiomePacketDecoder(tile).decode();
+    expect(biomes.length).to.equal(8 * 32);
+
+    let local = worldsim.GetLocalBiomeInfo({x: 32, y: 0}, {x: 8, y: 32});
+    expect(biomes.length).to.equal(local.length);
+    for (let i = 0; i < local.length; i++) {
+      expect(biomes[i].chunk.x).to.equal(local[i].chunk.x);
+      expect(biomes[i].chunk.y).to.equal(local[i].chunk.y);
+      expect(biomes[i].biome).to.equal(local[i].biome);
+    }
+  });
+
+  it("should generate the same world from the same seed", function() {
+    let a = CreateWorldSim(40, 200, { seed: 1234 });
+    let b = CreateWorldSim(40, 200, { seed: 1234 });
+    expect(a.GetSeed()).to.equal(1234);
+
+    let tileA = new Uint8Array(a.GetBiomeTile(0, 0));
+    let tileB = new Uint8Array(b.GetBiomeTile(0, 0));
+    expect(Buffer.from(tileA).equals(Buffer.from(tileB))).to.be.true;
+
+    let shipA = a.AddShip("ship");
+    let shipB = b.AddShip("ship");
+    expect(shipA.position).to.deep.equal(shipB.position);
+
+    let pktA = a.UpdateSim()[shipA.id.toString()];
+    let pktB = b.UpdateSim()[shipB.id.toString()];
+    expect(pktA.asteroids.map((ast: any) => ast.geometry)).to.deep.equal(pktB.asteroids.map((ast: any) => ast.geometry));
+  });
+
+  it("should bootstrap the same world it would generate lazily", function() {
+    let lazy = CreateWorldSim(1, 20, { seed: 99 });
+    let eager = CreateWorldSim(1, 20, { seed: 99, eager: true });
+
+    let shipLazy = lazy.AddShip("ship");
+    let shipEager = eager.AddShip("ship");
+    expect(shipLazy.id).to.equal(shipEager.id);
+
+    let byId = (a: any, b: any) => a.id - b.id;
+    let astLazy = lazy.UpdateSim()[shipLazy.id.toString()].asteroids.sort(byId);
+    let astEager = eager.UpdateSim()[shipEager.id.toString()].asteroids.sort(byId);
+    expect(astLazy.length).to.equal(astEager.length);
+    for (let i = 0; i < astLazy.length; i++) {
+      expect(astLazy[i].id).to.equal(astEager[i].id);
+      expect(astLazy[i].geometry).to.deep.equal(astEager[i].geometry);
+    }
+  });
+
+  it("should restore a persisted world from its snapshot and tick log", function() {
+    let dir = fs.mkdtempSync(path.join(os.tmpdir(), "vasteroids-"));
+    let a = CreateWorldSim(4, 40, { seed: 7, persistPath: dir });
+    let ship = a.AddShip("ship");
+    a.UpdateSim();
+    a.UpdateSim();
+    a.RespawnShip(ship.id);
+
+    // pick up from a's files, as if it had gone down
+    let b = CreateWorldSim(4, 40, { persistPath: dir });
+    expect(b.GetSeed()).to.equal(7);
+    // ships don't outlive their clients
+    expect(b.DeleteShip(ship.id)).to.be.false;
+
+    let nextA = a.AddShip("next");
+    let nextB = b.AddShip("next");
+    expect(nextB.id).to.equal(nextA.id);
+    expect(nextB.position).to.deep.equal(nextA.position);
+
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  it("should replay a recorded session into the same world", function() {
+    let dir = fs.mkdtempSync(path.join(os.tmpdir(), "vasteroids-"));
+    let recording = path.join(dir, "session.rec");
+    let live = CreateWorldSim(4, 40, { seed: 21, recordPath: recording });
+    let ship = live.AddShip("ship");
+    live.UpdateSim();
+
+    let packet = {} as ClientPacket;
+    packet.ship = ship;
+    packet.ship.velocity = {x: 2, y: 1} as Point2D;
+    packet.projectiles = [];
+    live.HandleClientPacket(packet);
+
+    let other = live.AddShip("other");
+    live.UpdateSim();
+    live.DeleteShip(other.id);
+    live.UpdateSim();
+
+    let replay = ReplayWorldSim(recording);
+    expect(replay.GetSeed()).to.equal(21);
+    expect(replay.GetChunkDims()).to.equal(4);
+
+    let nextLive = live.AddShip("next");
+    let nextReplay = replay.AddShip("next");
+    expect(nextReplay.id).to.equal(nextLive.id);
+    expect(nextReplay.position).to.deep.equal(nextLive.position);
+
+    let pktLive = live.UpdateSim()[ship.id.toString()];
+    let pktReplay = replay.UpdateSim()[ship.id.toString()];
+    expect(pktReplay.ships.length).to.equal(pktLive.ships.length);
+    expect(pktReplay.asteroids.length).to.equal(pktLive.asteroids.length);
+
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  it("should run on virtual time, if asked", function() {
+    this.timeout(20000);
+    let a = CreateWorldSim(4, 60, { seed: 3, virtualClock: true });
+    let b = CreateWorldSim(4, 60, { seed: 3, virtualClock: true });
+    expect(a.GetServerTime()).to.equal(0);
+
+    let shipA = a.AddShip("ship");
+    let shipB = b.AddShip("ship");
+    // an hour of play, in no time at all
+    for (let i = 0; i < 7200; i++) {
+      expect(a.AdvanceClock(0.5)).to.equal(b.AdvanceClock(0.5));
+      let pktA = a.UpdateSim()[shipA.id.toString()];
+      let pktB = b.UpdateSim()[shipB.id.toString()];
+      if (i % 600 === 0) {
+        expect(pktA.serverTime).to.equal(a.GetServerTime());
+        expect(pktA).to.deep.equal(pktB);
+      }
+    }
+
+    expect(a.GetServerTime()).to.be.closeTo(3600, 0.01);
+    expect(() => CreateWorldSim(1, 1).AdvanceClock(1)).to.throw();
+  });
+
+  it("should time each phase of the tick", function() {
+    let sim = CreateWorldSim(16, 200, { seed: 5 });
+    let ship = sim.AddShip("timed");
+    let empty = sim.GetTickStats();
+    expect(empty.ticks).to.equal(0);
+    expect(empty.total.max).to.equal(0);
+
+    for (let i = 0; i < 20; i++) {
+      sim.UpdateSim();
+    }
+
+    let stats = sim.GetTickStats();
+    expect(stats.ticks).to.equal(20);
+    expect(stats.window).to.equal(20);
+    expect(stats.counts.ships).to.equal(1);
+    expect(stats.counts.packets).to.equal(1);
+    for (let phase of ["capture", "materialize", "update_chunks", "reinsert", "asteroid_collisions", "collision_build",
+                       "compute_collisions", "respawn", "release_chunks", "packets", "to_node"]) {
+      let p = stats.phases[phase];
+      expect(p.p50).to.be.at.most(p.p99);
+      expect(p.p99).to.be.at.most(p.max);
+      expect(p.max).to.be.at.most(stats.total.max);
+    }
+
+    expect(stats.total.mean).to.be.greaterThan(0);
+    sim.DeleteShip(ship.id);
+  });
+
+  it("should trace ticks as trace-event JSON", function() {
+    let tracePath = path.join(fs.mkdtempSync(path.join(os.tmpdir(), "vasteroids-")), "trace.json");
+    let sim = CreateWorldSim(16, 200, { seed: 5 });
+    sim.AddShip("traced");
+    expect(sim.StopTrace()).to.be.false;
+
+    sim.StartTrace(tracePath);
+    for (let i = 0; i < 5; i++) {
+      sim.UpdateSim();
+    }
+
+    expect(sim.StopTrace()).to.be.true;
+    let trace = JSON.parse(fs.readFileSync(tracePath, "utf8"));
+    let names = trace.traceEvents.map((e: any) => e.name);
+    expect(names.filter((n: string) => n === "tick").length).to.equal(5);
+    expect(names.filter((n: string) => n === "ship_packet").length).to.equal(5);
+    expect(names).to.include("update_chunk");
+    expect(names).to.include("to_node");
+    expect(() => sim.StartTrace(path.join(tracePath, "nope", "trace.json"))).to.throw();
+  });
+
+  it("should attribute tick costs to ships", function() {
+    let sim = CreateWorldSim(16, 400, { seed: 5 });
+    let ships = [sim.AddShip("a"), sim.AddShip("b"), sim.AddShip("c")];
+    expect(sim.GetCostliestShips()[0].ticks).to.equal(0);
+
+    let packet = {} as ClientPacket;
+    packet.ship = ships[0];
+    packet.projectiles = [];
+    sim.HandleClientPacket(packet);
+    for (let i = 0; i < 10; i++) {
+      sim.UpdateSim();
+    }
+
+    let costs = sim.GetCostliestShips();
+    expect(costs.map((c) => c.id).sort()).to.deep.equal(ships.map((s) => s.id).sort());
+    for (let i = 0; i < costs.length; i++) {
+      expect(costs[i].ticks).to.equal(10);
+      expect(costs[i].bytes).to.be.greaterThan(0);
+      expect(costs[i].lastFanoutMs).to.be.at.most(costs[i].fanoutMs);
+      if (i > 0) {
+        expect(costs[i].fanoutMs).to.be.at.most(costs[i - 1].fanoutMs);
+      }
+    }
+
+    expect(costs.find((c) => c.id === ships[0].id).inputMs).to.be.greaterThan(0);
+    expect(sim.GetCostliestShips(1).length).to.equal(1);
+
+    sim.DeleteShip(ships[1].id);
+    expect(sim.GetCostliestShips().length).to.equal(2);
+  });
+
+  it("should free what departing ships leave behind", function() {
+    // no asteroids -- chunks only exist where ships are
+    let sim = CreateWorldSim(16, 0, { seed: 5 });
+    let stay = sim.AddShip("stay");
+    for (let i = 0; i < 20; i++) {
+      let ship = sim.AddShip("visitor");
+      sim.UpdateSim();
+      sim.UpdateSim();
+      sim.DeleteShip(ship.id);
+    }
+
+    let stats = sim.GetMemoryStats(1);
+    expect(stats.ships.count).to.equal(1);
+    expect(stats.shipIndex.count).to.equal(1);
+    expect(stats.knownIds.count).to.equal(1);
+    expect(stats.newProjectiles.count).to.equal(1);
+    // empty chunks are only kept while "stay" can see them
+    expect(stats.chunks.count - stats.emptyChunks).to.equal(1);
+    expect(stats.emptyChunks).to.be.at.most(8);
+    expect(stats.largestChunks.length).to.equal(1);
+    expect(stats.totalBytes).to.be.greaterThan(0);
+    expect(stats.biomeManager.count).to.equal(256);
+
+    sim.DeleteShip(stay.id);
+    stats = sim.GetMemoryStats();
+    expect(stats.chunks.count).to.equal(0);
+    expect(stats.newProjectiles.count).to.equal(0);
+    expect(stats.largestChunks).to.deep.equal([]);
+  });
+
+  it("should capture slow ticks", async function() {
+    let dir = fs.mkdtempSync(path.join(os.tmpdir(), "vasteroids-"));
+    // every tick is slow -- but only one per window is captured
+    let sim = CreateWorldSim(16, 200, { seed: 5, slowTickMs: 1e-9, slowTickDir: dir, slowTickWindow: 4 });
+    sim.AddShip("slow");
+    for (let i = 0; i < 3; i++) {
+      sim.UpdateSim();
+    }
+
+    // captures are written in the background
+    let capture = path.join(dir, "slowtick.0.vcap");
+    for (let i = 0; i < 100 && !fs.existsSync(capture); i++) {
+      await new Promise((resolve) => setTimeout(resolve, 20));
+    }
+
+    expect(fs.readdirSync(dir)).to.deep.equal(["slowtick.0.vcap"]);
+    expect(() => CreateWorldSim(16, 200, { slowTickMs: 5 })).to.throw();
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
 })
\ No newline at end of file
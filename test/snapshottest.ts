@@ -0,0 +1,5 @@
+const SnapshotTest = require("bindings")("snapshottest");
+
+describe("WorldSnapshot", function() {
+  it("should pass :^)", function() { SnapshotTest.RUNSNAPSHOTTEST() });
+})
\ No newline at end of file
@@ -0,0 +1,5 @@
+const SweepAndPruneTest = require("bindings")("sweepandprunetest");
+
+describe("SweepAndPrune", function() {
+  it("should pass :^)", function() { SweepAndPruneTest.RUNSWEEPANDPRUNETEST() });
+})
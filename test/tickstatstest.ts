@@ -0,0 +1,5 @@
+const TickStatsTest = require("bindings")("tickstatstest");
+
+describe("TickStats", function() {
+  it("should pass :^)", function() { TickStatsTest.RUNTICKSTATSTEST() });
+})
\ No newline at end of file
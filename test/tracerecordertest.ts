@@ -0,0 +1,5 @@
+const TraceRecorderTest = require("bindings")("tracerecordertest");
+
+describe("TraceRecorder", function() {
+  it("should pass :^)", function() { TraceRecorderTest.RUNTRACERECORDERTEST() });
+})
\ No newline at end of file